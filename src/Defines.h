@@ -32,6 +32,9 @@
 /// console syntax to be used
 #define TRIP_CONSOLE_SYNTAX "UltraShortSyntax"
 
+/// file the frame time histograms are written to at exit
+#define TRIP_FRAME_STATISTICS_FILE "FrameStatistics.csv"
+
 
 #define LASTFRAME evt.timeSinceLastFrame
 
@@ -1,7 +1,7 @@
 /**
  * Implementation file for the Engine.hpp.
  * @author barn
- * @version 20121105
+ * @version 20121210
  */
 
 /*===========================================================================*
@@ -12,12 +12,19 @@
 /*===========================================================================*
  * INCLUDES project headers
  *===========================================================================*/
+#include <FadeScheduler.hpp>
+#include <FrameProfiler.hpp>
+#include <FrameStatistics.hpp>
+#include <LodPolicy.hpp>
 #include <managers/ClusterManager.hpp>
+#include <managers/TripVarManager.hpp>
 #include <clusters/Cluster.hpp>
+#include <util/ThreadPool.hpp>
 
 /*===========================================================================*
  * INCLUDES C/C++ standard library (and other external libraries)
  *===========================================================================*/
+#include <cmath>
 
 /*===========================================================================*
  * DEFINES and MACROS
@@ -29,61 +36,302 @@
 
 namespace Trip
 {
+	/// The current revision of the structure of the Cluster-tree.
+	uint Engine::__structure_revision = 1;
+
+
+	/**
+	 * Destructor.
+	 * Stops the worker threads, if there are any.
+	 */
+	Engine::~Engine()
+	{
+		// the simulation thread may still use the pool
+		_pipeline.finish();
+		delete _pool;
+	}
+
+
 	/// Method derived by Ogre::FrameListener. Processes everything
 	bool Engine::frameRenderingQueued( const Ogre::FrameEvent& evt)
 	{
-		Cluster* root = ClusterManager::instance()->getRootCluster();
-		if( root->isEnabled())
+		step( evt.timeSinceLastFrame);
+		return true;
+	}
+
+
+	/**
+	 * Processes one frame: advances the fadings and applies all Transformers,
+	 * either once or in fixed steps.
+	 * Call it directly when running without Ogre's render loop.
+	 * @param tlc The time since the last frame.
+	 */
+	void Engine::step( float tlc)
+	{
+		Clock::Ticks start = Clock::now();
+
+		if( _pipelined && _fixed_step <= 0 && !_plan.isGrouped())
+		{
+			simulatePipelined( tlc);
+			finishStep( Clock::now() - start);
+			return;
+		}
+
+		// all Nodes are processed on this thread again
+		_pipeline.detach();
+
+		if( _fixed_step <= 0)
+		{
+			simulate( tlc, false);
+			finishStep( Clock::now() - start);
+			return;
+		}
+
+		// continue the changed tree from the simulated state, invalidatePlan() has already
+		// restored the Nodes that are gone before they were destroyed
+		if( _plan_revision != __structure_revision)
 		{
-			process( root, std::list<Cluster*>(), evt.timeSinceLastFrame);
+			_interpolator.restore();
+			_interpolator.invalidate();
 		}
 
+		_accumulator += tlc;
+		uint steps = (uint) (_accumulator / _fixed_step);
+		if( steps > _max_steps)
+		{
+			// drop the time that cannot be caught up
+			steps = _max_steps;
+			_accumulator = _fixed_step * steps + std::fmod( _accumulator, _fixed_step);
+		}
+
+		if( steps > 0)
+		{
+			// continue from the simulated state, not from the blended one
+			_interpolator.restore();
+
+			for( uint s = 0; s < steps; ++s)
+			{
+				simulate( _fixed_step, _interpolation && s == steps - 1);
+				_accumulator -= _fixed_step;
+			}
+		}
+
+		if( _interpolation)
+		{
+			_interpolator.blend( _accumulator / _fixed_step);
+		}
+
+		finishStep( Clock::now() - start);
+	}
+
+
+	/**
+	 * Simulates one step in pipelined mode: takes over the step of the simulation thread,
+	 * starts the next one and processes the Clusters that are not thread-safe meanwhile.
+	 * The step of the simulation thread is written to the Nodes one frame later.
+	 * @param tlc The duration of the step.
+	 */
+	void Engine::simulatePipelined( float tlc)
+	{
+		// take over the step of the simulation thread, the plan is ours until the next start
+		FrameProfiler* profiler = FrameProfiler::instance();
+		if( _pipeline.finish() && _plan.isProfiling() && profiler->isEnabled())
+		{
+			profiler->record( _plan, _pipeline.getTicks() + _serial_ticks);
+		}
+
+		// advance all fadings once, finished fade-outs may change the tree
+		FadeScheduler::instance()->step( tlc);
+
+		if( _plan_revision != __structure_revision || !_pipeline.isAttached())
+		{
+			// the finished step belongs to the Nodes of the former plan
+			_pipeline.detach();
+			updatePlan();
+			_pipeline.attach( _plan);
+		}
+
+		// far, off-screen and, over the budget, low-priority Clusters are updated less often
+		LodPolicy::instance()->update( TripVarManager::instance()->getCam());
+
+		_plan.setProfiling( profiler->isEnabled());
+		_plan.prepare( tlc);
+		_pipeline.start( _pool);
+
+		// write the former step to the scene while the simulation thread computes the next one
+		_pipeline.apply();
+
+		Clock::Ticks serial_start = Clock::now();
+		_plan.run( 0, ExecutionPlan::PASS_OTHERS);
+		_serial_ticks = Clock::now() - serial_start;
+	}
+
+
+	/**
+	 * Recompiles the plan, if the tree has changed.
+	 * @return
+	 * TRUE - the plan was recompiled
+	 * FALSE - the plan is up to date
+	 */
+	bool Engine::updatePlan()
+	{
+		if( _plan_revision == __structure_revision)
+			return false;
+
+		_plan.compile( ClusterManager::instance()->getRootCluster());
+		_plan_revision = __structure_revision;
+		_interpolator.invalidate();
 		return true;
 	}
 
 
 	/**
-	 * Processes the transformers recursively on the whole tree.
-	 * Iterates through the tree and applies higher level Transformers to every child Cluster,
-	 * their children and so on.
-	 * @param cluster The current cluster to process.
-	 * @param context The list of clusters that are the parents of the current cluster.
-	 * @param tlc The time since the last frame rendered.
+	 * Waits for the running step of the simulation thread and writes it to the Nodes.
+	 * Call it before changing the Cluster-tree or its Transformers in pipelined mode.
+	 * Does nothing otherwise.
 	 */
-	void Engine::process( Cluster* cluster, std::list<Cluster*> context, float tlc)
+	void Engine::synchronize()
 	{
-		context.push_back( cluster);
+		_pipeline.finish();
+		_pipeline.apply();
+	}
 
-		// apply all transformers on cluster's nodes
-		uint i = 0;
-		auto node_list = cluster->getNodes();
-		for( auto node_it = node_list.begin(); node_it != node_list.end(); ++node_it)
+
+	/**
+	 * Indicates whether the next step may change any Node.
+	 * Use it to stop rendering while the scene stands still.
+	 * @return
+	 * TRUE - the tree has changed, a fading runs or an enabled Cluster has Transformers
+	 * FALSE - the next step would change nothing
+	 */
+	bool Engine::isAnimating()
+	{
+		// the changed tree has not been compiled and shown yet
+		if( _plan_revision != __structure_revision)
+			return true;
+
+		if( FadeScheduler::instance()->getFadingCount() > 0)
+			return true;
+
+		const std::vector<ExecutionPlan::Entry>& entries = _plan.getEntries();
+		for( auto it = entries.begin(); it != entries.end(); ++it)
 		{
-			for( auto context_it = context.begin(); context_it != context.end(); ++context_it)
-			{
-				auto transformer_vec = (*context_it)->getAllTransformers();
-				for( auto transformer_it = transformer_vec.begin(); transformer_it != transformer_vec.end(); ++transformer_it)
-				{
-					Transformer* transformer = *transformer_it;
-					if( transformer->isEnabled())
-					{
-						transformer->transform( *node_it, tlc, i);
-					}
-				}
-			}
-			++i;
+			if( it->transformer_count > 0)
+				return true;
 		}
+		return false;
+	}
+
+
+	/**
+	 * Records the time of a frame and lets the LodPolicy compare it to the frame budget.
+	 * @param elapsed The time the Engine needed for the frame.
+	 */
+	void Engine::finishStep( Clock::Ticks elapsed)
+	{
+		FrameStatistics::instance()->record( FrameStatistics::PHASE_SIMULATION, elapsed);
+		LodPolicy::instance()->record( elapsed);
+	}
 
-		// process child clusters of current cluster
-		auto child_cluster_list = cluster->getAllClusters();
-		for( auto cluster_it = child_cluster_list.begin(); cluster_it != child_cluster_list.end(); ++cluster_it)
+
+	/**
+	 * Simulates one step: advances the fadings and applies all Transformers.
+	 * Recompiles the plan if the tree has changed.
+	 * @param tlc The duration of the step.
+	 * @param capture Indicates whether the interpolator shall take snapshots around the step.
+	 */
+	void Engine::simulate( float tlc, bool capture)
+	{
+		// advance all fadings once, finished fade-outs may change the tree
+		FadeScheduler::instance()->step( tlc);
+
+		// recompile the plan only if the tree has changed
+		updatePlan();
+
+		if( capture)
 		{
-			Cluster* child_cluster = *cluster_it;
-			if( child_cluster->isEnabled())
-			{
-				process( *cluster_it, context, tlc);
-			}
+			_interpolator.capturePrevious( _plan);
+		}
+
+		// far, off-screen and, over the budget, low-priority Clusters are updated less often
+		LodPolicy::instance()->update( TripVarManager::instance()->getCam());
+
+		// measure the plan if asked to
+		FrameProfiler* profiler = FrameProfiler::instance();
+		_plan.setProfiling( profiler->isEnabled());
+
+		Clock::Ticks execution_start = Clock::now();
+		_plan.execute( tlc, _pool);
+		Clock::Ticks end = Clock::now();
+
+		if( capture)
+		{
+			_interpolator.captureCurrent();
 		}
+
+		if( profiler->isEnabled())
+		{
+			profiler->record( _plan, end - execution_start);
+		}
+	}
+
+
+	/**
+	 * Sets the duration of one simulation step.
+	 * @param seconds The duration of a fixed step
+	 * or 0 to simulate one step with the duration of every frame.
+	 */
+	void Engine::setFixedStep( float seconds)
+	{
+		_interpolator.restore();
+		_interpolator.invalidate();
+		_fixed_step = seconds > 0 ? seconds : 0;
+		_accumulator = 0;
+	}
+
+
+	/**
+	 * Sets whether the Nodes shall be blended between the last two fixed steps.
+	 * Without interpolation, the Nodes show the state of the last step.
+	 * @param interpolation
+	 * TRUE - blend the Nodes for rendering
+	 * FALSE - render the last step as it is
+	 */
+	void Engine::setInterpolation( bool interpolation)
+	{
+		_interpolator.restore();
+		_interpolator.invalidate();
+		_interpolation = interpolation;
+	}
+
+
+	/**
+	 * Sets the number of threads that process the Transformers.
+	 * With more than one thread, Clusters with thread-safe Transformers
+	 * will be processed in parallel. The results stay the same.
+	 * @param threadCount The number of threads including the render thread.
+	 * 0 or 1 processes everything on the render thread.
+	 */
+	void Engine::setThreadCount( uint threadCount)
+	{
+		if( threadCount == getThreadCount())
+			return;
+
+		// the simulation thread may use the pool
+		_pipeline.finish();
+
+		delete _pool;
+		_pool = threadCount > 1 ? new ThreadPool( threadCount) : 0;
+	}
+
+
+	/**
+	 * Retrieves the number of threads that process the Transformers.
+	 * @return The number of threads including the render thread.
+	 */
+	uint Engine::getThreadCount()
+	{
+		return _pool ? _pool->getThreadCount() : 1;
 	}
 
 
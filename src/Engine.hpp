@@ -3,7 +3,7 @@
  * a Cluster-tree and are able to process the Cluster's Transformers
  * on them. Actually, the Engine keeps it all rolling.
  * @author barn
- * @version 20121105
+ * @version 20121210
  */
 #ifndef __Engine_HPP__
 #define __Engine_HPP__
@@ -16,6 +16,10 @@
  * INCLUDES project headers
  *===========================================================================*/
 #include "stdafx.h"
+#include <ExecutionPlan.hpp>
+#include <NodeInterpolator.hpp>
+#include <SimulationPipeline.hpp>
+#include <util/Clock.hpp>
 
 /*===========================================================================*
  * INCLUDES C/C++ standard library (and other external libraries)
@@ -25,6 +29,9 @@
  * DEFINES and MACROS
  *===========================================================================*/
 
+/// The default maximum number of fixed simulation steps per frame.
+#define TRIP_ENGINE_MAX_STEPS 8
+
 /*===========================================================================*
  * NAMESPACE, CONSTANTS and TYPE DECLARATIONS/IMPLEMENTATIONS
  *===========================================================================*/
@@ -32,45 +39,297 @@
 namespace Trip
 {
 	class Cluster;
+	class ThreadPool;
 
 	/**
 	 * The Engine class is able to iterate over a Tree of Clusters
 	 * and process the Cluster's Transformers on them.
+	 * Attached to Ogre as a FrameListener, it processes every rendered frame.
+	 * Without a render system, call step() once per frame.
+	 *
+	 * By default, every frame is simulated as one step of the frame's duration.
+	 * With a fixed step set, the Engine simulates as many steps of that duration as
+	 * fit into the elapsed time, at most getMaxSteps() per frame, and keeps the rest
+	 * for the next frame. With interpolation enabled, the Nodes are then blended between
+	 * the last two steps for rendering, so the motion stays smooth even if the
+	 * simulation runs slower than the frame rate.
+	 *
+	 * In pipelined mode, the thread-safe Clusters are processed by a SimulationPipeline on a simulation
+	 * thread, while the render thread processes the other Clusters, returns to Ogre and renders the
+	 * next frame. The finished step is written to the Nodes at the start of the next frame's processing.
+	 * Pipelining takes effect only without fixed steps and outside grouped mode. Before the Cluster-tree
+	 * or its Transformers are changed from outside the Engine, call synchronize().
 	 */
 	class Engine : public Ogre::FrameListener
 	{
+	private: // class vars
+
+		/// The current revision of the structure of the Cluster-tree.
+		static uint __structure_revision;
+
+	private: // vars
+
+		/// The compiled Cluster-tree which will be executed every frame.
+		ExecutionPlan _plan;
+
+		/// The structure revision the plan was compiled from.
+		uint _plan_revision;
+
+		/// The ThreadPool for parallel processing or NULL when processing serially.
+		ThreadPool* _pool;
+
+		/// The duration of one simulation step in seconds or 0 to simulate one step per frame.
+		float _fixed_step;
+
+		/// The maximum number of fixed steps per frame. Time beyond will be dropped.
+		uint _max_steps;
+
+		/// The elapsed time that has not been simulated yet.
+		float _accumulator;
+
+		/// Indicates whether the Nodes shall be blended between the last two fixed steps.
+		bool _interpolation;
+
+		/// Blends the Nodes between the last two fixed steps.
+		NodeInterpolator _interpolator;
+
+		/// Indicates whether the thread-safe Clusters shall be processed on a simulation thread.
+		bool _pipelined;
+
+		/// Processes the thread-safe Clusters on a simulation thread in pipelined mode.
+		SimulationPipeline _pipeline;
+
+		/// The time the render thread spent on the other Clusters in the last pipelined step.
+		Clock::Ticks _serial_ticks;
+
 	public: // constructor & destructor
 
 		/**
 		 * Main constructor.
 		 */
 		Engine()
+			: _plan_revision(0),
+			_pool(0),
+			_fixed_step(0),
+			_max_steps(TRIP_ENGINE_MAX_STEPS),
+			_accumulator(0),
+			_interpolation(true),
+			_pipelined(false),
+			_serial_ticks(0)
 		{}
 
 
 		/**
 		 * Destructor.
+		 * Stops the worker threads, if there are any.
 		 */
-		~Engine()
-		{}
+		~Engine();
+
+	public: // class methods
+
+		/**
+		 * Indicates that the structure of the Cluster-tree has changed,
+		 * e.g. a Cluster or a Transformer has been added, removed, enabled or disabled.
+		 * Every Engine will recompile its ExecutionPlan before processing the next frame.
+		 * Call it before destroying Nodes: blended Nodes are set back to their simulated transforms.
+		 */
+		static void invalidatePlan()
+		{
+			NodeInterpolator::restoreAll();
+			++__structure_revision;
+		}
 
 	public: // methods
 
 		/// Method derived by Ogre::FrameListener. Processes everything.
 		bool frameRenderingQueued( const Ogre::FrameEvent& evt);
 
+		/**
+		 * Processes one frame: advances the fadings and applies all Transformers,
+		 * either once or in fixed steps.
+		 * Call it directly when running without Ogre's render loop.
+		 * @param tlc The time since the last frame.
+		 */
+		void step( float tlc);
+
+		/**
+		 * Waits for the running step of the simulation thread and writes it to the Nodes.
+		 * Call it before changing the Cluster-tree or its Transformers in pipelined mode.
+		 * Does nothing otherwise.
+		 */
+		void synchronize();
+
+		/**
+		 * Indicates whether the next step may change any Node.
+		 * Use it to stop rendering while the scene stands still.
+		 * @return
+		 * TRUE - the tree has changed, a fading runs or an enabled Cluster has Transformers
+		 * FALSE - the next step would change nothing
+		 */
+		bool isAnimating();
+
+	public: // getters & setters
+
+		/**
+		 * Sets the number of threads that process the Transformers.
+		 * With more than one thread, Clusters with thread-safe Transformers
+		 * will be processed in parallel. The results stay the same.
+		 * @param threadCount The number of threads including the render thread.
+		 * 0 or 1 processes everything on the render thread.
+		 */
+		void setThreadCount( uint threadCount);
+
+		/**
+		 * Retrieves the number of threads that process the Transformers.
+		 * @return The number of threads including the render thread.
+		 */
+		uint getThreadCount();
+
+		/**
+		 * Retrieves the ExecutionPlan the Engine processes.
+		 * @return The compiled plan of the Cluster-tree.
+		 */
+		ExecutionPlan& getPlan()
+		{
+			return _plan;
+		}
+
+		/**
+		 * Sets whether the Transformers shall be processed level by level, grouped by their type.
+		 * Grouped processing runs on the render thread only.
+		 * @param grouped
+		 * TRUE - hand the work of all Transformers of a type to their TransformKernel at once
+		 * FALSE - process every Cluster on its own, in parallel if possible
+		 * @see ExecutionPlan::setGrouped()
+		 */
+		void setGrouped( bool grouped)
+		{
+			_plan.setGrouped( grouped);
+
+			// recompile before the next frame
+			_plan_revision = 0;
+		}
+
+		/**
+		 * Indicates whether the Transformers are processed level by level, grouped by their type.
+		 * @return
+		 * TRUE - grouped processing
+		 * FALSE - every Cluster is processed on its own
+		 */
+		bool isGrouped()
+		{
+			return _plan.isGrouped();
+		}
+
+		/**
+		 * Sets the duration of one simulation step.
+		 * @param seconds The duration of a fixed step
+		 * or 0 to simulate one step with the duration of every frame.
+		 */
+		void setFixedStep( float seconds);
+
+		/**
+		 * Retrieves the duration of one simulation step.
+		 * @return The duration of a fixed step in seconds or 0 if every frame is one step.
+		 */
+		float getFixedStep()
+		{
+			return _fixed_step;
+		}
+
+		/**
+		 * Sets the maximum number of fixed steps per frame.
+		 * If a frame took longer, the remaining time will be dropped
+		 * instead of letting the simulation fall further behind.
+		 * @param maxSteps The maximum number of steps, at least 1.
+		 */
+		void setMaxSteps( uint maxSteps)
+		{
+			_max_steps = maxSteps > 0 ? maxSteps : 1;
+		}
+
+		/**
+		 * Retrieves the maximum number of fixed steps per frame.
+		 * @return The maximum number of steps.
+		 */
+		uint getMaxSteps()
+		{
+			return _max_steps;
+		}
+
+		/**
+		 * Sets whether the Nodes shall be blended between the last two fixed steps.
+		 * Without interpolation, the Nodes show the state of the last step.
+		 * @param interpolation
+		 * TRUE - blend the Nodes for rendering
+		 * FALSE - render the last step as it is
+		 */
+		void setInterpolation( bool interpolation);
+
+		/**
+		 * Indicates whether the Nodes are blended between the last two fixed steps.
+		 * @return
+		 * TRUE - the Nodes are blended
+		 * FALSE - the Nodes show the last step
+		 */
+		bool isInterpolation()
+		{
+			return _interpolation;
+		}
+
+		/**
+		 * Sets whether the thread-safe Clusters shall be processed on a simulation thread,
+		 * while the render thread goes on. Their Nodes then show the state one step later.
+		 * @param pipelined
+		 * TRUE - pipeline the thread-safe Clusters, unless fixed steps or grouped mode are set
+		 * FALSE - process all Clusters within the frame
+		 */
+		void setPipelined( bool pipelined)
+		{
+			_pipelined = pipelined;
+		}
+
+		/**
+		 * Indicates whether the thread-safe Clusters are processed on a simulation thread.
+		 * @return
+		 * TRUE - pipelined mode
+		 * FALSE - all Clusters are processed within the frame
+		 */
+		bool isPipelined()
+		{
+			return _pipelined;
+		}
+
 	private: // helpers
 
 		/**
-		 * Processes the transformers recursively on the whole tree.
-		 * Iterates through the tree and applies higher level Transformers to every child Cluster,
-		 * their children and so on.
-		 * @param cluster The current cluster to process.
-		 * @param context The list of clusters that are the parents of the current cluster.
-		 * @param tlc The time since the last frame rendered.
+		 * Simulates one step: advances the fadings and applies all Transformers.
+		 * Recompiles the plan if the tree has changed.
+		 * @param tlc The duration of the step.
+		 * @param capture Indicates whether the interpolator shall take snapshots around the step.
 		 */
-		void process( Cluster* cluster, std::list<Cluster*> context, float tlc);
+		void simulate( float tlc, bool capture);
 
+		/**
+		 * Simulates one step in pipelined mode: takes over the step of the simulation thread,
+		 * starts the next one and processes the Clusters that are not thread-safe meanwhile.
+		 * @param tlc The duration of the step.
+		 */
+		void simulatePipelined( float tlc);
+
+		/**
+		 * Recompiles the plan, if the tree has changed.
+		 * @return
+		 * TRUE - the plan was recompiled
+		 * FALSE - the plan is up to date
+		 */
+		bool updatePlan();
+
+		/**
+		 * Records the time of a frame and lets the LodPolicy compare it to the frame budget.
+		 * @param elapsed The time the Engine needed for the frame.
+		 */
+		void finishStep( Clock::Ticks elapsed);
 
 	}; // END class Engine
 
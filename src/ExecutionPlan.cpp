@@ -0,0 +1,701 @@
+/**
+ * Implementation file for the ExecutionPlan.hpp.
+ * @author barn
+ * @version 20121210
+ */
+
+/*===========================================================================*
+ * INCLUDES (associated header files)
+ *===========================================================================*/
+#include "ExecutionPlan.hpp"
+
+/*===========================================================================*
+ * INCLUDES project headers
+ *===========================================================================*/
+#include <LodPolicy.hpp>
+#include <clusters/Cluster.hpp>
+#include <transformers/Transformer.hpp>
+#include <util/ThreadPool.hpp>
+
+/*===========================================================================*
+ * INCLUDES C/C++ standard library (and other external libraries)
+ *===========================================================================*/
+#include <algorithm>
+#include <functional>
+
+/*===========================================================================*
+ * DEFINES and MACROS
+ *===========================================================================*/
+
+/// The maximum number of Nodes that are processed as one parallel task.
+#define TRIP_PLAN_CHUNK_SIZE 128
+
+/*===========================================================================*
+ * NAMESPACE, CONSTANTS and TYPE DECLARATIONS/IMPLEMENTATIONS
+ *===========================================================================*/
+
+namespace Trip
+{
+
+	/**
+	 * Compiles the given Cluster-tree into the plan and replaces the old plan.
+	 * Disabled Clusters, with their children, and inactive Transformers will be left out.
+	 * Subtrees without any active Transformer will not even be visited.
+	 * The memory of the former plan will be reused.
+	 * @param root The root Cluster of the tree to compile.
+	 */
+	void ExecutionPlan::compile( Cluster* root)
+	{
+		clear();
+
+		if( root && root->isEnabled() && root->getSubtreeTransformerCount() > 0)
+		{
+			compileCluster( root, 0);
+		}
+
+		_deltas.resize( _nodes.size());
+
+		_work.clear();
+		_items.clear();
+		_levels.clear();
+		if( _grouped)
+		{
+			compileGroups();
+		}
+	}
+
+
+	/**
+	 * Applies the Transformers of the plan on its Nodes.
+	 * For every target Node, the Transformers of its Cluster will be applied in their order,
+	 * weighted by the fade values of the Cluster and its ancestors.
+	 * Clusters that are not due in this frame are skipped and catch up on the time later.
+	 * @param tlc The time since the last frame rendered.
+	 * @param pool The ThreadPool to process thread-safe Clusters in parallel
+	 * or NULL to process everything on the calling thread.
+	 */
+	void ExecutionPlan::execute( float tlc, ThreadPool* pool)
+	{
+		prepare( tlc);
+
+		if( _grouped)
+		{
+			executeGroups();
+			return;
+		}
+
+		run( pool, PASS_ALL);
+	}
+
+
+	/**
+	 * Computes the weights and the times of all Entries for the current frame.
+	 * Call it on the thread that owns the Cluster-tree, before run().
+	 * @param tlc The time since the last frame rendered.
+	 */
+	void ExecutionPlan::prepare( float tlc)
+	{
+		_chunks.clear();
+
+		if( _profiling)
+		{
+			_transformer_ticks.assign( _transformers.size(), 0);
+			_batches.assign( _entries.size(), 1);
+			_chunk_ticks.clear();
+		}
+
+		// parents come before their children in the entries
+		const uint entry_count = _entries.size();
+		_weights.resize( entry_count);
+		for( uint e = 0; e < entry_count; ++e)
+		{
+			const Entry& entry = _entries[e];
+			const float parent_weight = entry.parent == e ? 1.0f : _weights[entry.parent];
+			_weights[e] = parent_weight * entry.cluster->getFadeValue();
+		}
+
+		scheduleEntries( tlc);
+	}
+
+
+	/**
+	 * Applies the Transformers of the Entries of a pass on their targets, see getTargets().
+	 * The thread-safe pass and the other pass may run on two threads at once,
+	 * since every Node is the target of exactly one Entry. Then only the thread-safe pass
+	 * may get a ThreadPool. Not for grouped mode.
+	 * @param pool The ThreadPool to process thread-safe Clusters in parallel
+	 * or NULL to process everything on the calling thread.
+	 * @param pass The Entries to process.
+	 */
+	void ExecutionPlan::run( ThreadPool* pool, Pass pass)
+	{
+		const uint entry_count = _entries.size();
+		for( uint e = 0; e < entry_count; ++e)
+		{
+			const Entry& entry = _entries[e];
+			if( entry.transformer_count == 0 || entry.node_count == 0 || _skipped[e])
+				continue;
+
+			if( (pass == PASS_THREAD_SAFE && !entry.thread_safe) || (pass == PASS_OTHERS && entry.thread_safe))
+				continue;
+
+			if( pool == 0 || !isParallel( entry))
+			{
+				executeRange( entry, 0, entry.node_count, _profiling ? &_transformer_ticks[entry.first_transformer] : 0);
+				continue;
+			}
+
+			// Ogre::Node notifies its parent on the first change after an update.
+			// Do that here, so that the parallel tasks only touch their own Nodes.
+			Ogre::Node** nodes = getTargets( entry);
+			for( uint i = 0; i < entry.node_count; ++i)
+			{
+				nodes[i]->needUpdate();
+			}
+
+			for( uint begin = 0; begin < entry.node_count; begin += TRIP_PLAN_CHUNK_SIZE)
+			{
+				Chunk chunk;
+				chunk.entry = e;
+				chunk.begin = begin;
+				chunk.end = std::min<uint>( begin + TRIP_PLAN_CHUNK_SIZE, entry.node_count);
+				chunk.first_ticks = _chunk_ticks.size();
+				_chunks.push_back( chunk);
+
+				if( _profiling)
+				{
+					_chunk_ticks.resize( _chunk_ticks.size() + entry.transformer_count, 0);
+				}
+			}
+
+			if( _profiling)
+			{
+				_batches[e] = (entry.node_count + TRIP_PLAN_CHUNK_SIZE - 1) / TRIP_PLAN_CHUNK_SIZE;
+			}
+		}
+
+		if( pool && !_chunks.empty())
+		{
+			pool->parallelFor( &ExecutionPlan::executeChunks, this, _chunks.size(), 1);
+
+			// sum up the times of the chunks
+			if( _profiling)
+			{
+				for( auto it = _chunks.begin(); it != _chunks.end(); ++it)
+				{
+					const Entry& entry = _entries[it->entry];
+					for( uint t = 0; t < entry.transformer_count; ++t)
+					{
+						_transformer_ticks[entry.first_transformer + t] += _chunk_ticks[it->first_ticks + t];
+					}
+				}
+			}
+		}
+	}
+
+
+	/**
+	 * Clears the plan but keeps its memory.
+	 */
+	void ExecutionPlan::clear()
+	{
+		_entries.clear();
+		_nodes.clear();
+		_transformers.clear();
+		_shadows.clear();
+	}
+
+
+	/**
+	 * Lets the thread-safe Entries work on shadow Nodes instead of their target Nodes.
+	 * @param shadows One Node per target Node, in the order of getNodes().
+	 * The Nodes of Entries that are not thread-safe must be the target Nodes themselves.
+	 * An empty array lets all Entries work on their target Nodes again.
+	 */
+	void ExecutionPlan::setShadows( const std::vector<Ogre::Node*>& shadows)
+	{
+		_shadows.assign( shadows.begin(), shadows.end());
+	}
+
+	/**
+	 * Compiles the given Cluster and its enabled child Clusters recursively.
+	 * @param cluster The Cluster to compile. Must be enabled.
+	 * @param parent The index of the parent's Entry or the index the new Entry will get for the root.
+	 */
+	void ExecutionPlan::compileCluster( Cluster* cluster, uint parent)
+	{
+		const uint index = _entries.size();
+
+		Entry entry;
+		entry.cluster = cluster;
+		entry.parent = parent;
+		entry.first_node = _nodes.size();
+		entry.first_transformer = _transformers.size();
+		entry.thread_safe = true;
+		entry.deferrable = true;
+
+		// the cluster's own active transformers
+		const TransformerVector& transformers = cluster->getAllTransformers();
+		for( auto it = transformers.begin(); it != transformers.end(); ++it)
+		{
+			if( (*it)->isActive())
+			{
+				_transformers.push_back( *it);
+				entry.thread_safe &= (*it)->isThreadSafe();
+				entry.deferrable &= (*it)->isDeferrable();
+			}
+		}
+		entry.transformer_count = _transformers.size() - entry.first_transformer;
+
+		// targets: the cluster's own nodes and the cluster nodes of its enabled children
+		const NodeList& nodes = cluster->getNodes();
+		_nodes.insert( _nodes.end(), nodes.begin(), nodes.end());
+
+		const ClusterList& clusters = cluster->getAllClusters();
+		for( auto it = clusters.begin(); it != clusters.end(); ++it)
+		{
+			if( (*it)->isEnabled())
+			{
+				_nodes.push_back( (*it)->getClusterNode());
+			}
+		}
+		entry.node_count = _nodes.size() - entry.first_node;
+
+		_entries.push_back( entry);
+
+		// compile child clusters, unless nothing changes within their subtrees
+		for( auto it = clusters.begin(); it != clusters.end(); ++it)
+		{
+			if( (*it)->isEnabled() && (*it)->getSubtreeTransformerCount() > 0)
+			{
+				compileCluster( *it, index);
+			}
+		}
+	}
+
+
+	/**
+	 * Decides which Entries are updated in the current frame and how much time they simulate.
+	 * An Entry that is due simulates the time of this frame and of all frames its Cluster skipped before.
+	 * An Entry that is not due defers the time of this frame to its Cluster.
+	 * Entries with a Transformer that is not deferrable are due in every frame.
+	 * @param tlc The time since the last frame rendered.
+	 */
+	void ExecutionPlan::scheduleEntries( float tlc)
+	{
+		LodPolicy* lod = LodPolicy::instance();
+
+		const uint entry_count = _entries.size();
+		_times.resize( entry_count);
+		_skipped.resize( entry_count);
+		for( uint e = 0; e < entry_count; ++e)
+		{
+			const Entry& entry = _entries[e];
+			Cluster* cluster = entry.cluster;
+			if( entry.transformer_count == 0)
+			{
+				_times[e] = tlc;
+				_skipped[e] = false;
+			}
+			else if( !entry.deferrable || lod->isDue( cluster, e))
+			{
+				const float deferred = cluster->takeDeferredTime();
+				_times[e] = tlc + deferred;
+				_skipped[e] = false;
+				cluster->ageBounds( deferred > 0);
+			}
+			else
+			{
+				cluster->deferTime( tlc);
+				_times[e] = 0;
+				_skipped[e] = true;
+			}
+		}
+	}
+
+
+	/**
+	 * Applies the Transformers of an Entry on a range of its Nodes.
+	 * Every Transformer processes the whole range as one batch.
+	 * The changes of accumulating Transformers are committed once per run of them,
+	 * so the order of the Transformers on each Node stays the same.
+	 * Uniform Transformers compute their delta once for the whole range. As long as a run
+	 * consists of uniform Transformers only, a single shared delta is committed to every Node.
+	 * While profiling, a commit is measured with the Transformer during which it happens.
+	 * @param entry The Entry to process.
+	 * @param begin The first Node index within the Entry.
+	 * @param end The Node index after the last one within the Entry.
+	 * @param ticks Receives the time of every Transformer of the Entry or NULL to measure nothing.
+	 */
+	void ExecutionPlan::executeRange( const Entry& entry, uint begin, uint end, Clock::Ticks* ticks)
+	{
+		Ogre::Node** nodes = getTargets( entry) + begin;
+		TransformDelta* deltas = &_deltas[0] + entry.first_node + begin;
+		Transformer** transformers = &_transformers[0] + entry.first_transformer;
+		const uint e = &entry - &_entries[0];
+		const float weight = _weights[e];
+		const float tlc = _times[e];
+		const uint count = end - begin;
+
+		TransformDelta shared;
+		DeltaState state = DELTAS_NONE;
+		Clock::Ticks last = ticks ? Clock::now() : 0;
+		for( uint t = 0; t < entry.transformer_count; ++t)
+		{
+			Transformer* transformer = transformers[t];
+			if( !transformer->isAccumulating())
+			{
+				// the Transformer has to see the changes of the former ones
+				commitDeltas( nodes, deltas, shared, count, state);
+				transformer->transformBatch( nodes, count, begin, tlc, weight);
+			}
+			else if( transformer->isUniform())
+			{
+				if( state == DELTAS_PER_NODE)
+				{
+					// append the same delta to every Node's delta
+					TransformDelta uniform;
+					transformer->accumulateUniform( uniform, tlc, weight);
+					for( uint k = 0; k < count; ++k)
+					{
+						deltas[k].append( uniform);
+					}
+				}
+				else
+				{
+					if( state == DELTAS_NONE)
+					{
+						shared.reset();
+						state = DELTAS_SHARED;
+					}
+					transformer->accumulateUniform( shared, tlc, weight);
+				}
+			}
+			else
+			{
+				if( state == DELTAS_NONE)
+				{
+					shared.reset();
+				}
+				if( state != DELTAS_PER_NODE)
+				{
+					// every Node starts with the uniform changes so far
+					for( uint k = 0; k < count; ++k)
+					{
+						deltas[k] = shared;
+					}
+					state = DELTAS_PER_NODE;
+				}
+				transformer->accumulate( nodes, deltas, count, begin, tlc, weight);
+			}
+
+			if( ticks)
+			{
+				if( t + 1 == entry.transformer_count)
+				{
+					commitDeltas( nodes, deltas, shared, count, state);
+				}
+
+				Clock::Ticks now = Clock::now();
+				ticks[t] += now - last;
+				last = now;
+			}
+		}
+
+		commitDeltas( nodes, deltas, shared, count, state);
+	}
+
+
+	/**
+	 * Applies the pending TransformDeltas of a range of Nodes to the Nodes.
+	 * Does nothing if no changes are pending.
+	 * @param nodes The first Node of the range.
+	 * @param deltas The delta of the first Node of the range.
+	 * @param shared The delta of all Nodes, if only uniform Transformers are pending.
+	 * @param count The number of Nodes.
+	 * @param state The kind of pending changes, will be DELTAS_NONE afterwards.
+	 */
+	void ExecutionPlan::commitDeltas( Ogre::Node** nodes, TransformDelta* deltas, TransformDelta& shared, uint count, DeltaState& state)
+	{
+		if( state == DELTAS_SHARED)
+		{
+			shared.commitShared( nodes, count);
+		}
+		else if( state == DELTAS_PER_NODE)
+		{
+			TransformDelta::commitBatch( nodes, deltas, count);
+		}
+		state = DELTAS_NONE;
+	}
+
+
+	/**
+	 * Retrieves the Nodes the Transformers of an Entry change.
+	 * These are the shadows, if there are any, otherwise the target Nodes.
+	 * @param entry The Entry.
+	 * @return The first Node of the Entry.
+	 */
+	Ogre::Node** ExecutionPlan::getTargets( const Entry& entry)
+	{
+		return (_shadows.empty() ? &_nodes[0] : &_shadows[0]) + entry.first_node;
+	}
+
+
+	/**
+	 * Indicates whether an Entry may be processed in parallel in the current frame.
+	 * @param entry The Entry to check.
+	 * @return
+	 * TRUE - all Transformers are thread-safe
+	 * FALSE - the Entry has to be processed serially
+	 */
+	bool ExecutionPlan::isParallel( const Entry& entry)
+	{
+		return entry.thread_safe;
+	}
+
+
+	/**
+	 * ThreadPool task that processes a range of chunks.
+	 * @param context The ExecutionPlan.
+	 * @param begin The first chunk to process.
+	 * @param end The chunk after the last one to process.
+	 */
+	void ExecutionPlan::executeChunks( void* context, uint begin, uint end)
+	{
+		ExecutionPlan* plan = static_cast<ExecutionPlan*>( context);
+
+		for( uint c = begin; c < end; ++c)
+		{
+			const Chunk& chunk = plan->_chunks[c];
+			Clock::Ticks* ticks = plan->_profiling ? &plan->_chunk_ticks[chunk.first_ticks] : 0;
+			plan->executeRange( plan->_entries[chunk.entry], chunk.begin, chunk.end, ticks);
+		}
+	}
+
+
+	/**
+	 * Builds the levels of grouped mode from the compiled entries.
+	 * Level k holds the k-th Transformer of every Entry. Within a level,
+	 * the order does not matter, so works with the same kernel are put next to each other.
+	 */
+	void ExecutionPlan::compileGroups()
+	{
+		uint level_count = 0;
+		for( auto it = _entries.begin(); it != _entries.end(); ++it)
+		{
+			if( it->node_count > 0)
+			{
+				level_count = std::max( level_count, it->transformer_count);
+			}
+		}
+
+		const uint entry_count = _entries.size();
+		for( uint level = 0; level < level_count; ++level)
+		{
+			const uint level_begin = _work.size();
+			_levels.push_back( level_begin);
+
+			for( uint e = 0; e < entry_count; ++e)
+			{
+				const Entry& entry = _entries[e];
+				if( entry.node_count == 0 || entry.transformer_count <= level)
+					continue;
+
+				Work work;
+				work.entry = e;
+				work.transformer = entry.first_transformer + level;
+
+				Transformer* transformer = _transformers[work.transformer];
+				work.kernel = transformer->isAccumulating() ? transformer->getKernel() : 0;
+				_work.push_back( work);
+			}
+
+			std::stable_sort( _work.begin() + level_begin, _work.end(), &ExecutionPlan::compareKernels);
+		}
+		_levels.push_back( _work.size());
+
+		// the kernel items only change their weights, times and counts from frame to frame
+		for( auto it = _work.begin(); it != _work.end(); ++it)
+		{
+			const Entry& entry = _entries[it->entry];
+
+			TransformKernel::Item item;
+			item.transformer = _transformers[it->transformer];
+			item.nodes = &_nodes[0] + entry.first_node;
+			item.deltas = &_deltas[0] + entry.first_node;
+			item.count = entry.node_count;
+			item.first_index = 0;
+			item.weight = 1;
+			item.tlc = 0;
+			_items.push_back( item);
+		}
+	}
+
+
+	/**
+	 * Processes all levels in grouped mode.
+	 * Consecutive works with the same kernel are handed to the kernel in one call,
+	 * all other works are processed one by one.
+	 */
+	void ExecutionPlan::executeGroups()
+	{
+		_pending.assign( _entries.size(), false);
+
+		for( uint level = 0; level + 1 < _levels.size(); ++level)
+		{
+			const uint level_end = _levels[level + 1];
+			uint w = _levels[level];
+			while( w < level_end)
+			{
+				TransformKernel* kernel = _work[w].kernel;
+				if( !kernel)
+				{
+					if( !_skipped[_work[w].entry])
+					{
+						executeWork( w);
+					}
+					++w;
+					continue;
+				}
+
+				// find the works of the kernel, skipped Entries get no Nodes
+				uint group_end = w;
+				uint group_nodes = 0;
+				for( ; group_end < level_end && _work[group_end].kernel == kernel; ++group_end)
+				{
+					const uint e = _work[group_end].entry;
+					TransformKernel::Item& item = _items[group_end];
+					if( _skipped[e])
+					{
+						item.count = 0;
+						continue;
+					}
+
+					beginDeltas( e);
+					item.count = _entries[e].node_count;
+					item.weight = _weights[e];
+					item.tlc = _times[e];
+					group_nodes += item.count;
+				}
+
+				Clock::Ticks start = _profiling ? Clock::now() : 0;
+				kernel->execute( &_items[w], group_end - w);
+
+				// share the time of the kernel by the number of Nodes
+				if( _profiling && group_nodes > 0)
+				{
+					const Clock::Ticks ticks = Clock::now() - start;
+					for( uint g = w; g < group_end; ++g)
+					{
+						_transformer_ticks[_work[g].transformer] += ticks * _items[g].count / group_nodes;
+					}
+				}
+
+				w = group_end;
+			}
+		}
+
+		const uint entry_count = _entries.size();
+		for( uint e = 0; e < entry_count; ++e)
+		{
+			commitEntry( e);
+		}
+	}
+
+
+	/**
+	 * Processes one work in grouped mode, for Transformers without a kernel.
+	 * @param w The index of the work.
+	 */
+	void ExecutionPlan::executeWork( uint w)
+	{
+		const Work& work = _work[w];
+		const Entry& entry = _entries[work.entry];
+		Transformer* transformer = _transformers[work.transformer];
+		Ogre::Node** nodes = &_nodes[0] + entry.first_node;
+		TransformDelta* deltas = &_deltas[0] + entry.first_node;
+		const float weight = _weights[work.entry];
+		const float tlc = _times[work.entry];
+
+		Clock::Ticks start = _profiling ? Clock::now() : 0;
+
+		if( !transformer->isAccumulating())
+		{
+			// the Transformer has to see the changes of the former ones
+			commitEntry( work.entry);
+			transformer->transformBatch( nodes, entry.node_count, 0, tlc, weight);
+		}
+		else if( transformer->isUniform())
+		{
+			beginDeltas( work.entry);
+
+			TransformDelta uniform;
+			transformer->accumulateUniform( uniform, tlc, weight);
+			for( uint k = 0; k < entry.node_count; ++k)
+			{
+				deltas[k].append( uniform);
+			}
+		}
+		else
+		{
+			beginDeltas( work.entry);
+			transformer->accumulate( nodes, deltas, entry.node_count, 0, tlc, weight);
+		}
+
+		if( _profiling)
+		{
+			_transformer_ticks[work.transformer] += Clock::now() - start;
+		}
+	}
+
+
+	/**
+	 * Starts collecting changes in the TransformDeltas of an Entry, unless it already does.
+	 * @param e The index of the Entry.
+	 */
+	void ExecutionPlan::beginDeltas( uint e)
+	{
+		if( _pending[e])
+			return;
+
+		const Entry& entry = _entries[e];
+		TransformDelta* deltas = &_deltas[0] + entry.first_node;
+		for( uint k = 0; k < entry.node_count; ++k)
+		{
+			deltas[k].reset();
+		}
+		_pending[e] = true;
+	}
+
+
+	/**
+	 * Commits the collected changes of an Entry to its Nodes, if there are any.
+	 * @param e The index of the Entry.
+	 */
+	void ExecutionPlan::commitEntry( uint e)
+	{
+		if( !_pending[e])
+			return;
+
+		const Entry& entry = _entries[e];
+		Ogre::Node** nodes = &_nodes[0] + entry.first_node;
+		TransformDelta* deltas = &_deltas[0] + entry.first_node;
+		TransformDelta::commitBatch( nodes, deltas, entry.node_count);
+		_pending[e] = false;
+	}
+
+
+	/**
+	 * Orders works by their kernels.
+	 * @param a The first work.
+	 * @param b The second work.
+	 * @return
+	 * TRUE - a comes before b
+	 * FALSE - otherwise
+	 */
+	bool ExecutionPlan::compareKernels( const Work& a, const Work& b)
+	{
+		return std::less<TransformKernel*>()( a.kernel, b.kernel);
+	}
+
+} // END namespace Trip
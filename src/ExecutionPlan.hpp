@@ -0,0 +1,511 @@
+/**
+ * This file contains the ExecutionPlan class, a flat and precompiled
+ * image of a Cluster-tree that the Engine replays every frame.
+ * @author barn
+ * @version 20121204
+ */
+#ifndef __ExecutionPlan_HPP__
+#define __ExecutionPlan_HPP__
+
+/*===========================================================================*
+ * INCLUDES base definition file for DLL import/export
+ *===========================================================================*/
+
+/*===========================================================================*
+ * INCLUDES project headers
+ *===========================================================================*/
+#include "stdafx.h"
+#include <util/Clock.hpp>
+#include <transformers/TransformDelta.hpp>
+#include <transformers/TransformKernel.hpp>
+
+/*===========================================================================*
+ * INCLUDES C/C++ standard library (and other external libraries)
+ *===========================================================================*/
+
+/*===========================================================================*
+ * DEFINES and MACROS
+ *===========================================================================*/
+
+/*===========================================================================*
+ * NAMESPACE, CONSTANTS and TYPE DECLARATIONS/IMPLEMENTATIONS
+ *===========================================================================*/
+
+namespace Trip
+{
+	class Cluster;
+	class Transformer;
+	class ThreadPool;
+
+	/**
+	 * The ExecutionPlan compiles a tree of Clusters into contiguous arrays:
+	 * one array of all target Nodes and one array holding the active Transformers
+	 * of every enabled Cluster.
+	 *
+	 * The targets of a Cluster are its own Nodes, followed by the cluster nodes of its
+	 * enabled child Clusters. Therefore, a Cluster's Transformers are applied once to every
+	 * child Cluster and the node hierarchy propagates the result to all descendant Nodes.
+	 * The running index of a target is its position within the targets of its Cluster.
+	 *
+	 * Clusters whose subtree has no active Transformer get no Entry of their own, since
+	 * nothing would change within them. Their cluster nodes are still targets of their parent.
+	 *
+	 * Compiling walks the tree once. Executing the plan only iterates over
+	 * the arrays and does not allocate any memory, so the plan should be compiled
+	 * when the structure of the tree changes and executed every frame.
+	 *
+	 * Fadings are advanced by the FadeScheduler before the plan is executed, so executing
+	 * only reads the fade values. The fade value of a Cluster weights the influence of its
+	 * Transformers and of the Transformers of all its descendants.
+	 *
+	 * When executed with a ThreadPool, the Nodes of Clusters whose Transformers are all
+	 * thread-safe are split into chunks and processed in parallel. All other Clusters are
+	 * processed serially. Since the running index is kept per Node, both ways lead
+	 * to the same results.
+	 *
+	 * Consecutive accumulating Transformers of an Entry write into one TransformDelta per Node,
+	 * which is committed before the next Transformer that changes the Nodes directly and after
+	 * the last Transformer. So a Node with only accumulating Transformers is updated once per frame.
+	 * Uniform Transformers compute their delta once per range instead of once per Node.
+	 *
+	 * In grouped mode, the plan processes the Transformers level by level instead of Cluster by Cluster:
+	 * level k holds the k-th Transformer of every Entry. Since every Node is the target of exactly one Entry,
+	 * the order of the Transformers on each Node stays the same. Within a level, the work of all Transformers
+	 * that share a TransformKernel is handed to the kernel in one call. Grouped mode runs on the calling thread.
+	 *
+	 * Clusters that the LodPolicy does not update in a frame are skipped. Their Transformers get
+	 * the time of the skipped frames added to the time of their next update.
+	 *
+	 * Executing can also be split: prepare() computes the weights and times on the thread that owns
+	 * the tree, then run() processes the thread-safe Entries and the other Entries in two passes,
+	 * which may run on two threads at once. With shadows set, see setShadows(), the thread-safe
+	 * Entries change copies of their Nodes that are not part of the scene.
+	 *
+	 * With profiling enabled, the plan measures the time every Transformer spends per frame.
+	 * Parallel chunks measure into their own slots, which are summed up after the frame.
+	 *
+	 * @see Engine::invalidatePlan()
+	 */
+	class ExecutionPlan
+	{
+	public: // nested types
+
+		/// The Entries that run() processes.
+		enum Pass
+		{
+			/// All Entries.
+			PASS_ALL,
+
+			/// The Entries whose Transformers are all thread-safe.
+			PASS_THREAD_SAFE,
+
+			/// The Entries with a Transformer that is not thread-safe.
+			PASS_OTHERS
+		};
+
+		/**
+		 * An enabled Cluster of the compiled tree. Refers to ranges
+		 * within the node array and the transformer array of the plan.
+		 */
+		struct Entry
+		{
+			/// The Cluster this entry was compiled from.
+			Cluster* cluster;
+
+			/// Index of the first target Node of the Cluster within the node array.
+			uint first_node;
+
+			/// Number of target Nodes, meaning own Nodes and cluster nodes of enabled child Clusters.
+			uint node_count;
+
+			/// Index of the first Transformer of the Cluster within the transformer array.
+			uint first_transformer;
+
+			/// Number of active Transformers to apply on every target Node.
+			uint transformer_count;
+
+			/// Indicates whether all Transformers of the Entry are thread-safe.
+			bool thread_safe;
+
+			/// Indicates whether all Transformers of the Entry may skip frames, see Transformer::isDeferrable().
+			bool deferrable;
+
+			/// The index of the Entry of the parent Cluster or the own index for the root.
+			uint parent;
+		};
+
+		/// A range of Nodes of one Entry that is processed as a single parallel task.
+		struct Chunk
+		{
+			/// The index of the Entry.
+			uint entry;
+
+			/// The first Node index within the Entry.
+			uint begin;
+
+			/// The Node index after the last one within the Entry.
+			uint end;
+
+			/// The index of the chunk's first slot in the chunk time array, one slot per Transformer.
+			uint first_ticks;
+		};
+
+	private: // nested types
+
+		/// The work of one Transformer on all Nodes of its Entry in grouped mode.
+		struct Work
+		{
+			/// The index of the Entry.
+			uint entry;
+
+			/// The index of the Transformer within the transformer array.
+			uint transformer;
+
+			/// The kernel of the Transformer or NULL, if it is processed on its own.
+			TransformKernel* kernel;
+		};
+
+		/// The kind of changes that are pending while executing a range of Nodes.
+		enum DeltaState
+		{
+			/// Nothing to commit.
+			DELTAS_NONE,
+
+			/// One delta for all Nodes, only uniform Transformers have accumulated.
+			DELTAS_SHARED,
+
+			/// One delta per Node.
+			DELTAS_PER_NODE
+		};
+
+	private: // vars
+
+		/// All enabled Clusters in the order of a depth-first traversal.
+		std::vector<Entry> _entries;
+
+		/// The Nodes of all enabled Clusters. Every Entry refers to a range within this array.
+		std::vector<Ogre::Node*> _nodes;
+
+		/// The Nodes the Transformers change instead of the target Nodes, parallel to the node array or empty.
+		std::vector<Ogre::Node*> _shadows;
+
+		/// One TransformDelta per Node, parallel to the node array.
+		std::vector<TransformDelta> _deltas;
+
+		/// The active Transformers of all enabled Clusters.
+		std::vector<Transformer*> _transformers;
+
+		/// The chunks that are processed in parallel in the current frame.
+		std::vector<Chunk> _chunks;
+
+		/// The fade weight of every Entry in the current frame, including the weights of its ancestors.
+		std::vector<float> _weights;
+
+		/// The time to simulate for every Entry in the current frame, including the deferred time of skipped frames.
+		std::vector<float> _times;
+
+		/// Indicates for every Entry whether it is skipped in the current frame.
+		std::vector<bool> _skipped;
+
+		/// Indicates whether the time of every Transformer is measured.
+		bool _profiling;
+
+		/// Indicates whether the Transformers are processed level by level, grouped by their kernels.
+		bool _grouped;
+
+		/// The work of all levels in grouped mode. Within a level, work with the same kernel is adjacent.
+		std::vector<Work> _work;
+
+		/// The kernel item of every work, parallel to the work array.
+		std::vector<TransformKernel::Item> _items;
+
+		/// The index of the first work of every level, followed by the number of works.
+		std::vector<uint> _levels;
+
+		/// Indicates for every Entry whether its TransformDeltas hold changes to commit in grouped mode.
+		std::vector<bool> _pending;
+
+		/// The time every Transformer spent in the current frame. Only valid while profiling.
+		std::vector<Clock::Ticks> _transformer_ticks;
+
+		/// The time the Transformers spent per chunk in the current frame. Only valid while profiling.
+		std::vector<Clock::Ticks> _chunk_ticks;
+
+		/// The number of batches per Transformer of every Entry in the current frame. Only valid while profiling.
+		std::vector<uint> _batches;
+
+	public: // constructor & destructor
+
+		/**
+		 * Main constructor.
+		 * Creates an empty plan.
+		 */
+		ExecutionPlan()
+			: _profiling(false),
+			_grouped(false)
+		{}
+
+		/**
+		 * Destructor.
+		 */
+		~ExecutionPlan()
+		{}
+
+	public: // methods
+
+		/**
+		 * Compiles the given Cluster-tree into the plan and replaces the old plan.
+		 * Disabled Clusters, with their children, inactive Transformers and
+		 * subtrees without any active Transformer will be left out.
+		 * The memory of the former plan will be reused.
+		 * @param root The root Cluster of the tree to compile.
+		 */
+		void compile( Cluster* root);
+
+		/**
+		 * Applies the Transformers of the plan on its Nodes.
+		 * @param tlc The time since the last frame rendered.
+		 * @param pool The ThreadPool to process thread-safe Clusters in parallel
+		 * or NULL to process everything on the calling thread.
+		 */
+		void execute( float tlc, ThreadPool* pool = 0);
+
+		/**
+		 * Computes the weights and the times of all Entries for the current frame.
+		 * Call it on the thread that owns the Cluster-tree, before run().
+		 * @param tlc The time since the last frame rendered.
+		 */
+		void prepare( float tlc);
+
+		/**
+		 * Applies the Transformers of the Entries of a pass on their targets.
+		 * Not for grouped mode.
+		 * @param pool The ThreadPool to process thread-safe Clusters in parallel
+		 * or NULL to process everything on the calling thread.
+		 * @param pass The Entries to process.
+		 */
+		void run( ThreadPool* pool, Pass pass);
+
+		/**
+		 * Clears the plan but keeps its memory.
+		 */
+		void clear();
+
+	public: // getters & setters
+
+		/**
+		 * Retrieves all compiled Clusters.
+		 * @return The entries of the plan in the order of a depth-first traversal.
+		 */
+		const std::vector<Entry>& getEntries()
+		{
+			return _entries;
+		}
+
+		/**
+		 * Retrieves the number of target Nodes in the plan.
+		 * @return The number of Nodes and child Cluster cluster nodes of all enabled Clusters.
+		 */
+		uint getNodeCount()
+		{
+			return _nodes.size();
+		}
+
+		/**
+		 * Retrieves the target Nodes of all compiled Clusters.
+		 * Every Entry refers to a range within this array.
+		 * @return The Nodes of the plan.
+		 */
+		const std::vector<Ogre::Node*>& getNodes()
+		{
+			return _nodes;
+		}
+
+		/**
+		 * Lets the thread-safe Entries work on shadow Nodes instead of their target Nodes.
+		 * Compiling the plan removes the shadows.
+		 * @param shadows One Node per target Node, in the order of getNodes().
+		 * The Nodes of Entries that are not thread-safe must be the target Nodes themselves.
+		 * An empty array lets all Entries work on their target Nodes again.
+		 */
+		void setShadows( const std::vector<Ogre::Node*>& shadows);
+
+		/**
+		 * Retrieves the active Transformers of all compiled Clusters.
+		 * Every Entry refers to a range within this array.
+		 * @return The Transformers of the plan.
+		 */
+		const std::vector<Transformer*>& getTransformers()
+		{
+			return _transformers;
+		}
+
+		/**
+		 * Sets whether the time of every Transformer shall be measured.
+		 * @param profiling
+		 * TRUE - measure every Transformer
+		 * FALSE - do not measure anything
+		 */
+		void setProfiling( bool profiling)
+		{
+			_profiling = profiling;
+		}
+
+		/**
+		 * Indicates whether the time of every Transformer is measured.
+		 * @return
+		 * TRUE - profiling is enabled
+		 * FALSE - profiling is disabled
+		 */
+		bool isProfiling()
+		{
+			return _profiling;
+		}
+
+		/**
+		 * Sets whether the Transformers shall be processed level by level, grouped by their kernels.
+		 * Takes effect with the next compile().
+		 * @param grouped
+		 * TRUE - process the work of all Transformers with the same kernel at once
+		 * FALSE - process every Cluster on its own, in parallel if possible
+		 */
+		void setGrouped( bool grouped)
+		{
+			_grouped = grouped;
+		}
+
+		/**
+		 * Indicates whether the Transformers are processed level by level, grouped by their kernels.
+		 * @return
+		 * TRUE - grouped mode
+		 * FALSE - every Cluster is processed on its own
+		 */
+		bool isGrouped()
+		{
+			return _grouped;
+		}
+
+		/**
+		 * Retrieves the time every Transformer spent in the last execution, summed up over all threads.
+		 * Only valid if the plan was executed with profiling enabled.
+		 * @return The time per Transformer, in the order of getTransformers().
+		 */
+		const std::vector<Clock::Ticks>& getTransformerTicks()
+		{
+			return _transformer_ticks;
+		}
+
+		/**
+		 * Retrieves the number of batches every Transformer of an Entry processed in the last execution.
+		 * Only valid if the plan was executed with profiling enabled.
+		 * @return The number of batches per Entry, in the order of getEntries().
+		 */
+		const std::vector<uint>& getBatches()
+		{
+			return _batches;
+		}
+
+	private: // helpers
+
+		/**
+		 * Compiles the given Cluster and its enabled child Clusters recursively.
+		 * @param cluster The Cluster to compile. Must be enabled.
+		 * @param parent The index of the parent's Entry or the index the new Entry will get for the root.
+		 */
+		void compileCluster( Cluster* cluster, uint parent);
+
+		/**
+		 * Decides which Entries are updated in the current frame and how much time they simulate.
+		 * @param tlc The time since the last frame rendered.
+		 */
+		void scheduleEntries( float tlc);
+
+		/**
+		 * Applies the pending TransformDeltas of a range of Nodes to the Nodes.
+		 * Does nothing if no changes are pending.
+		 * @param nodes The first Node of the range.
+		 * @param deltas The delta of the first Node of the range.
+		 * @param shared The delta of all Nodes, if only uniform Transformers are pending.
+		 * @param count The number of Nodes.
+		 * @param state The kind of pending changes, will be DELTAS_NONE afterwards.
+		 */
+		static void commitDeltas( Ogre::Node** nodes, TransformDelta* deltas, TransformDelta& shared, uint count, DeltaState& state);
+
+		/**
+		 * Applies the Transformers of an Entry on a range of its Nodes.
+		 * Every Transformer processes the whole range as one batch.
+		 * The changes of accumulating Transformers are committed once per run of them.
+		 * @param entry The Entry to process.
+		 * @param begin The first Node index within the Entry.
+		 * @param end The Node index after the last one within the Entry.
+		 * @param ticks Receives the time of every Transformer of the Entry or NULL to measure nothing.
+		 */
+		void executeRange( const Entry& entry, uint begin, uint end, Clock::Ticks* ticks);
+
+		/**
+		 * Retrieves the Nodes the Transformers of an Entry change.
+		 * @param entry The Entry.
+		 * @return The first Node of the Entry.
+		 */
+		Ogre::Node** getTargets( const Entry& entry);
+
+		/**
+		 * Indicates whether an Entry may be processed in parallel in the current frame.
+		 * @param entry The Entry to check.
+		 * @return
+		 * TRUE - all Transformers are thread-safe
+		 * FALSE - the Entry has to be processed serially
+		 */
+		bool isParallel( const Entry& entry);
+
+		/**
+		 * ThreadPool task that processes a range of chunks.
+		 * @param context The ExecutionPlan.
+		 * @param begin The first chunk to process.
+		 * @param end The chunk after the last one to process.
+		 */
+		static void executeChunks( void* context, uint begin, uint end);
+
+		/**
+		 * Builds the levels of grouped mode from the compiled entries.
+		 */
+		void compileGroups();
+
+		/**
+		 * Processes all levels in grouped mode.
+		 */
+		void executeGroups();
+
+		/**
+		 * Processes one work in grouped mode, for Transformers without a kernel.
+		 * @param w The index of the work.
+		 */
+		void executeWork( uint w);
+
+		/**
+		 * Starts collecting changes in the TransformDeltas of an Entry, unless it already does.
+		 * @param e The index of the Entry.
+		 */
+		void beginDeltas( uint e);
+
+		/**
+		 * Commits the collected changes of an Entry to its Nodes, if there are any.
+		 * @param e The index of the Entry.
+		 */
+		void commitEntry( uint e);
+
+		/**
+		 * Orders works by their kernels.
+		 * @param a The first work.
+		 * @param b The second work.
+		 * @return
+		 * TRUE - a comes before b
+		 * FALSE - otherwise
+		 */
+		static bool compareKernels( const Work& a, const Work& b);
+
+	}; // END class ExecutionPlan
+
+} // END namespace Trip
+
+#endif /* __ExecutionPlan_HPP__ */
@@ -0,0 +1,89 @@
+/**
+ * Implementation file for the FadeScheduler.hpp.
+ * @author barn
+ * @version 20121122
+ */
+
+/*===========================================================================*
+ * INCLUDES (associated header files)
+ *===========================================================================*/
+#include "FadeScheduler.hpp"
+
+/*===========================================================================*
+ * INCLUDES project headers
+ *===========================================================================*/
+#include <Fadeable.hpp>
+
+/*===========================================================================*
+ * INCLUDES C/C++ standard library (and other external libraries)
+ *===========================================================================*/
+
+/*===========================================================================*
+ * DEFINES and MACROS
+ *===========================================================================*/
+
+/*===========================================================================*
+ * NAMESPACE, CONSTANTS and TYPE DECLARATIONS/IMPLEMENTATIONS
+ *===========================================================================*/
+
+namespace Trip
+{
+
+	/// The singleton instance.
+	FadeScheduler* FadeScheduler::__instance = 0;
+
+
+	/**
+	 * Registers a Fadeable that started to fade.
+	 * Does nothing if the Fadeable is already registered.
+	 * @param fadeable The fading object.
+	 */
+	void FadeScheduler::add( Fadeable* fadeable)
+	{
+		if( std::find( _fading.begin(), _fading.end(), fadeable) == _fading.end())
+		{
+			_fading.push_back( fadeable);
+		}
+	}
+
+
+	/**
+	 * Unregisters a Fadeable.
+	 * Does nothing if the Fadeable is not registered.
+	 * @param fadeable The object to remove.
+	 */
+	void FadeScheduler::remove( Fadeable* fadeable)
+	{
+		auto it = std::find( _fading.begin(), _fading.end(), fadeable);
+		if( it != _fading.end())
+		{
+			*it = _fading.back();
+			_fading.pop_back();
+		}
+	}
+
+
+	/**
+	 * Advances the fadings of all registered Fadeables.
+	 * Call this exactly once per frame. Fadeables that finished fading will be unregistered.
+	 * @param tlc The time since the last frame rendered.
+	 */
+	void FadeScheduler::step( float tlc)
+	{
+		uint i = 0;
+		while( i < _fading.size())
+		{
+			if( _fading[i]->stepFade( tlc))
+			{
+				++i;
+			}
+			else
+			{
+				// finished, the order of the others does not matter
+				_fading[i] = _fading.back();
+				_fading.pop_back();
+			}
+		}
+	}
+
+} // END namespace Trip
@@ -0,0 +1,124 @@
+/**
+ * This file contains the FadeScheduler, which advances the fadings
+ * of all fading objects once per frame.
+ * @author barn
+ * @version 20121122
+ */
+#ifndef __FadeScheduler_HPP__
+#define __FadeScheduler_HPP__
+
+/*===========================================================================*
+ * INCLUDES base definition file for DLL import/export
+ *===========================================================================*/
+
+/*===========================================================================*
+ * INCLUDES project headers
+ *===========================================================================*/
+#include "stdafx.h"
+
+/*===========================================================================*
+ * INCLUDES C/C++ standard library (and other external libraries)
+ *===========================================================================*/
+
+/*===========================================================================*
+ * DEFINES and MACROS
+ *===========================================================================*/
+
+/*===========================================================================*
+ * NAMESPACE, CONSTANTS and TYPE DECLARATIONS/IMPLEMENTATIONS
+ *===========================================================================*/
+
+namespace Trip
+{
+	class Fadeable;
+
+	/**
+	 * The singleton FadeScheduler keeps track of all Fadeables that are currently
+	 * fading in or out and advances each of them exactly once per frame.
+	 * Fadeables register themselves when a fade starts and leave the scheduler
+	 * as soon as their fade is finished or stopped.
+	 */
+	class FadeScheduler
+	{
+	private: // class vars
+
+		/// The singleton instance.
+		static FadeScheduler* __instance;
+
+	private: // instance vars
+
+		/// The Fadeables that are currently fading.
+		std::vector<Fadeable*> _fading;
+
+	protected: // constructor
+
+		/**
+		 * Protected main constructor.
+		 */
+		FadeScheduler()
+		{}
+
+	public: // destructor
+
+		/**
+		 * Destructor.
+		 */
+		~FadeScheduler()
+		{
+			__instance = 0;
+		}
+
+	public: // class methods
+
+		/**
+		 * Retrieves the singleton instance of the FadeScheduler.
+		 * Also does the lazy initialization.
+		 * @return The singleton FadeScheduler.
+		 */
+		static FadeScheduler* instance()
+		{
+			if (__instance == 0)
+				__instance = new FadeScheduler();
+
+			return __instance;
+		}
+
+	public: // methods
+
+		/**
+		 * Registers a Fadeable that started to fade.
+		 * Does nothing if the Fadeable is already registered.
+		 * @param fadeable The fading object.
+		 */
+		void add( Fadeable* fadeable);
+
+		/**
+		 * Unregisters a Fadeable.
+		 * Does nothing if the Fadeable is not registered.
+		 * @param fadeable The object to remove.
+		 */
+		void remove( Fadeable* fadeable);
+
+		/**
+		 * Advances the fadings of all registered Fadeables.
+		 * Call this exactly once per frame. Fadeables that finished fading will be unregistered.
+		 * @param tlc The time since the last frame rendered.
+		 */
+		void step( float tlc);
+
+	public: // getters & setters
+
+		/**
+		 * Retrieves the number of objects that are currently fading.
+		 * @return The number of registered Fadeables.
+		 */
+		uint getFadingCount()
+		{
+			return _fading.size();
+		}
+
+	}; // END class FadeScheduler
+
+} // END namespace Trip
+
+#endif /* __FadeScheduler_HPP__ */
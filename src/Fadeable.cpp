@@ -12,6 +12,7 @@
 /*===========================================================================*
  * INCLUDES project headers
  *===========================================================================*/
+#include <FadeScheduler.hpp>
 
 /*===========================================================================*
  * INCLUDES C/C++ standard library (and other external libraries)
@@ -28,6 +29,19 @@
 namespace Trip
 {
 
+	/**
+	 * Destructor.
+	 * Deletes the FaderFunctions and leaves the FadeScheduler.
+	 */
+	Fadeable::~Fadeable()
+	{
+		FadeScheduler::instance()->remove( this);
+
+		delete _fade_in_fun;
+		delete _fade_out_fun;
+	}
+
+
 	/**
 	 * Indicates, that the object wants to be faded in.
 	 * Also stores the necessary values. Note that fading in and fading
@@ -43,12 +57,15 @@ namespace Trip
 		if( _fade_in_fun)
 			delete _fade_in_fun;
 
-		_enabled = true;
+		setEnabled( true);
 		_fade_out = false;
 		_fade_in = true;
 		_fade_time = 0;
 		_fade_in_time = fadeTime;
 		_fade_in_fun = fadeFun;
+		_fade_value = _fade_in_fun->fun( 0);
+
+		FadeScheduler::instance()->add( this);
 	}
 
 	/**
@@ -71,6 +88,48 @@ namespace Trip
 		_fade_out = true;
 		_fade_time = fadeTime;
 		_fade_out_fun = fadeFun;
+		_fade_value = _fade_out_fun->fun( fadeTime);
+
+		FadeScheduler::instance()->add( this);
+	}
+
+
+	/**
+	 * Advances the current fading by the given time and updates the fade value.
+	 * Called once per frame by the FadeScheduler.
+	 * A finished fade-in stops fading, a finished fade-out also disables the object.
+	 * @param tlc The time since the last frame rendered.
+	 * @return
+	 * TRUE - the object is still fading
+	 * FALSE - the object is not fading anymore
+	 */
+	bool Fadeable::stepFade( float tlc)
+	{
+		if( _fade_in)
+		{
+			if( _fade_time <= _fade_in_time)
+			{
+				_fade_time += tlc;
+				_fade_value = _fade_in_fun->fun( _fade_time);
+				return true;
+			}
+
+			_fade_in = false;
+		}
+		else if( _fade_out)
+		{
+			if( _fade_time >= tlc)
+			{
+				_fade_time -= tlc;
+				_fade_value = _fade_out_fun->fun( _fade_time);
+				return true;
+			}
+
+			setEnabled( false);
+		}
+
+		_fade_value = 1;
+		return false;
 	}
 
 
@@ -91,6 +150,8 @@ namespace Trip
 				_fade_in = false;
 			else if(_fade_out)
 				_fade_out = false;
+
+			_fade_value = 1;
 		}
 	}
 
@@ -37,6 +37,12 @@ namespace Trip
 	/**
 	 * The interface Fadeable provides methods and instance vars that
 	 * can be used by several other classes on purpose to fade something in/out.
+	 *
+	 * Fadings are advanced once per frame by the FadeScheduler, which stores the
+	 * current value of the fade Function in the fade value. Users of a Fadeable
+	 * only read that value, no matter how often per frame they need it.
+	 *
+	 * @see FadeScheduler
 	 */
 	class Fadeable : public Enableable
 	{
@@ -55,6 +61,9 @@ namespace Trip
 		/// The amount of time to fade in. Time in seconds.
 		float _fade_in_time;
 
+		/// The value of the current fade Function, or 1 if not fading. Updated once per frame.
+		float _fade_value;
+
 	public: // constructor & destructor
 
 		/**
@@ -66,18 +75,32 @@ namespace Trip
 			_fade_in(false),
 			_fade_out(false),
 			_fade_in_fun(0),
-			_fade_out_fun(0)
+			_fade_out_fun(0),
+			_fade_time(0),
+			_fade_in_time(0),
+			_fade_value(1)
+		{}
+
+		/**
+		 * Copy constructor.
+		 * Copies the enabled state, but neither the fade Functions nor a running fade.
+		 */
+		Fadeable( const Fadeable& other)
+			: Enableable( other),
+			_fade_in(false),
+			_fade_out(false),
+			_fade_in_fun(0),
+			_fade_out_fun(0),
+			_fade_time(0),
+			_fade_in_time(0),
+			_fade_value(1)
 		{}
 
 		/**
 		 * Destructor.
-		 * Deletes the FaderFunctions.
+		 * Deletes the FaderFunctions and leaves the FadeScheduler.
 		 */
-		~Fadeable()
-		{
-			delete _fade_in_fun;
-			delete _fade_out_fun;
-		}
+		~Fadeable();
 
 	public: // methods
 
@@ -102,6 +125,17 @@ namespace Trip
 		 */
 		void fadeOut( float fadeTime, Trip::Function* fadeFun);
 
+		/**
+		 * Advances the current fading by the given time and updates the fade value.
+		 * Called once per frame by the FadeScheduler.
+		 * A finished fade-in stops fading, a finished fade-out also disables the object.
+		 * @param tlc The time since the last frame rendered.
+		 * @return
+		 * TRUE - the object is still fading
+		 * FALSE - the object is not fading anymore
+		 */
+		bool stepFade( float tlc);
+
 
 	public: // getters & setters
 
@@ -113,6 +147,16 @@ namespace Trip
 		 */
 		void setEnabled( bool enabled);
 
+		/**
+		 * Retrieves the current value of the fading, which is the value of
+		 * the fade Function that was computed by the last stepFade().
+		 * @return The current fade value or 1, if the object is not fading.
+		 */
+		float getFadeValue()
+		{
+			return _fade_value;
+		}
+
 		/**
 		 * Retrieves the current set fade in function.
 		 * @return The Function for fading in.
@@ -0,0 +1,135 @@
+/**
+ * Implementation file for the FramePacer.hpp.
+ * @author barn
+ * @version 20121205
+ */
+
+/*===========================================================================*
+ * INCLUDES (associated header files)
+ *===========================================================================*/
+#include "FramePacer.hpp"
+
+/*===========================================================================*
+ * INCLUDES project headers
+ *===========================================================================*/
+
+/*===========================================================================*
+ * INCLUDES C/C++ standard library (and other external libraries)
+ *===========================================================================*/
+#if OGRE_PLATFORM == OGRE_PLATFORM_WIN32
+#	include <mmsystem.h>
+#endif
+
+/*===========================================================================*
+ * DEFINES and MACROS
+ *===========================================================================*/
+
+/*===========================================================================*
+ * NAMESPACE, CONSTANTS and TYPE DECLARATIONS/IMPLEMENTATIONS
+ *===========================================================================*/
+
+namespace Trip
+{
+
+	/**
+	 * Waits for the start of the next frame, or a while if the last loop did not render.
+	 * @param rendered Indicates whether the loop has rendered a frame.
+	 */
+	void FramePacer::wait( bool rendered)
+	{
+		if( !rendered)
+		{
+			setFineTimer( false);
+			_deadline = 0;
+			boost::this_thread::sleep( boost::posix_time::milliseconds( TRIP_PACER_IDLE_SLEEP));
+			return;
+		}
+
+		if( _target_rate <= 0)
+		{
+			setFineTimer( false);
+			_deadline = 0;
+			return;
+		}
+
+		setFineTimer( true);
+
+		const Clock::Ticks period = (Clock::Ticks) (Clock::getFrequency() / _target_rate);
+		const Clock::Ticks now = Clock::now();
+
+		// start over after a pause or a frame far too long, instead of rushing to catch up
+		if( _deadline == 0 || now - _deadline > period)
+		{
+			_deadline = now;
+		}
+		else
+		{
+			sleepUntil( _deadline);
+		}
+		_deadline += period;
+	}
+
+
+	/**
+	 * Indicates whether there was no activity for longer than the idle delay.
+	 * @return
+	 * TRUE - the main loop shall neither simulate nor render
+	 * FALSE - the main loop shall go on
+	 */
+	bool FramePacer::isIdle()
+	{
+		if( _idle_delay <= 0)
+			return false;
+
+		return Clock::now() - _last_activity > (Clock::Ticks) (_idle_delay * Clock::getFrequency());
+	}
+
+
+	/**
+	 * Sleeps and yields until the given time.
+	 * The sleep of the system may take longer than asked for,
+	 * so the last TRIP_PACER_SPIN_MARGIN milliseconds are yielded away.
+	 * @param deadline The time to return at.
+	 */
+	void FramePacer::sleepUntil( Clock::Ticks deadline)
+	{
+		const Clock::Ticks frequency = Clock::getFrequency();
+		const Clock::Ticks margin = frequency * TRIP_PACER_SPIN_MARGIN / 1000;
+
+		const Clock::Ticks remaining = deadline - Clock::now();
+		if( remaining > margin)
+		{
+			const long us = (long) ((remaining - margin) * 1000000 / frequency);
+			boost::this_thread::sleep( boost::posix_time::microseconds( us));
+		}
+
+		while( Clock::now() < deadline)
+		{
+			boost::this_thread::yield();
+		}
+	}
+
+
+	/**
+	 * Asks the system for a timer resolution of 1 millisecond or releases it.
+	 * The fine resolution costs power, so it is held only while pacing.
+	 * Does nothing on systems other than Windows.
+	 * @param fine
+	 * TRUE - sleep with a resolution of 1 millisecond
+	 * FALSE - the default resolution of the system
+	 */
+	void FramePacer::setFineTimer( bool fine)
+	{
+		if( fine == _fine_timer)
+			return;
+
+#if OGRE_PLATFORM == OGRE_PLATFORM_WIN32
+		if( fine)
+			timeBeginPeriod( 1);
+		else
+			timeEndPeriod( 1);
+#endif
+		_fine_timer = fine;
+	}
+
+} // END namespace Trip
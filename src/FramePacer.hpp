@@ -0,0 +1,192 @@
+/**
+ * This file contains the FramePacer, which paces the main loop to a target frame rate
+ * and lets it sleep while nothing happens.
+ * @author barn
+ * @version 20121205
+ */
+#ifndef __FramePacer_HPP__
+#define __FramePacer_HPP__
+
+/*===========================================================================*
+ * INCLUDES base definition file for DLL import/export
+ *===========================================================================*/
+
+/*===========================================================================*
+ * INCLUDES project headers
+ *===========================================================================*/
+#include "stdafx.h"
+#include <util/Clock.hpp>
+
+/*===========================================================================*
+ * INCLUDES C/C++ standard library (and other external libraries)
+ *===========================================================================*/
+
+/*===========================================================================*
+ * DEFINES and MACROS
+ *===========================================================================*/
+
+/// The time in milliseconds before a frame deadline, from which on the pacer yields instead of sleeping.
+#define TRIP_PACER_SPIN_MARGIN 2
+
+/// The time in milliseconds the pacer sleeps per loop while idle or while the window is hidden.
+#define TRIP_PACER_IDLE_SLEEP 50
+
+/*===========================================================================*
+ * NAMESPACE, CONSTANTS and TYPE DECLARATIONS/IMPLEMENTATIONS
+ *===========================================================================*/
+
+namespace Trip
+{
+
+	/**
+	 * The FramePacer keeps the main loop from spinning. Call wait() at the end of every loop.
+	 *
+	 * With a target rate set, wait() returns at the start of the next frame: it sleeps until
+	 * shortly before and yields for the rest, so the frames start on time although the sleep
+	 * of the system is coarse. A frame that took too long is not caught up.
+	 *
+	 * With an idle delay set, the pacer becomes idle when nobody called notifyActivity()
+	 * for that long. The main loop shall then neither simulate nor render, wait() only sleeps
+	 * for TRIP_PACER_IDLE_SLEEP milliseconds, so new input is noticed quickly.
+	 * Registered as a WindowEventListener, the pacer wakes up when the window is resized or focused.
+	 */
+	class FramePacer : public Ogre::WindowEventListener
+	{
+	private: // vars
+
+		/// The frames per second to pace to or 0 to return from wait() at once.
+		float _target_rate;
+
+		/// The start of the next frame or 0 if the last loop did not render.
+		Clock::Ticks _deadline;
+
+		/// The time in seconds without activity after which the pacer becomes idle, 0 never.
+		float _idle_delay;
+
+		/// The time of the last activity.
+		Clock::Ticks _last_activity;
+
+		/// Indicates whether the system timer has been set to a fine resolution for pacing.
+		bool _fine_timer;
+
+	public: // constructor & destructor
+
+		/**
+		 * Main constructor.
+		 * Neither paces nor becomes idle until told so.
+		 */
+		FramePacer()
+			: _target_rate(0),
+			_deadline(0),
+			_idle_delay(0),
+			_last_activity( Clock::now()),
+			_fine_timer(false)
+		{}
+
+		/**
+		 * Destructor.
+		 * Restores the resolution of the system timer.
+		 */
+		~FramePacer()
+		{
+			setFineTimer( false);
+		}
+
+	public: // methods
+
+		/**
+		 * Waits for the start of the next frame, or a while if the last loop did not render.
+		 * @param rendered Indicates whether the loop has rendered a frame.
+		 */
+		void wait( bool rendered);
+
+		/**
+		 * Tells the pacer that something happened, e.g. a command arrived or the scene moves.
+		 * Keeps it from becoming idle or wakes it up.
+		 */
+		void notifyActivity()
+		{
+			_last_activity = Clock::now();
+		}
+
+		/**
+		 * Indicates whether there was no activity for longer than the idle delay.
+		 * @return
+		 * TRUE - the main loop shall neither simulate nor render
+		 * FALSE - the main loop shall go on
+		 */
+		bool isIdle();
+
+		/// Method derived by Ogre::WindowEventListener. Wakes the pacer up.
+		void windowResized( Ogre::RenderWindow* rw)
+		{
+			notifyActivity();
+		}
+
+		/// Method derived by Ogre::WindowEventListener. Wakes the pacer up.
+		void windowFocusChange( Ogre::RenderWindow* rw)
+		{
+			notifyActivity();
+		}
+
+	public: // getters & setters
+
+		/**
+		 * Sets the frame rate to pace to.
+		 * @param rate The frames per second or 0 to render as fast as possible.
+		 */
+		void setTargetRate( float rate)
+		{
+			_target_rate = rate > 0 ? rate : 0;
+		}
+
+		/**
+		 * Retrieves the frame rate the pacer paces to.
+		 * @return The frames per second or 0 if it does not pace.
+		 */
+		float getTargetRate()
+		{
+			return _target_rate;
+		}
+
+		/**
+		 * Sets the time without activity after which the pacer becomes idle.
+		 * @param seconds The delay or 0 to never become idle.
+		 */
+		void setIdleDelay( float seconds)
+		{
+			_idle_delay = seconds > 0 ? seconds : 0;
+		}
+
+		/**
+		 * Retrieves the time without activity after which the pacer becomes idle.
+		 * @return The delay in seconds or 0 if it never becomes idle.
+		 */
+		float getIdleDelay()
+		{
+			return _idle_delay;
+		}
+
+	private: // helpers
+
+		/**
+		 * Sleeps and yields until the given time.
+		 * @param deadline The time to return at.
+		 */
+		void sleepUntil( Clock::Ticks deadline);
+
+		/**
+		 * Asks the system for a timer resolution of 1 millisecond or releases it.
+		 * The fine resolution costs power, so it is held only while pacing.
+		 * Does nothing on systems other than Windows.
+		 * @param fine
+		 * TRUE - sleep with a resolution of 1 millisecond
+		 * FALSE - the default resolution of the system
+		 */
+		void setFineTimer( bool fine);
+
+	}; // END class FramePacer
+
+} // END namespace Trip
+
+#endif /* __FramePacer_HPP__ */
@@ -0,0 +1,234 @@
+/**
+ * Implementation file for the FrameProfiler.hpp.
+ * @author barn
+ * @version 20121125
+ */
+
+/*===========================================================================*
+ * INCLUDES (associated header files)
+ *===========================================================================*/
+#include "FrameProfiler.hpp"
+
+/*===========================================================================*
+ * INCLUDES project headers
+ *===========================================================================*/
+#include <ExecutionPlan.hpp>
+#include <clusters/Cluster.hpp>
+#include <transformers/Transformer.hpp>
+
+/*===========================================================================*
+ * INCLUDES C/C++ standard library (and other external libraries)
+ *===========================================================================*/
+#include <iomanip>
+
+/*===========================================================================*
+ * DEFINES and MACROS
+ *===========================================================================*/
+
+/// The weight of the current frame in the rolling averages.
+#define TRIP_PROFILER_SMOOTHING 0.05
+
+/*===========================================================================*
+ * NAMESPACE, CONSTANTS and TYPE DECLARATIONS/IMPLEMENTATIONS
+ *===========================================================================*/
+
+namespace Trip
+{
+
+	/// The singleton instance.
+	FrameProfiler* FrameProfiler::__instance = 0;
+
+
+	/**
+	 * Orders Stats by their average time, the most expensive first.
+	 */
+	static bool moreExpensive( const FrameProfiler::Stats* a, const FrameProfiler::Stats* b)
+	{
+		return a->average_ms > b->average_ms;
+	}
+
+
+	/**
+	 * Records the measures of a frame.
+	 * @param plan The plan that was executed with profiling enabled.
+	 * @param frameTicks The time the whole execution of the plan took.
+	 */
+	void FrameProfiler::record( ExecutionPlan& plan, Clock::Ticks frameTicks)
+	{
+		++_frame;
+		const double frame_ms = Clock::toMilliseconds( frameTicks);
+		_frame_ms = _frame == 1 ? frame_ms : _frame_ms + (frame_ms - _frame_ms) * TRIP_PROFILER_SMOOTHING;
+
+		const std::vector<ExecutionPlan::Entry>& entries = plan.getEntries();
+		const std::vector<Transformer*>& transformers = plan.getTransformers();
+		const std::vector<Clock::Ticks>& ticks = plan.getTransformerTicks();
+		const std::vector<uint>& batches = plan.getBatches();
+		if( ticks.size() != transformers.size() || batches.size() != entries.size())
+			return;
+
+		// the Transformers and the own time of every Cluster
+		_subtree_ticks.assign( entries.size(), 0);
+		_subtree_nodes.assign( entries.size(), 0);
+		for( uint e = 0; e < entries.size(); ++e)
+		{
+			const ExecutionPlan::Entry& entry = entries[e];
+			_subtree_nodes[e] = entry.cluster->getNodes().size();
+
+			for( uint t = entry.first_transformer; t < entry.first_transformer + entry.transformer_count; ++t)
+			{
+				_subtree_ticks[e] += ticks[t];
+
+				Stats& stats = _transformers[transformers[t]];
+				if( stats.frame == 0)
+				{
+					stats.name = transformers[t]->getName();
+					stats.owner = entry.cluster->getName();
+				}
+				stats.nodes = entry.node_count;
+				stats.calls = batches[e];
+				update( stats, Clock::toMilliseconds( ticks[t]));
+			}
+		}
+
+		// children come after their parents, so add them up backwards
+		for( uint e = entries.size(); e-- > 0;)
+		{
+			const uint parent = entries[e].parent;
+			if( parent != e)
+			{
+				_subtree_ticks[parent] += _subtree_ticks[e];
+				_subtree_nodes[parent] += _subtree_nodes[e];
+			}
+
+			Stats& stats = _clusters[entries[e].cluster];
+			if( stats.frame == 0)
+			{
+				stats.name = entries[e].cluster->getName();
+			}
+			stats.nodes = _subtree_nodes[e];
+			stats.calls = entries[e].transformer_count;
+			update( stats, Clock::toMilliseconds( _subtree_ticks[e]));
+		}
+
+		// forget everything that is not part of the plan anymore
+		for( auto it = _transformers.begin(); it != _transformers.end();)
+		{
+			if( it->second.frame != _frame)
+				_transformers.erase( it++);
+			else
+				++it;
+		}
+		for( auto it = _clusters.begin(); it != _clusters.end();)
+		{
+			if( it->second.frame != _frame)
+				_clusters.erase( it++);
+			else
+				++it;
+		}
+	}
+
+
+	/**
+	 * Prints the most expensive Transformers and Cluster subtrees onto the console.
+	 * @param count The maximum number of Transformers and Clusters to print.
+	 */
+	void FrameProfiler::print( uint count)
+	{
+		if( !_enabled)
+		{
+			std::cout << "Profiling is disabled." << std::endl;
+			return;
+		}
+
+		std::cout << std::fixed << std::setprecision(3)
+			<< "frames: " << _frame << ", engine: " << _frame_ms << " ms/frame (rolling average)" << std::endl;
+
+		// Transformers
+		std::vector<const Stats*> sorted;
+		for( auto it = _transformers.begin(); it != _transformers.end(); ++it)
+		{
+			sorted.push_back( &it->second);
+		}
+		std::sort( sorted.begin(), sorted.end(), moreExpensive);
+
+		std::cout << std::endl << "Transformers:" << std::endl
+			<< std::setw(10) << "avg ms" << std::setw(10) << "max ms" << std::setw(8) << "nodes" << std::setw(8) << "calls"
+			<< "  name (cluster)" << std::endl;
+		for( uint i = 0; i < sorted.size() && i < count; ++i)
+		{
+			std::cout << std::setw(10) << sorted[i]->average_ms << std::setw(10) << sorted[i]->max_ms
+				<< std::setw(8) << sorted[i]->nodes << std::setw(8) << sorted[i]->calls
+				<< "  " << sorted[i]->name << " (" << sorted[i]->owner << ")" << std::endl;
+		}
+
+		// Clusters
+		sorted.clear();
+		for( auto it = _clusters.begin(); it != _clusters.end(); ++it)
+		{
+			sorted.push_back( &it->second);
+		}
+		std::sort( sorted.begin(), sorted.end(), moreExpensive);
+
+		std::cout << std::endl << "Cluster subtrees:" << std::endl
+			<< std::setw(10) << "avg ms" << std::setw(10) << "max ms" << std::setw(8) << "nodes" << std::setw(8) << "tfs"
+			<< "  name" << std::endl;
+		for( uint i = 0; i < sorted.size() && i < count; ++i)
+		{
+			std::cout << std::setw(10) << sorted[i]->average_ms << std::setw(10) << sorted[i]->max_ms
+				<< std::setw(8) << sorted[i]->nodes << std::setw(8) << sorted[i]->calls
+				<< "  " << sorted[i]->name << std::endl;
+		}
+	}
+
+
+	/**
+	 * Forgets all measures.
+	 */
+	void FrameProfiler::reset()
+	{
+		_frame = 0;
+		_frame_ms = 0;
+		_transformers.clear();
+		_clusters.clear();
+	}
+
+
+	/**
+	 * Sets whether the Engine shall profile its frames.
+	 * Disabling also forgets all measures.
+	 * @param enabled
+	 * TRUE - profile every frame
+	 * FALSE - do not profile
+	 */
+	void FrameProfiler::setEnabled( bool enabled)
+	{
+		_enabled = enabled;
+
+		if( !enabled)
+		{
+			reset();
+		}
+	}
+
+
+	/**
+	 * Updates the rolling average of the given Stats.
+	 * @param stats The Stats to update.
+	 * @param ms The time of the current frame, in milliseconds.
+	 */
+	void FrameProfiler::update( Stats& stats, double ms)
+	{
+		if( stats.frame == 0)
+		{
+			stats.average_ms = ms;
+			stats.max_ms = ms;
+		}
+		else
+		{
+			stats.average_ms += (ms - stats.average_ms) * TRIP_PROFILER_SMOOTHING;
+			stats.max_ms = std::max( stats.max_ms, ms);
+		}
+		stats.frame = _frame;
+	}
+
+} // END namespace Trip
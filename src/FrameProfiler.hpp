@@ -0,0 +1,206 @@
+/**
+ * This file contains the FrameProfiler, which keeps rolling averages of the time
+ * the Clusters and Transformers need per frame.
+ * @author barn
+ * @version 20121210
+ */
+#ifndef __FrameProfiler_HPP__
+#define __FrameProfiler_HPP__
+
+/*===========================================================================*
+ * INCLUDES base definition file for DLL import/export
+ *===========================================================================*/
+
+/*===========================================================================*
+ * INCLUDES project headers
+ *===========================================================================*/
+#include "stdafx.h"
+#include <util/Clock.hpp>
+
+/*===========================================================================*
+ * INCLUDES C/C++ standard library (and other external libraries)
+ *===========================================================================*/
+
+/*===========================================================================*
+ * DEFINES and MACROS
+ *===========================================================================*/
+
+/*===========================================================================*
+ * NAMESPACE, CONSTANTS and TYPE DECLARATIONS/IMPLEMENTATIONS
+ *===========================================================================*/
+
+namespace Trip
+{
+	class Cluster;
+	class Transformer;
+	class ExecutionPlan;
+
+	/**
+	 * The singleton FrameProfiler collects the measures of the ExecutionPlan after every frame.
+	 * It keeps rolling averages of the time per Transformer instance and per Cluster subtree,
+	 * together with the number of Nodes and batches, and prints the most expensive ones.
+	 *
+	 * The subtree time of a Cluster is the time of its own Transformers and of the
+	 * Transformers of all its descendants. Times of parallel processed Clusters are summed
+	 * up over all threads.
+	 *
+	 * Objects that are not part of the plan anymore are forgotten.
+	 */
+	class FrameProfiler
+	{
+	public: // nested types
+
+		/// The measures of a Transformer or a Cluster subtree.
+		struct Stats
+		{
+			/// The name of the measured object.
+			String name;
+
+			/// The name of the Cluster the Transformer belongs to, empty for Clusters.
+			String owner;
+
+			/// The rolling average of the time per frame, in milliseconds.
+			double average_ms;
+
+			/// The maximum time of a single frame, in milliseconds.
+			double max_ms;
+
+			/// The number of Nodes processed in the last frame.
+			uint nodes;
+
+			/// The number of calls in the last frame.
+			uint calls;
+
+			/// The number of the last frame the object was part of.
+			uint frame;
+
+			Stats()
+				: average_ms(0),
+				max_ms(0),
+				nodes(0),
+				calls(0),
+				frame(0)
+			{}
+		};
+
+	private: // class vars
+
+		/// The singleton instance.
+		static FrameProfiler* __instance;
+
+	private: // vars
+
+		/// Indicates whether the Engine shall profile its frames.
+		bool _enabled;
+
+		/// The number of recorded frames.
+		uint _frame;
+
+		/// The rolling average of the time the plan needed per frame, in milliseconds.
+		double _frame_ms;
+
+		/// The measures of all Transformers of the plan.
+		std::map<Transformer*, Stats> _transformers;
+
+		/// The measures of all Cluster subtrees of the plan.
+		std::map<Cluster*, Stats> _clusters;
+
+		/// The subtree time of every Entry of the plan in the current frame.
+		std::vector<Clock::Ticks> _subtree_ticks;
+
+		/// The number of subtree Nodes of every Entry of the plan in the current frame.
+		std::vector<uint> _subtree_nodes;
+
+	protected: // constructor
+
+		/**
+		 * Protected main constructor.
+		 * Profiling is disabled by default, unprofiled frames pay nothing for it.
+		 */
+		FrameProfiler()
+			: _enabled(false),
+			_frame(0),
+			_frame_ms(0)
+		{}
+
+	public: // destructor
+
+		/**
+		 * Destructor.
+		 */
+		~FrameProfiler()
+		{
+			__instance = 0;
+		}
+
+	public: // class methods
+
+		/**
+		 * Retrieves the singleton instance of the FrameProfiler.
+		 * Also does the lazy initialization.
+		 * @return The singleton FrameProfiler.
+		 */
+		static FrameProfiler* instance()
+		{
+			if (__instance == 0)
+				__instance = new FrameProfiler();
+
+			return __instance;
+		}
+
+	public: // methods
+
+		/**
+		 * Records the measures of a frame.
+		 * @param plan The plan that was executed with profiling enabled.
+		 * @param frameTicks The time the whole execution of the plan took.
+		 */
+		void record( ExecutionPlan& plan, Clock::Ticks frameTicks);
+
+		/**
+		 * Prints the most expensive Transformers and Cluster subtrees onto the console.
+		 * @param count The maximum number of Transformers and Clusters to print.
+		 */
+		void print( uint count);
+
+		/**
+		 * Forgets all measures.
+		 */
+		void reset();
+
+	public: // getters & setters
+
+		/**
+		 * Sets whether the Engine shall profile its frames.
+		 * Disabling also forgets all measures.
+		 * @param enabled
+		 * TRUE - profile every frame
+		 * FALSE - do not profile
+		 */
+		void setEnabled( bool enabled);
+
+		/**
+		 * Indicates whether the Engine shall profile its frames.
+		 * @return
+		 * TRUE - profiling is enabled
+		 * FALSE - profiling is disabled
+		 */
+		bool isEnabled()
+		{
+			return _enabled;
+		}
+
+	private: // helpers
+
+		/**
+		 * Updates the rolling average of the given Stats.
+		 * @param stats The Stats to update.
+		 * @param ms The time of the current frame, in milliseconds.
+		 */
+		void update( Stats& stats, double ms);
+
+	}; // END class FrameProfiler
+
+} // END namespace Trip
+
+#endif /* __FrameProfiler_HPP__ */
@@ -0,0 +1,159 @@
+/**
+ * Implementation file for the FrameStatistics.hpp.
+ * @author barn
+ * @version 20121126
+ */
+
+/*===========================================================================*
+ * INCLUDES (associated header files)
+ *===========================================================================*/
+#include "FrameStatistics.hpp"
+
+/*===========================================================================*
+ * INCLUDES project headers
+ *===========================================================================*/
+
+/*===========================================================================*
+ * INCLUDES C/C++ standard library (and other external libraries)
+ *===========================================================================*/
+#include <fstream>
+#include <iomanip>
+
+/*===========================================================================*
+ * DEFINES and MACROS
+ *===========================================================================*/
+
+/// The frame time deadline at 60Hz, in microseconds.
+#define TRIP_DEADLINE_60HZ_US 16667
+
+/// The frame time deadline at 30Hz, in microseconds.
+#define TRIP_DEADLINE_30HZ_US 33333
+
+/*===========================================================================*
+ * NAMESPACE, CONSTANTS and TYPE DECLARATIONS/IMPLEMENTATIONS
+ *===========================================================================*/
+
+namespace Trip
+{
+
+	/// The singleton instance.
+	FrameStatistics* FrameStatistics::__instance = 0;
+
+
+	/**
+	 * Protected main constructor.
+	 */
+	FrameStatistics::FrameStatistics()
+	{
+		for( uint p = 0; p < PHASE_COUNT; ++p)
+		{
+			_last[p] = 0;
+		}
+	}
+
+
+	/**
+	 * Retrieves the name of a phase.
+	 * @param phase The phase.
+	 * @return The name of the phase.
+	 */
+	const char* FrameStatistics::getPhaseName( Phase phase)
+	{
+		switch( phase)
+		{
+		case PHASE_FRAME:		return "frame";
+		case PHASE_SIMULATION:	return "simulation";
+		case PHASE_INTERPRETER:	return "interpreter";
+		case PHASE_RENDER:		return "render";
+		default:				return "unknown";
+		}
+	}
+
+
+	/**
+	 * Prints the percentiles and the missed deadlines of all phases onto the console.
+	 */
+	void FrameStatistics::print()
+	{
+		std::cout << std::fixed << std::setprecision(2)
+			<< std::setw(12) << "phase" << std::setw(9) << "count" << std::setw(9) << "mean"
+			<< std::setw(9) << "p50" << std::setw(9) << "p95" << std::setw(9) << "p99" << std::setw(9) << "max"
+			<< std::setw(9) << ">16.7" << std::setw(9) << ">33.3" << "  (ms)" << std::endl;
+
+		for( uint p = 0; p < PHASE_COUNT; ++p)
+		{
+			Histogram& h = _histograms[p];
+			std::cout << std::setw(12) << getPhaseName( (Phase) p)
+				<< std::setw(9) << h.getCount()
+				<< std::setw(9) << h.getMean() / 1000
+				<< std::setw(9) << h.getPercentile( 0.5) / 1000.0
+				<< std::setw(9) << h.getPercentile( 0.95) / 1000.0
+				<< std::setw(9) << h.getPercentile( 0.99) / 1000.0
+				<< std::setw(9) << h.getMax() / 1000.0
+				<< std::setw(9) << h.countAbove( TRIP_DEADLINE_60HZ_US)
+				<< std::setw(9) << h.countAbove( TRIP_DEADLINE_30HZ_US)
+				<< std::endl;
+		}
+	}
+
+
+	/**
+	 * Writes the Histograms of all phases into a CSV file.
+	 * Every row holds the bucket start in milliseconds and the counters of all phases.
+	 * Empty rows are left out.
+	 * @param file The path of the file to write.
+	 * @return
+	 * TRUE - the file was written
+	 * FALSE - the file could not be opened
+	 */
+	bool FrameStatistics::writeCsv( const String& file)
+	{
+		std::ofstream out( file.c_str());
+		if( !out)
+		{
+			Trip::log( "Cannot write the frame statistics to " + file + ".", MSG_ERROR);
+			return false;
+		}
+
+		out << "bucket_ms";
+		for( uint p = 0; p < PHASE_COUNT; ++p)
+		{
+			out << "," << getPhaseName( (Phase) p);
+		}
+		out << std::endl;
+
+		out << std::fixed << std::setprecision(3);
+		for( uint b = 0; b <= TRIP_HISTOGRAM_BUCKETS; ++b)
+		{
+			bool empty = true;
+			for( uint p = 0; p < PHASE_COUNT; ++p)
+			{
+				empty &= _histograms[p].getBucket( b) == 0;
+			}
+			if( empty)
+				continue;
+
+			out << b * TRIP_HISTOGRAM_BUCKET_US / 1000.0;
+			for( uint p = 0; p < PHASE_COUNT; ++p)
+			{
+				out << "," << _histograms[p].getBucket( b);
+			}
+			out << std::endl;
+		}
+		return true;
+	}
+
+
+	/**
+	 * Forgets all recorded time spans.
+	 */
+	void FrameStatistics::reset()
+	{
+		for( uint p = 0; p < PHASE_COUNT; ++p)
+		{
+			_histograms[p].reset();
+			_last[p] = 0;
+		}
+	}
+
+} // END namespace Trip
@@ -0,0 +1,180 @@
+/**
+ * This file contains the FrameStatistics, which keep histograms of the
+ * frame times and of the phases of a frame.
+ * @author barn
+ * @version 20121126
+ */
+#ifndef __FrameStatistics_HPP__
+#define __FrameStatistics_HPP__
+
+/*===========================================================================*
+ * INCLUDES base definition file for DLL import/export
+ *===========================================================================*/
+
+/*===========================================================================*
+ * INCLUDES project headers
+ *===========================================================================*/
+#include "stdafx.h"
+#include <util/Clock.hpp>
+#include <util/Histogram.hpp>
+
+/*===========================================================================*
+ * INCLUDES C/C++ standard library (and other external libraries)
+ *===========================================================================*/
+
+/*===========================================================================*
+ * DEFINES and MACROS
+ *===========================================================================*/
+
+/*===========================================================================*
+ * NAMESPACE, CONSTANTS and TYPE DECLARATIONS/IMPLEMENTATIONS
+ *===========================================================================*/
+
+namespace Trip
+{
+
+	/**
+	 * The singleton FrameStatistics keep a Histogram of the whole frame time and one for
+	 * every phase of a frame: the simulation by the Engine, the handling of interpreter commands
+	 * and the rendering by Ogre. They report percentiles and the number of frames that missed
+	 * the 60Hz and 30Hz deadlines, and write the histograms into a CSV file.
+	 *
+	 * Recording only increments counters and allocates nothing. There are no locks,
+	 * so record only from the main thread.
+	 */
+	class FrameStatistics
+	{
+	public: // nested types
+
+		/// The measured phases of a frame.
+		enum Phase
+		{
+			/// The whole frame, from the start of one frame to the start of the next one.
+			PHASE_FRAME = 0,
+
+			/// The processing of the Engine.
+			PHASE_SIMULATION,
+
+			/// The handling of interpreter commands.
+			PHASE_INTERPRETER,
+
+			/// The rendering by Ogre, without the simulation.
+			PHASE_RENDER,
+
+			/// The number of phases.
+			PHASE_COUNT
+		};
+
+	private: // class vars
+
+		/// The singleton instance.
+		static FrameStatistics* __instance;
+
+	private: // vars
+
+		/// The Histograms of the phases.
+		Histogram _histograms[PHASE_COUNT];
+
+		/// The last recorded time span of every phase.
+		Clock::Ticks _last[PHASE_COUNT];
+
+	protected: // constructor
+
+		/**
+		 * Protected main constructor.
+		 */
+		FrameStatistics();
+
+	public: // destructor
+
+		/**
+		 * Destructor.
+		 */
+		~FrameStatistics()
+		{
+			__instance = 0;
+		}
+
+	public: // class methods
+
+		/**
+		 * Retrieves the singleton instance of the FrameStatistics.
+		 * Also does the lazy initialization.
+		 * @return The singleton FrameStatistics.
+		 */
+		static FrameStatistics* instance()
+		{
+			if (__instance == 0)
+				__instance = new FrameStatistics();
+
+			return __instance;
+		}
+
+		/**
+		 * Retrieves the name of a phase.
+		 * @param phase The phase.
+		 * @return The name of the phase.
+		 */
+		static const char* getPhaseName( Phase phase);
+
+	public: // methods
+
+		/**
+		 * Records the time span of a phase.
+		 * @param phase The measured phase.
+		 * @param ticks The time span, measured with the Clock.
+		 */
+		void record( Phase phase, Clock::Ticks ticks)
+		{
+			_last[phase] = ticks;
+			_histograms[phase].record( (uint) (Clock::toNanoseconds( ticks) / 1000));
+		}
+
+		/**
+		 * Prints the percentiles and the missed deadlines of all phases onto the console.
+		 */
+		void print();
+
+		/**
+		 * Writes the Histograms of all phases into a CSV file.
+		 * Every row holds the bucket start in milliseconds and the counters of all phases.
+		 * Empty rows are left out.
+		 * @param file The path of the file to write.
+		 * @return
+		 * TRUE - the file was written
+		 * FALSE - the file could not be opened
+		 */
+		bool writeCsv( const String& file);
+
+		/**
+		 * Forgets all recorded time spans.
+		 */
+		void reset();
+
+	public: // getters & setters
+
+		/**
+		 * Retrieves the Histogram of a phase.
+		 * @param phase The phase.
+		 * @return The Histogram of the phase.
+		 */
+		Histogram& getHistogram( Phase phase)
+		{
+			return _histograms[phase];
+		}
+
+		/**
+		 * Retrieves the last recorded time span of a phase.
+		 * @param phase The phase.
+		 * @return The time span, measured with the Clock.
+		 */
+		Clock::Ticks getLast( Phase phase)
+		{
+			return _last[phase];
+		}
+
+	}; // END class FrameStatistics
+
+} // END namespace Trip
+
+#endif /* __FrameStatistics_HPP__ */
@@ -0,0 +1,278 @@
+/**
+ * Implementation file for the LodPolicy.hpp.
+ * @author barn
+ * @version 20121210
+ */
+
+/*===========================================================================*
+ * INCLUDES (associated header files)
+ *===========================================================================*/
+#include "LodPolicy.hpp"
+
+/*===========================================================================*
+ * INCLUDES project headers
+ *===========================================================================*/
+#include <clusters/Cluster.hpp>
+
+/*===========================================================================*
+ * INCLUDES C/C++ standard library (and other external libraries)
+ *===========================================================================*/
+#include <algorithm>
+#include <iomanip>
+
+/*===========================================================================*
+ * DEFINES and MACROS
+ *===========================================================================*/
+
+/*===========================================================================*
+ * NAMESPACE, CONSTANTS and TYPE DECLARATIONS/IMPLEMENTATIONS
+ *===========================================================================*/
+
+namespace Trip
+{
+
+	/// The singleton instance.
+	LodPolicy* LodPolicy::__instance = 0;
+
+
+	/**
+	 * Protected main constructor.
+	 * The policy is disabled by default.
+	 */
+	LodPolicy::LodPolicy()
+		: _enabled(false),
+		_distance(TRIP_LOD_DISTANCE),
+		_viewpoint( Ogre::Vector3::ZERO),
+		_has_viewpoint(false),
+		_culling(false),
+		_camera(0),
+		_frame(0),
+		_deferred_count(0),
+		_offscreen_count(0),
+		_budget(0),
+		_last_time(0),
+		_degradation(0),
+		_calm_frames(0)
+	{
+		for( uint l = 0; l < TRIP_LOD_LEVELS; ++l)
+		{
+			_cluster_counts[l] = 0;
+		}
+	}
+
+
+	/**
+	 * Starts a new frame. Call it once before the plan is executed.
+	 * @param camera The active camera or NULL if there is none.
+	 */
+	void LodPolicy::update( Ogre::Camera* camera)
+	{
+		++_frame;
+		_camera = camera;
+		_has_viewpoint = camera != 0;
+		if( camera)
+		{
+			_viewpoint = camera->getDerivedPosition();
+		}
+
+		for( uint l = 0; l < TRIP_LOD_LEVELS; ++l)
+		{
+			_cluster_counts[l] = 0;
+		}
+		_deferred_count = 0;
+		_offscreen_count = 0;
+	}
+
+
+	/**
+	 * Retrieves the update interval of a Cluster in the current frame.
+	 * @param cluster The Cluster.
+	 * @return 1 to update every frame, 2 for every 2nd frame, and so on.
+	 */
+	uint LodPolicy::getInterval( Cluster* cluster)
+	{
+		bool offscreen = false;
+		return computeInterval( cluster, offscreen);
+	}
+
+
+	/**
+	 * Reports the time the Engine needed for the last frame and adapts the degradation level.
+	 * A frame over the budget raises the level at once. The level is lowered again after
+	 * TRIP_LOD_BUDGET_CALM_FRAMES frames below TRIP_LOD_BUDGET_RECOVERY of the budget,
+	 * because every level down doubles the work of the degraded Clusters.
+	 * @param elapsed The time of the frame, measured with the Clock.
+	 */
+	void LodPolicy::record( Clock::Ticks elapsed)
+	{
+		_last_time = (float) Clock::toMilliseconds( elapsed);
+		if( _budget <= 0)
+		{
+			_degradation = 0;
+			_calm_frames = 0;
+			return;
+		}
+
+		if( _last_time > _budget)
+		{
+			_calm_frames = 0;
+			if( _degradation + 1 < TRIP_LOD_LEVELS)
+			{
+				++_degradation;
+			}
+		}
+		else if( _degradation > 0 && _last_time < _budget * TRIP_LOD_BUDGET_RECOVERY)
+		{
+			if( ++_calm_frames >= TRIP_LOD_BUDGET_CALM_FRAMES)
+			{
+				--_degradation;
+				_calm_frames = 0;
+			}
+		}
+		else
+		{
+			_calm_frames = 0;
+		}
+	}
+
+
+	/**
+	 * Indicates whether a Cluster is outside the camera frustum in the current frame.
+	 * @param cluster The Cluster.
+	 * @return
+	 * TRUE - culling is enabled and the bounds of the Cluster are not visible
+	 * FALSE - the Cluster may be visible or culling is disabled
+	 */
+	bool LodPolicy::isOffscreen( Cluster* cluster)
+	{
+		if( !_culling || !_camera)
+			return false;
+
+		return !_camera->isVisible( cluster->getWorldBounds());
+	}
+
+
+	/**
+	 * Retrieves the update interval of a Cluster from its distance to the camera.
+	 * Every doubling of the distance beyond getDistance() doubles the interval.
+	 * @param cluster The Cluster.
+	 * @return 1 to update every frame, 2 for every 2nd frame, and so on.
+	 */
+	uint LodPolicy::getDistanceInterval( Cluster* cluster)
+	{
+		if( !_enabled || !_has_viewpoint)
+			return 1;
+
+		float distance = cluster->getClusterNode()->_getDerivedPosition().distance( _viewpoint);
+		uint interval = 1;
+		for( uint l = 1; l < TRIP_LOD_LEVELS && distance >= _distance; ++l)
+		{
+			interval *= 2;
+			distance *= 0.5f;
+		}
+		return interval;
+	}
+
+
+	/**
+	 * Computes the update interval of a Cluster in the current frame.
+	 * Off-screen Clusters get at least TRIP_LOD_OFFSCREEN_INTERVAL. Every degradation level
+	 * above the priority of the Cluster doubles the interval, up to 2^(TRIP_LOD_LEVELS-1).
+	 * @param cluster The Cluster.
+	 * @param offscreen Receives whether the Cluster is outside the camera frustum.
+	 * @return 1 to update every frame, 2 for every 2nd frame, and so on.
+	 */
+	uint LodPolicy::computeInterval( Cluster* cluster, bool& offscreen)
+	{
+		uint interval = getDistanceInterval( cluster);
+
+		offscreen = isOffscreen( cluster);
+		if( offscreen)
+		{
+			interval = std::max<uint>( interval, TRIP_LOD_OFFSCREEN_INTERVAL);
+		}
+
+		const uint priority = cluster->getPriority();
+		if( _degradation > priority)
+		{
+			interval <<= _degradation - priority;
+		}
+		return std::min<uint>( interval, 1u << (TRIP_LOD_LEVELS - 1));
+	}
+
+
+	/**
+	 * Indicates whether the Transformers of a Cluster shall be applied in the current frame.
+	 * Clusters with the same interval take turns by their phase, so the degraded Clusters
+	 * are updated round-robin. Counts the Cluster for print().
+	 * @param cluster The Cluster.
+	 * @param phase A number that differs between Clusters, to spread their updates over the frames.
+	 * @return
+	 * TRUE - update the Cluster
+	 * FALSE - defer the time of this frame to a later update
+	 */
+	bool LodPolicy::isDue( Cluster* cluster, uint phase)
+	{
+		bool offscreen = false;
+		const uint interval = computeInterval( cluster, offscreen);
+		if( offscreen)
+		{
+			++_offscreen_count;
+		}
+
+		uint level = 0;
+		while( level + 1 < TRIP_LOD_LEVELS && (1u << level) < interval)
+		{
+			++level;
+		}
+		++_cluster_counts[level];
+
+		const bool due = (_frame + phase) % interval == 0;
+		if( !due)
+		{
+			++_deferred_count;
+		}
+		return due;
+	}
+
+
+	/**
+	 * Prints the degradation level and the number of Clusters per update rate in the last frame onto the console.
+	 */
+	void LodPolicy::print()
+	{
+		if( _budget > 0)
+		{
+			std::cout << "Budget: " << _budget << " ms, last frame " << _last_time << " ms, degradation level " << _degradation;
+			if( _degradation > 0)
+			{
+				std::cout << " (priority p below " << _degradation << " multiplies the update interval by 2^(" << _degradation
+					<< "-p), up to every " << (1u << (TRIP_LOD_LEVELS - 1)) << ". frame)";
+			}
+			std::cout << std::endl;
+		}
+
+		if( !_enabled && !_culling && _budget <= 0)
+		{
+			std::cout << "LOD: disabled" << std::endl;
+			return;
+		}
+
+		std::cout << "LOD: ";
+		if( _enabled)
+			std::cout << "distance " << _distance;
+		else
+			std::cout << "no distance";
+		std::cout << (_culling ? ", culling" : "") << (_has_viewpoint ? "" : ", no camera") << std::endl;
+		for( uint l = 0; l < TRIP_LOD_LEVELS; ++l)
+		{
+			std::cout << "  every " << std::setw(2) << (1u << l) << ". frame: " << _cluster_counts[l] << " clusters" << std::endl;
+		}
+		std::cout << "  deferred in the last frame: " << _deferred_count << " clusters" << std::endl;
+		if( _culling)
+		{
+			std::cout << "  off-screen in the last frame: " << _offscreen_count << " clusters" << std::endl;
+		}
+	}
+
+} // END namespace Trip
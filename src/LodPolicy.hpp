@@ -0,0 +1,337 @@
+/**
+ * This file contains the LodPolicy, which lowers the update rate
+ * of Clusters that are far away from the camera, off-screen or of low priority
+ * while the Engine exceeds its frame budget.
+ * @author barn
+ * @version 20121203
+ */
+#ifndef __LodPolicy_HPP__
+#define __LodPolicy_HPP__
+
+/*===========================================================================*
+ * INCLUDES base definition file for DLL import/export
+ *===========================================================================*/
+
+/*===========================================================================*
+ * INCLUDES project headers
+ *===========================================================================*/
+#include "stdafx.h"
+#include <util/Clock.hpp>
+
+/*===========================================================================*
+ * INCLUDES C/C++ standard library (and other external libraries)
+ *===========================================================================*/
+
+/*===========================================================================*
+ * DEFINES and MACROS
+ *===========================================================================*/
+
+/// The number of update rates: every frame, every 2nd, every 4th and every 8th frame.
+#define TRIP_LOD_LEVELS 4
+
+/// The default distance up to which Clusters are updated every frame.
+#define TRIP_LOD_DISTANCE 1000.0f
+
+/// The update interval of Clusters outside the camera frustum, at most 2^(TRIP_LOD_LEVELS-1).
+#define TRIP_LOD_OFFSCREEN_INTERVAL 8
+
+/// The fraction of the budget the frames must stay below to lower the degradation level.
+#define TRIP_LOD_BUDGET_RECOVERY 0.5f
+
+/// The number of frames below the recovery time it takes to lower the degradation level.
+#define TRIP_LOD_BUDGET_CALM_FRAMES 30
+
+/*===========================================================================*
+ * NAMESPACE, CONSTANTS and TYPE DECLARATIONS/IMPLEMENTATIONS
+ *===========================================================================*/
+
+namespace Trip
+{
+	class Cluster;
+
+	/**
+	 * The singleton LodPolicy decides how often the Transformers of a Cluster are applied,
+	 * depending on the distance between the camera and the cluster node.
+	 *
+	 * Clusters closer than getDistance() are updated every frame. Each doubling of the distance
+	 * halves the update rate, down to every 2^(TRIP_LOD_LEVELS-1)th frame. The frames of Clusters with
+	 * the same rate are spread by a phase, so not all of them are updated within the same frame.
+	 * A Cluster that is not due defers the time of the frame, see Cluster::deferTime(), and gets it
+	 * added to the time of its next update. So animations stay time-correct, only coarser.
+	 *
+	 * With culling, Clusters whose bounds (see Cluster::getWorldBounds()) are outside the camera frustum
+	 * are updated only every TRIP_LOD_OFFSCREEN_INTERVAL frames. They are not skipped entirely, so their
+	 * own Transformers can still move them back into view. A Cluster that enters the view is due in the
+	 * next frame and catches up on the deferred time at once.
+	 * With a frame budget, the LodPolicy watches the time the Engine needs per frame, see record().
+	 * While the frames take longer than the budget, it raises a degradation level. Every level above
+	 * the priority of a Cluster, see Cluster::setPriority(), halves its update rate. So low-priority
+	 * Clusters are updated round-robin at a reduced rate instead of stalling the whole frame.
+	 *
+	 * Clusters with a Transformer that is not deferrable, see Transformer::isDeferrable(), are never slowed down.
+	 *
+	 * Without a camera, e.g. in headless mode, or when disabled, every Cluster is updated every frame.
+	 */
+	class LodPolicy
+	{
+	private: // class vars
+
+		/// The singleton instance.
+		static LodPolicy* __instance;
+
+	private: // vars
+
+		/// Indicates whether far Clusters are updated less often.
+		bool _enabled;
+
+		/// The distance up to which Clusters are updated every frame.
+		float _distance;
+
+		/// The position of the camera in the current frame.
+		Ogre::Vector3 _viewpoint;
+
+		/// Indicates whether there is a camera in the current frame.
+		bool _has_viewpoint;
+
+		/// Indicates whether Clusters outside the camera frustum are updated less often.
+		bool _culling;
+
+		/// The camera of the current frame or NULL.
+		Ogre::Camera* _camera;
+
+		/// The number of the current frame.
+		uint _frame;
+
+		/// The number of Clusters per update rate in the current frame.
+		uint _cluster_counts[TRIP_LOD_LEVELS];
+
+		/// The number of Clusters that deferred the current frame.
+		uint _deferred_count;
+
+		/// The number of Clusters outside the camera frustum in the current frame.
+		uint _offscreen_count;
+
+		/// The time the Engine may take per frame in milliseconds or 0 for no limit.
+		float _budget;
+
+		/// The time the Engine took for the last frame in milliseconds.
+		float _last_time;
+
+		/// The number of times the rate of low-priority Clusters is halved.
+		uint _degradation;
+
+		/// The number of consecutive frames well below the budget.
+		uint _calm_frames;
+
+	protected: // constructor
+
+		/**
+		 * Protected main constructor.
+		 * The policy is disabled by default.
+		 */
+		LodPolicy();
+
+	public: // destructor
+
+		/**
+		 * Destructor.
+		 */
+		~LodPolicy()
+		{
+			__instance = 0;
+		}
+
+	public: // class methods
+
+		/**
+		 * Retrieves the singleton instance of the LodPolicy.
+		 * Also does the lazy initialization.
+		 * @return The singleton LodPolicy.
+		 */
+		static LodPolicy* instance()
+		{
+			if (__instance == 0)
+				__instance = new LodPolicy();
+
+			return __instance;
+		}
+
+	public: // methods
+
+		/**
+		 * Starts a new frame. Call it once before the plan is executed.
+		 * @param camera The active camera or NULL if there is none.
+		 */
+		void update( Ogre::Camera* camera);
+
+		/**
+		 * Retrieves the update interval of a Cluster in the current frame.
+		 * @param cluster The Cluster.
+		 * @return 1 to update every frame, 2 for every 2nd frame, and so on.
+		 */
+		uint getInterval( Cluster* cluster);
+
+		/**
+		 * Reports the time the Engine needed for the last frame and adapts the degradation level.
+		 * @param elapsed The time of the frame, measured with the Clock.
+		 */
+		void record( Clock::Ticks elapsed);
+
+		/**
+		 * Indicates whether a Cluster is outside the camera frustum in the current frame.
+		 * @param cluster The Cluster.
+		 * @return
+		 * TRUE - culling is enabled and the bounds of the Cluster are not visible
+		 * FALSE - the Cluster may be visible or culling is disabled
+		 */
+		bool isOffscreen( Cluster* cluster);
+
+		/**
+		 * Indicates whether the Transformers of a Cluster shall be applied in the current frame.
+		 * Counts the Cluster for print().
+		 * @param cluster The Cluster.
+		 * @param phase A number that differs between Clusters, to spread their updates over the frames.
+		 * @return
+		 * TRUE - update the Cluster
+		 * FALSE - defer the time of this frame to a later update
+		 */
+		bool isDue( Cluster* cluster, uint phase);
+
+		/**
+		 * Prints the degradation level and the number of Clusters per update rate in the last frame onto the console.
+		 */
+		void print();
+
+	private: // helpers
+
+		/**
+		 * Computes the update interval of a Cluster in the current frame.
+		 * @param cluster The Cluster.
+		 * @param offscreen Receives whether the Cluster is outside the camera frustum.
+		 * @return 1 to update every frame, 2 for every 2nd frame, and so on.
+		 */
+		uint computeInterval( Cluster* cluster, bool& offscreen);
+
+		/**
+		 * Retrieves the update interval of a Cluster from its distance to the camera.
+		 * @param cluster The Cluster.
+		 * @return 1 to update every frame, 2 for every 2nd frame, and so on.
+		 */
+		uint getDistanceInterval( Cluster* cluster);
+
+	public: // getters & setters
+
+		/**
+		 * Sets whether Clusters far from the camera shall be updated less often.
+		 * @param enabled
+		 * TRUE - lower the update rate with the distance
+		 * FALSE - update every Cluster every frame
+		 */
+		void setEnabled( bool enabled)
+		{
+			_enabled = enabled;
+		}
+
+		/**
+		 * Indicates whether Clusters far from the camera are updated less often.
+		 * @return
+		 * TRUE - the update rate depends on the distance
+		 * FALSE - every Cluster is updated every frame
+		 */
+		bool isEnabled()
+		{
+			return _enabled;
+		}
+
+		/**
+		 * Sets the distance up to which Clusters are updated every frame.
+		 * @param distance The distance in world units, greater than 0.
+		 */
+		void setDistance( float distance)
+		{
+			if( distance > 0)
+				_distance = distance;
+		}
+
+		/**
+		 * Retrieves the distance up to which Clusters are updated every frame.
+		 * @return The distance in world units.
+		 */
+		float getDistance()
+		{
+			return _distance;
+		}
+
+		/**
+		 * Sets whether Clusters outside the camera frustum shall be updated less often.
+		 * @param culling
+		 * TRUE - update off-screen Clusters every TRIP_LOD_OFFSCREEN_INTERVAL frames
+		 * FALSE - ignore the frustum
+		 */
+		void setCulling( bool culling)
+		{
+			_culling = culling;
+		}
+
+		/**
+		 * Indicates whether Clusters outside the camera frustum are updated less often.
+		 * @return
+		 * TRUE - off-screen Clusters are updated every TRIP_LOD_OFFSCREEN_INTERVAL frames
+		 * FALSE - the frustum is ignored
+		 */
+		bool isCulling()
+		{
+			return _culling;
+		}
+
+		/**
+		 * Retrieves the number of Clusters outside the camera frustum in the last frame.
+		 * @return The number of off-screen Clusters.
+		 */
+		uint getOffscreenCount()
+		{
+			return _offscreen_count;
+		}
+
+		/**
+		 * Sets the time the Engine may take per frame.
+		 * @param milliseconds The budget in milliseconds or 0 to never degrade.
+		 */
+		void setBudget( float milliseconds)
+		{
+			_budget = milliseconds > 0 ? milliseconds : 0;
+		}
+
+		/**
+		 * Retrieves the time the Engine may take per frame.
+		 * @return The budget in milliseconds or 0 for no limit.
+		 */
+		float getBudget()
+		{
+			return _budget;
+		}
+
+		/**
+		 * Retrieves the current degradation level.
+		 * @return 0 if the Engine keeps its budget, otherwise the number of times
+		 * the rate of low-priority Clusters is halved.
+		 */
+		uint getDegradation()
+		{
+			return _degradation;
+		}
+
+		/**
+		 * Retrieves the number of Clusters that deferred the last frame.
+		 * @return The number of Clusters that were not updated.
+		 */
+		uint getDeferredCount()
+		{
+			return _deferred_count;
+		}
+
+	}; // END class LodPolicy
+
+} // END namespace Trip
+
+#endif /* __LodPolicy_HPP__ */
@@ -0,0 +1,166 @@
+/**
+ * Implementation file for the NodeInterpolator.hpp.
+ * @author barn
+ * @version 20121210
+ */
+
+/*===========================================================================*
+ * INCLUDES (associated header files)
+ *===========================================================================*/
+#include "NodeInterpolator.hpp"
+
+/*===========================================================================*
+ * INCLUDES project headers
+ *===========================================================================*/
+#include <ExecutionPlan.hpp>
+
+/*===========================================================================*
+ * INCLUDES C/C++ standard library (and other external libraries)
+ *===========================================================================*/
+#include <algorithm>
+
+/*===========================================================================*
+ * DEFINES and MACROS
+ *===========================================================================*/
+
+/*===========================================================================*
+ * NAMESPACE, CONSTANTS and TYPE DECLARATIONS/IMPLEMENTATIONS
+ *===========================================================================*/
+
+namespace Trip
+{
+
+	/// The interpolators whose Nodes hold blended transforms.
+	std::vector<NodeInterpolator*> NodeInterpolator::__blended;
+
+
+	/**
+	 * Sets the Nodes of every interpolator back to their current transforms.
+	 * Call it before Nodes are destroyed, since they might be blended.
+	 */
+	void NodeInterpolator::restoreAll()
+	{
+		while( !__blended.empty())
+		{
+			__blended.back()->restore();
+		}
+	}
+
+
+	/**
+	 * Stores the transforms of all Nodes of the plan before a simulation step.
+	 * @param plan The plan that is about to be executed.
+	 */
+	void NodeInterpolator::capturePrevious( ExecutionPlan& plan)
+	{
+		restore();
+
+		const std::vector<Ogre::Node*>& nodes = plan.getNodes();
+		_nodes.assign( nodes.begin(), nodes.end());
+		capture( _previous);
+		_valid = false;
+	}
+
+
+	/**
+	 * Stores the transforms of all Nodes after a simulation step.
+	 * Must follow capturePrevious() without recompiling the plan in between.
+	 */
+	void NodeInterpolator::captureCurrent()
+	{
+		capture( _current);
+		_valid = true;
+		setBlended( false);
+	}
+
+
+	/**
+	 * Sets the Nodes to a blend of the previous and the current transforms.
+	 * Does nothing without valid snapshots.
+	 * @param alpha The blend factor within [0,1], 0 means previous and 1 means current.
+	 */
+	void NodeInterpolator::blend( float alpha)
+	{
+		if( !_valid)
+			return;
+
+		const uint count = _nodes.size();
+		for( uint i = 0; i < count; ++i)
+		{
+			const State& a = _previous[i];
+			const State& b = _current[i];
+			Ogre::Node* node = _nodes[i];
+
+			node->setPosition( a.position + (b.position - a.position) * alpha);
+			node->setOrientation( Ogre::Quaternion::nlerp( alpha, a.orientation, b.orientation, true));
+			node->setScale( a.scale + (b.scale - a.scale) * alpha);
+		}
+		setBlended( true);
+	}
+
+
+	/**
+	 * Sets the Nodes back to the current transforms, if they have been blended.
+	 * Call it before the next simulation step.
+	 */
+	void NodeInterpolator::restore()
+	{
+		// only valid snapshots are blended
+		if( !_blended)
+			return;
+
+		const uint count = _nodes.size();
+		for( uint i = 0; i < count; ++i)
+		{
+			const State& s = _current[i];
+			Ogre::Node* node = _nodes[i];
+
+			node->setPosition( s.position);
+			node->setOrientation( s.orientation);
+			node->setScale( s.scale);
+		}
+		setBlended( false);
+	}
+
+
+	/**
+	 * Stores the transforms of all Nodes.
+	 * @param states Receives one State per Node.
+	 */
+	void NodeInterpolator::capture( std::vector<State>& states)
+	{
+		const uint count = _nodes.size();
+		states.resize( count);
+		for( uint i = 0; i < count; ++i)
+		{
+			Ogre::Node* node = _nodes[i];
+			states[i].position = node->getPosition();
+			states[i].orientation = node->getOrientation();
+			states[i].scale = node->getScale();
+		}
+	}
+
+
+	/**
+	 * Sets whether the Nodes hold blended transforms and keeps the interpolator in the list of blended ones.
+	 * @param blended
+	 * TRUE - the Nodes hold blended transforms
+	 * FALSE - the Nodes hold the current transforms or the snapshots are forgotten
+	 */
+	void NodeInterpolator::setBlended( bool blended)
+	{
+		if( blended == _blended)
+			return;
+
+		_blended = blended;
+		if( blended)
+		{
+			__blended.push_back( this);
+		}
+		else
+		{
+			__blended.erase( std::remove( __blended.begin(), __blended.end(), this), __blended.end());
+		}
+	}
+
+} // END namespace Trip
@@ -0,0 +1,176 @@
+/**
+ * This file contains the NodeInterpolator, which blends the Nodes of an
+ * ExecutionPlan between the last two simulation steps for rendering.
+ * @author barn
+ * @version 20121210
+ */
+#ifndef __NodeInterpolator_HPP__
+#define __NodeInterpolator_HPP__
+
+/*===========================================================================*
+ * INCLUDES base definition file for DLL import/export
+ *===========================================================================*/
+
+/*===========================================================================*
+ * INCLUDES project headers
+ *===========================================================================*/
+#include "stdafx.h"
+
+/*===========================================================================*
+ * INCLUDES C/C++ standard library (and other external libraries)
+ *===========================================================================*/
+
+/*===========================================================================*
+ * DEFINES and MACROS
+ *===========================================================================*/
+
+/*===========================================================================*
+ * NAMESPACE, CONSTANTS and TYPE DECLARATIONS/IMPLEMENTATIONS
+ *===========================================================================*/
+
+namespace Trip
+{
+	class ExecutionPlan;
+
+	/**
+	 * The NodeInterpolator keeps the local transforms of all Nodes of an ExecutionPlan
+	 * at the last two simulation steps. Since Transformers change the Nodes incrementally,
+	 * the Nodes themselves hold the simulation state. For rendering, the Nodes are set
+	 * to a blend of both steps and must be restored before the next simulation step.
+	 *
+	 * The snapshots are only valid as long as the plan is not recompiled.
+	 * Call invalidate() whenever the plan might have changed.
+	 * Nodes must not be destroyed while they are blended, call restoreAll() before destroying any.
+	 */
+	class NodeInterpolator
+	{
+	private: // nested types
+
+		/// The local transform of one Node.
+		struct State
+		{
+			Ogre::Vector3 position;
+			Ogre::Quaternion orientation;
+			Ogre::Vector3 scale;
+		};
+
+	private: // class vars
+
+		/// The interpolators whose Nodes hold blended transforms.
+		static std::vector<NodeInterpolator*> __blended;
+
+	private: // vars
+
+		/// The Nodes of the plan the snapshots were taken from.
+		std::vector<Ogre::Node*> _nodes;
+
+		/// The transforms before the last simulation step.
+		std::vector<State> _previous;
+
+		/// The transforms after the last simulation step.
+		std::vector<State> _current;
+
+		/// Indicates whether both snapshots belong to _nodes.
+		bool _valid;
+
+		/// Indicates whether the Nodes hold blended transforms instead of the current ones.
+		bool _blended;
+
+	public: // constructor & destructor
+
+		/**
+		 * Main constructor.
+		 * Creates an interpolator without any snapshots.
+		 */
+		NodeInterpolator()
+			: _valid(false),
+			_blended(false)
+		{}
+
+		/**
+		 * Destructor.
+		 */
+		~NodeInterpolator()
+		{
+			setBlended( false);
+		}
+
+	public: // class methods
+
+		/**
+		 * Sets the Nodes of every interpolator back to their current transforms.
+		 * Call it before Nodes are destroyed, since they might be blended.
+		 */
+		static void restoreAll();
+
+	public: // methods
+
+		/**
+		 * Stores the transforms of all Nodes of the plan before a simulation step.
+		 * @param plan The plan that is about to be executed.
+		 */
+		void capturePrevious( ExecutionPlan& plan);
+
+		/**
+		 * Stores the transforms of all Nodes after a simulation step.
+		 * Must follow capturePrevious() without recompiling the plan in between.
+		 */
+		void captureCurrent();
+
+		/**
+		 * Sets the Nodes to a blend of the previous and the current transforms.
+		 * Does nothing without valid snapshots.
+		 * @param alpha The blend factor within [0,1], 0 means previous and 1 means current.
+		 */
+		void blend( float alpha);
+
+		/**
+		 * Sets the Nodes back to the current transforms, if they have been blended.
+		 * Call it before the next simulation step.
+		 */
+		void restore();
+
+		/**
+		 * Forgets the snapshots without touching any Node.
+		 * Call it when the plan was recompiled, since its Nodes might be gone.
+		 */
+		void invalidate()
+		{
+			_valid = false;
+			setBlended( false);
+		}
+
+	public: // getters & setters
+
+		/**
+		 * Indicates whether there are snapshots to blend.
+		 * @return
+		 * TRUE - blend() will change the Nodes
+		 * FALSE - there are no valid snapshots
+		 */
+		bool isValid()
+		{
+			return _valid;
+		}
+
+	private: // helpers
+
+		/**
+		 * Stores the transforms of all Nodes.
+		 * @param states Receives one State per Node.
+		 */
+		void capture( std::vector<State>& states);
+
+		/**
+		 * Sets whether the Nodes hold blended transforms and keeps the interpolator in the list of blended ones.
+		 * @param blended
+		 * TRUE - the Nodes hold blended transforms
+		 * FALSE - the Nodes hold the current transforms or the snapshots are forgotten
+		 */
+		void setBlended( bool blended);
+
+	}; // END class NodeInterpolator
+
+} // END namespace Trip
+
+#endif /* __NodeInterpolator_HPP__ */
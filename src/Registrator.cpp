@@ -1,7 +1,7 @@
 /**
  * Implementation file of the Registrator.hpp.
  * @author barn
- * @version 20121029
+ * @version 20121209
  */
 
 /*===========================================================================*
@@ -21,6 +21,7 @@
 #include "managers/TransformerManager.hpp"
 
 #include "functions/Functions1.hpp"
+#include "functions/CurveFunction.hpp"
 
 #include "clusters/Clusters1.hpp"
 
@@ -59,6 +60,12 @@ namespace Trip
 			man->addPrototype( "Sine", new Sine());
 			man->addPrototype( "CosFade", new CosFade());
 
+			// composed at compile time: sin( 10x) * exp( -x) and a clipped sine pulse
+			man->addPrototype( "Ripple", makeCurveFunction(
+				Curves::product( Curves::stretch( 10, Curves::Sine()), Curves::stretch( -1, Curves::Exp()))));
+			man->addPrototype( "Pulse", makeCurveFunction(
+				Curves::clamp( 0, 1, Curves::scale( 2, Curves::Sine()))));
+
 		}
 
 		/// registers all Transformers
@@ -0,0 +1,267 @@
+/**
+ * Implementation file for the SimulationPipeline.hpp.
+ * @author barn
+ * @version 20121204
+ */
+
+/*===========================================================================*
+ * INCLUDES (associated header files)
+ *===========================================================================*/
+#include "SimulationPipeline.hpp"
+
+/*===========================================================================*
+ * INCLUDES project headers
+ *===========================================================================*/
+#include <ExecutionPlan.hpp>
+#include <stores/HeadlessNodeStore.hpp>
+
+/*===========================================================================*
+ * INCLUDES C/C++ standard library (and other external libraries)
+ *===========================================================================*/
+#include <boost/bind.hpp>
+
+/*===========================================================================*
+ * DEFINES and MACROS
+ *===========================================================================*/
+
+/*===========================================================================*
+ * NAMESPACE, CONSTANTS and TYPE DECLARATIONS/IMPLEMENTATIONS
+ *===========================================================================*/
+
+namespace Trip
+{
+
+	/**
+	 * Main constructor.
+	 * The simulation thread is started with the first step.
+	 */
+	SimulationPipeline::SimulationPipeline()
+		: _plan(0),
+		_pool(0),
+		_back(0),
+		_pending(false),
+		_running(false),
+		_completed(false),
+		_stop(false),
+		_ticks(0)
+	{}
+
+
+	/**
+	 * Destructor.
+	 * Waits for the running step and stops the simulation thread.
+	 * Does not apply the last step.
+	 */
+	SimulationPipeline::~SimulationPipeline()
+	{
+		{
+			boost::mutex::scoped_lock lock( _mutex);
+			_stop = true;
+		}
+		_condition.notify_all();
+		if( _thread.joinable())
+		{
+			_thread.join();
+		}
+
+		for( auto it = _shadow_nodes.begin(); it != _shadow_nodes.end(); ++it)
+		{
+			delete *it;
+		}
+	}
+
+
+	/**
+	 * Creates the shadows of all thread-safe Entries of a compiled plan and hands them to the plan.
+	 * The shadows start with the transforms of their Nodes. No step may be running.
+	 * @param plan The plan to process. Its Nodes must show the latest step, see apply().
+	 */
+	void SimulationPipeline::attach( ExecutionPlan& plan)
+	{
+		const std::vector<Ogre::Node*>& nodes = plan.getNodes();
+		_nodes.assign( nodes.begin(), nodes.end());
+		_shadows.assign( nodes.begin(), nodes.end());
+		_indices.clear();
+
+		const std::vector<ExecutionPlan::Entry>& entries = plan.getEntries();
+		for( auto it = entries.begin(); it != entries.end(); ++it)
+		{
+			if( !it->thread_safe || it->transformer_count == 0)
+				continue;
+
+			for( uint i = it->first_node; i < it->first_node + it->node_count; ++i)
+			{
+				if( _indices.size() == _shadow_nodes.size())
+				{
+					_shadow_nodes.push_back( new HeadlessNode());
+				}
+
+				Ogre::Node* shadow = _shadow_nodes[_indices.size()];
+				shadow->setPosition( _nodes[i]->getPosition());
+				shadow->setOrientation( _nodes[i]->getOrientation());
+				shadow->setScale( _nodes[i]->getScale());
+
+				_shadows[i] = shadow;
+				_indices.push_back( i);
+			}
+		}
+
+		_buffers[0].resize( _indices.size());
+		_buffers[1].resize( _indices.size());
+		_pending = false;
+		_completed = false;
+
+		_plan = &plan;
+		_plan->setShadows( _shadows);
+	}
+
+
+	/**
+	 * Waits for the running step, applies it and lets the plan work on its Nodes again.
+	 * Does nothing if the pipeline is not attached.
+	 */
+	void SimulationPipeline::detach()
+	{
+		if( !_plan)
+			return;
+
+		finish();
+		apply();
+
+		_plan->setShadows( std::vector<Ogre::Node*>());
+		_plan = 0;
+	}
+
+
+	/**
+	 * Starts a step of the thread-safe Entries on the simulation thread.
+	 * The plan must be attached and prepared, see ExecutionPlan::prepare().
+	 * @param pool The ThreadPool to process the Entries in parallel or NULL.
+	 * It must not be used by any other thread until finish() returns.
+	 */
+	void SimulationPipeline::start( ThreadPool* pool)
+	{
+		if( !_plan)
+			return;
+
+		// nothing to simulate, but the step is done
+		if( _indices.empty())
+		{
+			boost::mutex::scoped_lock lock( _mutex);
+			_ticks = 0;
+			_completed = true;
+			return;
+		}
+
+		if( !_thread.joinable())
+		{
+			_thread = boost::thread( boost::bind( &SimulationPipeline::threadLoop, this));
+		}
+
+		{
+			boost::mutex::scoped_lock lock( _mutex);
+			_pool = pool;
+			_running = true;
+		}
+		_condition.notify_all();
+	}
+
+
+	/**
+	 * Waits for the running step, if there is one, and swaps the buffers.
+	 * @return
+	 * TRUE - a step has finished, the front buffer holds it
+	 * FALSE - no step has been started since the last call
+	 */
+	bool SimulationPipeline::finish()
+	{
+		boost::mutex::scoped_lock lock( _mutex);
+		while( _running)
+		{
+			_condition.wait( lock);
+		}
+
+		if( !_completed)
+			return false;
+
+		_back = 1 - _back;
+		_completed = false;
+		_pending = true;
+		return true;
+	}
+
+
+	/**
+	 * Writes the transforms of the front buffer to the Nodes of the scene, if they have not been
+	 * written yet. Only changed components are set. Call it on the thread that renders.
+	 */
+	void SimulationPipeline::apply()
+	{
+		if( !_pending)
+			return;
+
+		const std::vector<State>& front = _buffers[1 - _back];
+		const uint count = _indices.size();
+		for( uint k = 0; k < count; ++k)
+		{
+			const State& s = front[k];
+			Ogre::Node* node = _nodes[_indices[k]];
+
+			if( node->getPosition() != s.position)
+				node->setPosition( s.position);
+			if( node->getOrientation() != s.orientation)
+				node->setOrientation( s.orientation);
+			if( node->getScale() != s.scale)
+				node->setScale( s.scale);
+		}
+		_pending = false;
+	}
+
+
+	/**
+	 * The loop of the simulation thread. Processes a step whenever start() asks for it.
+	 */
+	void SimulationPipeline::threadLoop()
+	{
+		boost::mutex::scoped_lock lock( _mutex);
+		while( true)
+		{
+			while( !_running && !_stop)
+			{
+				_condition.wait( lock);
+			}
+			if( _stop)
+				return;
+
+			// the render thread waits in finish() before it touches the plan
+			lock.unlock();
+			Clock::Ticks start = Clock::now();
+			_plan->run( _pool, ExecutionPlan::PASS_THREAD_SAFE);
+			publish();
+			_ticks = Clock::now() - start;
+			lock.lock();
+
+			_running = false;
+			_completed = true;
+			_condition.notify_all();
+		}
+	}
+
+
+	/**
+	 * Copies the transforms of all shadows into the back buffer.
+	 */
+	void SimulationPipeline::publish()
+	{
+		std::vector<State>& back = _buffers[_back];
+		const uint count = _indices.size();
+		for( uint k = 0; k < count; ++k)
+		{
+			Ogre::Node* shadow = _shadows[_indices[k]];
+			back[k].position = shadow->getPosition();
+			back[k].orientation = shadow->getOrientation();
+			back[k].scale = shadow->getScale();
+		}
+	}
+
+} // END namespace Trip
@@ -0,0 +1,219 @@
+/**
+ * This file contains the SimulationPipeline, which applies the thread-safe
+ * Clusters of an ExecutionPlan on a simulation thread while the render thread goes on.
+ * @author barn
+ * @version 20121204
+ */
+#ifndef __SimulationPipeline_HPP__
+#define __SimulationPipeline_HPP__
+
+/*===========================================================================*
+ * INCLUDES base definition file for DLL import/export
+ *===========================================================================*/
+
+/*===========================================================================*
+ * INCLUDES project headers
+ *===========================================================================*/
+#include "stdafx.h"
+#include <util/Clock.hpp>
+
+/*===========================================================================*
+ * INCLUDES C/C++ standard library (and other external libraries)
+ *===========================================================================*/
+#include <boost/thread.hpp>
+
+/*===========================================================================*
+ * DEFINES and MACROS
+ *===========================================================================*/
+
+/*===========================================================================*
+ * NAMESPACE, CONSTANTS and TYPE DECLARATIONS/IMPLEMENTATIONS
+ *===========================================================================*/
+
+namespace Trip
+{
+	class ExecutionPlan;
+	class HeadlessNode;
+	class ThreadPool;
+
+	/**
+	 * The SimulationPipeline lets a simulation thread process the thread-safe Entries of an
+	 * ExecutionPlan while the render thread renders. Ogre reads the Nodes while it renders,
+	 * so the simulation thread must not touch them. Instead, every Node of a thread-safe Entry
+	 * gets a shadow: a HeadlessNode outside the scene that holds the simulation state.
+	 *
+	 * After a step, the simulation thread copies the local transforms of the shadows into the back
+	 * buffer of a double-buffered transform store. finish() waits for the step and swaps the buffers.
+	 * apply() writes the front buffer to the Nodes of the scene in one pass, while the simulation thread
+	 * may already fill the back buffer with the next step. So the scene shows every pipelined Cluster
+	 * one step later than the Clusters that are processed on the render thread.
+	 *
+	 * Shadows have no parents, so pipelined Transformers only see the local transforms of their Nodes.
+	 * Nothing but the pipeline may change the Nodes of thread-safe Entries while it is attached.
+	 * The Cluster-tree, the plan and the Transformers must not change while a step is running:
+	 * call finish() and apply() before, see Engine::synchronize().
+	 *
+	 * @see Engine::setPipelined()
+	 */
+	class SimulationPipeline
+	{
+	private: // nested types
+
+		/// The local transform of one Node.
+		struct State
+		{
+			Ogre::Vector3 position;
+			Ogre::Quaternion orientation;
+			Ogre::Vector3 scale;
+		};
+
+	private: // vars
+
+		/// The plan the pipeline is attached to or NULL.
+		ExecutionPlan* _plan;
+
+		/// The ThreadPool of the running step or NULL.
+		ThreadPool* _pool;
+
+		/// The target Nodes of the plan, in its order.
+		std::vector<Ogre::Node*> _nodes;
+
+		/// The Node every target Node is changed through: its shadow or, for Entries that are not thread-safe, itself.
+		std::vector<Ogre::Node*> _shadows;
+
+		/// The indices of all target Nodes that have a shadow.
+		std::vector<uint> _indices;
+
+		/// All shadows ever created. They are reused when the plan is recompiled.
+		std::vector<HeadlessNode*> _shadow_nodes;
+
+		/// The transforms of the shadows after a step, one State per index. The simulation thread writes _buffers[_back].
+		std::vector<State> _buffers[2];
+
+		/// The index of the back buffer.
+		uint _back;
+
+		/// Indicates whether the front buffer holds a step that has not been applied yet.
+		bool _pending;
+
+		/// The simulation thread or not-a-thread before the first step.
+		boost::thread _thread;
+
+		/// Protects _running, _completed and _stop.
+		boost::mutex _mutex;
+
+		/// Wakes up the simulation thread and the threads waiting for it.
+		boost::condition_variable _condition;
+
+		/// Indicates whether the simulation thread is processing a step.
+		bool _running;
+
+		/// Indicates whether the back buffer holds a step that finish() has not swapped yet.
+		bool _completed;
+
+		/// Indicates that the simulation thread shall terminate.
+		bool _stop;
+
+		/// The time the simulation thread needed for the last step.
+		Clock::Ticks _ticks;
+
+	public: // constructor & destructor
+
+		/**
+		 * Main constructor.
+		 * The simulation thread is started with the first step.
+		 */
+		SimulationPipeline();
+
+		/**
+		 * Destructor.
+		 * Waits for the running step and stops the simulation thread.
+		 * Does not apply the last step.
+		 */
+		~SimulationPipeline();
+
+	public: // methods
+
+		/**
+		 * Creates the shadows of all thread-safe Entries of a compiled plan and hands them to the plan.
+		 * The shadows start with the transforms of their Nodes. No step may be running.
+		 * @param plan The plan to process. Its Nodes must show the latest step, see apply().
+		 */
+		void attach( ExecutionPlan& plan);
+
+		/**
+		 * Waits for the running step, applies it and lets the plan work on its Nodes again.
+		 * Does nothing if the pipeline is not attached.
+		 */
+		void detach();
+
+		/**
+		 * Starts a step of the thread-safe Entries on the simulation thread.
+		 * The plan must be attached and prepared, see ExecutionPlan::prepare().
+		 * @param pool The ThreadPool to process the Entries in parallel or NULL.
+		 * It must not be used by any other thread until finish() returns.
+		 */
+		void start( ThreadPool* pool);
+
+		/**
+		 * Waits for the running step, if there is one, and swaps the buffers.
+		 * @return
+		 * TRUE - a step has finished, the front buffer holds it
+		 * FALSE - no step has been started since the last call
+		 */
+		bool finish();
+
+		/**
+		 * Writes the transforms of the front buffer to the Nodes of the scene, if they have not been
+		 * written yet. Only changed components are set. Call it on the thread that renders.
+		 */
+		void apply();
+
+	public: // getters & setters
+
+		/**
+		 * Indicates whether the pipeline is attached to a plan.
+		 * @return
+		 * TRUE - the thread-safe Entries of the plan work on shadows
+		 * FALSE - the pipeline is idle
+		 */
+		bool isAttached()
+		{
+			return _plan != 0;
+		}
+
+		/**
+		 * Retrieves the number of Nodes the simulation thread processes.
+		 * @return The number of shadows.
+		 */
+		uint getShadowCount()
+		{
+			return _indices.size();
+		}
+
+		/**
+		 * Retrieves the time the simulation thread needed for the last finished step.
+		 * @return The time of the step, measured with the Clock.
+		 */
+		Clock::Ticks getTicks()
+		{
+			return _ticks;
+		}
+
+	private: // helpers
+
+		/**
+		 * The loop of the simulation thread. Processes a step whenever start() asks for it.
+		 */
+		void threadLoop();
+
+		/**
+		 * Copies the transforms of all shadows into the back buffer.
+		 */
+		void publish();
+
+	}; // END class SimulationPipeline
+
+} // END namespace Trip
+
+#endif /* __SimulationPipeline_HPP__ */
@@ -0,0 +1,353 @@
+///////////////////////////////////////////////////////////////////////////////
+// INCLUDES project headers
+#include "stdafx.h"
+
+#include <Defines.h>
+#include <managers/FunctionManager.hpp>
+#include <managers/TripVarManager.hpp>
+#include <managers/ClusterManager.hpp>
+#include <managers/TransformerManager.hpp>
+
+#include <Registrator.hpp> // SEMI HACK
+
+#include <Engine.hpp>
+#include <FrameProfiler.hpp>
+
+#include <stores/HeadlessNodeStore.hpp>
+
+#include <bench/Benchmark.hpp>
+
+
+///////////////////////////////////////////////////////////////////////////////
+//INCLUDES C/C++ standard library (and other external libraries)
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+
+///////////////////////////////////////////////////////////////////////////////
+// DEFINES and MACROS
+
+/// The largest error of the SIMD sine and cosine the math benchmark accepts.
+#define TRIP_BENCH_SINCOS_TOLERANCE 1e-6
+
+///////////////////////////////////////////////////////////////////////////////
+// NAMESPACE, CONSTANTS and TYPE DECLARATIONS/IMPLEMENTATIONS
+
+
+
+using namespace Trip;
+
+bool parseArguments( int argc, char** argv, Benchmark::Settings& settings, uint& maxThreads);
+
+void printUsage();
+
+bool printRotations( uint rotations);
+
+void printFunctions( uint values);
+
+
+/// Counts every allocation of the benchmark.
+void* operator new( size_t size)
+{
+	Benchmark::countAllocation();
+
+	void* ptr = std::malloc( size > 0 ? size : 1);
+	if( !ptr)
+	{
+		throw std::bad_alloc();
+	}
+	return ptr;
+}
+
+/// Counts every allocation of the benchmark.
+void* operator new[]( size_t size)
+{
+	return operator new( size);
+}
+
+void operator delete( void* ptr)
+{
+	std::free( ptr);
+}
+
+void operator delete[]( void* ptr)
+{
+	std::free( ptr);
+}
+
+
+
+
+/**
+ * Runs the Engine on a synthetic Cluster-tree without a render system
+ * and prints the measures for 1 up to the given number of threads.
+ * Call it with --help to see the arguments.
+ */
+int main( int argc, char** argv)
+{
+	Benchmark::Settings settings;
+	uint max_threads = boost::thread::hardware_concurrency();
+	if( !parseArguments( argc, argv, settings, max_threads))
+	{
+		printUsage();
+		return -1;
+	}
+
+	// grouped processing runs on one thread
+	if( settings.grouped)
+	{
+		max_threads = 1;
+	}
+
+	std::cout << "simd: " << SimdMath::getInstructionSetName( SimdMath::getInstructionSet()) << std::endl;
+	if( settings.math_rotations > 0 && !printRotations( settings.math_rotations))
+	{
+		std::cout << "the SIMD sine and cosine exceed the tolerance of " << TRIP_BENCH_SINCOS_TOLERANCE << std::endl;
+		return -1;
+	}
+
+	// set up the managers without Ogre
+	HeadlessNodeStore node_store;
+	FunctionManager::instance();
+	TripVarManager::instance()->setNodeStore( &node_store);
+	ClusterManager::setup( &node_store);
+	TransformerManager::instance();
+
+	Trip::Registrator::registerFunctions();
+	Trip::Registrator::registerTransformers();
+	Trip::Registrator::registerClusters();
+	ClusterManager::instance()->addPrototype( TRIP_BENCH_CLUSTER, new BenchCluster( settings.nodes));
+
+	if( settings.math_rotations > 0)
+	{
+		printFunctions( settings.math_rotations);
+	}
+
+	// build the tree
+	Benchmark benchmark( settings, &node_store);
+	if( !benchmark.build( ClusterManager::instance()->getRootCluster()))
+	{
+		return -1;
+	}
+
+	std::cout << "clusters: " << benchmark.getClusterCount()
+		<< ", nodes per cluster: " << settings.nodes
+		<< ", transformers per cluster: " << settings.transformers << " x " << settings.transformer
+		<< ", frames: " << settings.frames
+		<< (settings.grouped ? ", grouped" : "")
+		<< (settings.pipelined ? ", pipelined" : "")
+		<< (settings.profiled ? ", profiled" : "") << std::endl;
+
+	std::cout << std::setw(8) << "threads"
+		<< std::setw(14) << "ns/frame"
+		<< std::setw(14) << "update ns"
+		<< std::setw(14) << "ns/node/tf"
+		<< std::setw(14) << "allocs/frame"
+		<< std::setw(16) << "applications/s"
+		<< std::setw(10) << "speedup" << std::endl;
+
+	// measure 1, 2, 4, ... threads and the maximum
+	std::vector<uint> thread_counts;
+	for( uint threads = 1; threads < max_threads; threads *= 2)
+	{
+		thread_counts.push_back( threads);
+	}
+	thread_counts.push_back( max_threads);
+
+	// the profiler would measure itself
+	FrameProfiler::instance()->setEnabled( settings.profiled);
+
+	Engine engine;
+	engine.setGrouped( settings.grouped);
+	engine.setPipelined( settings.pipelined);
+	double single_thread_ns = 0;
+	for( auto it = thread_counts.begin(); it != thread_counts.end(); ++it)
+	{
+		engine.setThreadCount( *it);
+		Benchmark::Result result = benchmark.run( &engine);
+
+		if( it == thread_counts.begin())
+		{
+			single_thread_ns = result.ns_per_frame;
+		}
+
+		std::cout << std::fixed << std::setprecision(2)
+			<< std::setw(8) << result.threads
+			<< std::setw(14) << result.ns_per_frame
+			<< std::setw(14) << result.ns_update_per_frame
+			<< std::setw(14) << result.ns_per_application
+			<< std::setw(14) << result.allocations_per_frame
+			<< std::setw(16) << std::setprecision(0) << result.applications_per_second
+			<< std::setw(10) << std::setprecision(2) << (result.ns_per_frame > 0 ? single_thread_ns / result.ns_per_frame : 0)
+			<< std::endl;
+	}
+
+	return 0;
+}
+
+
+/**
+ * Parses the command line arguments into the settings.
+ * @param argc The argument counter of the main function.
+ * @param argv The argument vector of the main function.
+ * @param settings Receives the shape of the tree and the length of a run.
+ * @param maxThreads Receives the maximum number of threads to measure.
+ * @return
+ * TRUE - the arguments are valid
+ * FALSE - an argument is unknown or a value is missing
+ */
+bool parseArguments( int argc, char** argv, Benchmark::Settings& settings, uint& maxThreads)
+{
+	for( int i = 1; i < argc; ++i)
+	{
+		String arg( argv[i]);
+		if( arg == "--help" || i + 1 >= argc)
+			return false;
+
+		const char* value = argv[++i];
+		if( arg == "--depth")
+			settings.depth = std::atoi( value);
+		else if( arg == "--fanout")
+			settings.fanout = std::atoi( value);
+		else if( arg == "--nodes")
+			settings.nodes = std::atoi( value);
+		else if( arg == "--transformers")
+			settings.transformers = std::atoi( value);
+		else if( arg == "--transformer")
+			settings.transformer = value;
+		else if( arg == "--frames")
+			settings.frames = std::atoi( value);
+		else if( arg == "--warmup")
+			settings.warmup_frames = std::atoi( value);
+		else if( arg == "--threads")
+			maxThreads = std::atoi( value);
+		else if( arg == "--grouped")
+			settings.grouped = std::atoi( value) != 0;
+		else if( arg == "--pipelined")
+			settings.pipelined = std::atoi( value) != 0;
+		else if( arg == "--profile")
+			settings.profiled = std::atoi( value) != 0;
+		else if( arg == "--math")
+			settings.math_rotations = std::atoi( value);
+		else if( arg == "--simd")
+		{
+			// choose the instruction set of the SimdMath
+			bool found = false;
+			for( int s = SimdMath::SIMD_SCALAR; s <= SimdMath::SIMD_AVX; ++s)
+			{
+				if( SimdMath::getInstructionSetName( (SimdMath::InstructionSet) s) == String( value))
+				{
+					if( !SimdMath::setInstructionSet( (SimdMath::InstructionSet) s))
+					{
+						std::cout << "the instruction set " << value << " is not supported" << std::endl;
+						return false;
+					}
+					found = true;
+				}
+			}
+			if( !found)
+				return false;
+		}
+		else
+			return false;
+	}
+
+	if( maxThreads < 1)
+		maxThreads = 1;
+
+	return true;
+}
+
+
+/**
+ * Prints the command line arguments of the benchmark.
+ */
+void printUsage()
+{
+	Benchmark::Settings defaults;
+	std::cout << "usage: TripBench [options]" << std::endl
+		<< "  --depth N          Cluster levels below the root (" << defaults.depth << ")" << std::endl
+		<< "  --fanout N         child Clusters per Cluster (" << defaults.fanout << ")" << std::endl
+		<< "  --nodes N          Nodes per Cluster (" << defaults.nodes << ")" << std::endl
+		<< "  --transformers N   Transformers per Cluster (" << defaults.transformers << ")" << std::endl
+		<< "  --transformer NAME Transformer prototype (" << defaults.transformer << ")" << std::endl
+		<< "  --frames N         measured frames per thread count (" << defaults.frames << ")" << std::endl
+		<< "  --warmup N         frames before measuring (" << defaults.warmup_frames << ")" << std::endl
+		<< "  --threads N        maximum number of threads (hardware concurrency)" << std::endl
+		<< "  --grouped 0|1      process the Transformers grouped by type, on one thread (0)" << std::endl
+		<< "  --pipelined 0|1    process thread-safe clusters on a simulation thread, measure the render thread (0)" << std::endl
+		<< "  --profile 0|1      measure with the FrameProfiler enabled, which adds its own overhead (0)" << std::endl
+		<< "  --simd NAME        instruction set of the SimdMath: scalar, sse2 or avx (the best supported)" << std::endl
+		<< "  --math N           rotations and function values of the math benchmark, 0 to skip it (" << defaults.math_rotations << ")" << std::endl;
+}
+
+
+/**
+ * Measures the rotation math with Ogre::Quaternion and with the SimdMath on every
+ * supported instruction set and prints the times, the speedups and the largest error of the sine and cosine.
+ * @param rotations The number of rotations per measure.
+ * @return
+ * TRUE - the sine and cosine of every instruction set are within TRIP_BENCH_SINCOS_TOLERANCE
+ * FALSE - an instruction set computes them less precisely
+ */
+bool printRotations( uint rotations)
+{
+	const double ogre_ns = Benchmark::measureRotations( rotations, SimdMath::SIMD_SCALAR, true);
+	bool precise = true;
+
+	std::cout << std::setw(8) << "math"
+		<< std::setw(14) << "ns/rotation"
+		<< std::setw(10) << "speedup"
+		<< std::setw(14) << "sincos error" << std::endl;
+	std::cout << std::fixed << std::setprecision(2)
+		<< std::setw(8) << "ogre"
+		<< std::setw(14) << ogre_ns
+		<< std::setw(10) << 1.0 << std::endl;
+
+	const SimdMath::InstructionSet best = SimdMath::detectInstructionSet();
+	for( int s = SimdMath::SIMD_SCALAR; s <= best; ++s)
+	{
+		const double ns = Benchmark::measureRotations( rotations, (SimdMath::InstructionSet) s, false);
+		const double error = Benchmark::measureSinCosError( (SimdMath::InstructionSet) s);
+		precise = precise && error <= TRIP_BENCH_SINCOS_TOLERANCE;
+
+		std::cout << std::setw(8) << SimdMath::getInstructionSetName( (SimdMath::InstructionSet) s)
+			<< std::setw(14) << ns
+			<< std::setw(10) << (ns > 0 ? ogre_ns / ns : 0)
+			<< std::setw(14) << std::scientific << std::setprecision(1) << error
+			<< std::fixed << std::setprecision(2) << std::endl;
+	}
+	std::cout << std::endl;
+	return precise;
+}
+
+
+/**
+ * Measures every registered Function value by value and with funBatch()
+ * and prints the times and the speedups.
+ * @param values The number of values per measure.
+ */
+void printFunctions( uint values)
+{
+	std::cout << std::setw(12) << "function"
+		<< std::setw(14) << "ns/value"
+		<< std::setw(14) << "batch ns"
+		<< std::setw(10) << "speedup" << std::endl;
+
+	std::list<String> names = FunctionManager::instance()->getFunctionNameList();
+	for( auto it = names.begin(); it != names.end(); ++it)
+	{
+		Function* function = FunctionManager::instance()->createFunction( *it);
+		const double ns = Benchmark::measureFunction( function, values, false);
+		const double batch_ns = Benchmark::measureFunction( function, values, true);
+		delete function;
+
+		std::cout << std::fixed << std::setprecision(2)
+			<< std::setw(12) << *it
+			<< std::setw(14) << ns
+			<< std::setw(14) << batch_ns
+			<< std::setw(10) << (batch_ns > 0 ? ns / batch_ns : 0) << std::endl;
+	}
+	std::cout << std::endl;
+}
@@ -0,0 +1,336 @@
+/**
+ * Implementation file for the Benchmark.hpp.
+ * @author barn
+ * @version 20121210
+ */
+
+/*===========================================================================*
+ * INCLUDES (associated header files)
+ *===========================================================================*/
+#include "Benchmark.hpp"
+
+/*===========================================================================*
+ * INCLUDES project headers
+ *===========================================================================*/
+#include <Engine.hpp>
+#include <functions/Function.hpp>
+#include <managers/ClusterManager.hpp>
+#include <managers/TransformerManager.hpp>
+#include <stores/NodeStore.hpp>
+
+/*===========================================================================*
+ * INCLUDES C/C++ standard library (and other external libraries)
+ *===========================================================================*/
+#include <cmath>
+
+/*===========================================================================*
+ * DEFINES and MACROS
+ *===========================================================================*/
+
+/// The simulated time per frame, in seconds.
+#define TRIP_BENCH_FRAME_TIME (1.0f / 60.0f)
+
+/// The number of orientations the math benchmark rotates over and over again.
+#define TRIP_BENCH_MATH_BATCHES 128
+
+/// The number of values the Function benchmark evaluates over and over again, e.g. one per Node.
+#define TRIP_BENCH_FUNCTION_VALUES 1000
+
+/// The number of angles per power of ten the sine and cosine check computes.
+#define TRIP_BENCH_SINCOS_ANGLES 64
+
+/*===========================================================================*
+ * NAMESPACE, CONSTANTS and TYPE DECLARATIONS/IMPLEMENTATIONS
+ *===========================================================================*/
+
+namespace Trip
+{
+
+	/// The number of allocations counted so far.
+	boost::detail::atomic_count Benchmark::__allocations(0);
+
+
+	/**
+	 * Measures the rotation math of rotator-style Transformers: building a rotation from
+	 * an angle and an axis, normalising it and rotating an orientation with it.
+	 * The same TRIP_BENCH_MATH_BATCHES * TRIP_SIMD_WIDTH orientations are rotated over and over again,
+	 * so the memory does not limit the measure.
+	 * @param rotations The number of rotations to compute.
+	 * @param instructionSet The instruction set of the SimdMath to use.
+	 * @param ogre TRUE to measure Ogre::Quaternion instead of the SimdMath.
+	 * @return The average time per rotation in nanoseconds or 0 if the instruction set is not supported.
+	 */
+	double Benchmark::measureRotations( uint rotations, SimdMath::InstructionSet instructionSet, bool ogre)
+	{
+		const uint count = TRIP_BENCH_MATH_BATCHES * TRIP_SIMD_WIDTH;
+		const uint passes = std::max<uint>( 1, rotations / count);
+
+		// the same parameters for both paths
+		std::vector<float> angles( count);
+		std::vector<Vector3Batch> axes( TRIP_BENCH_MATH_BATCHES);
+		for( uint i = 0; i < count; ++i)
+		{
+			const Ogre::Vector3 axis = Ogre::Vector3( (float) (i % 3), 1, (float) (i % 5)).normalisedCopy();
+			angles[i] = 0.001f * i;
+			axes[i / TRIP_SIMD_WIDTH].x[i % TRIP_SIMD_WIDTH] = axis.x;
+			axes[i / TRIP_SIMD_WIDTH].y[i % TRIP_SIMD_WIDTH] = axis.y;
+			axes[i / TRIP_SIMD_WIDTH].z[i % TRIP_SIMD_WIDTH] = axis.z;
+		}
+
+		Ogre::Timer timer;
+		unsigned long start = 0;
+		if( ogre)
+		{
+			std::vector<Ogre::Quaternion> orientations( count, Ogre::Quaternion::IDENTITY);
+			start = timer.getMicroseconds();
+			for( uint pass = 0; pass < passes; ++pass)
+			{
+				for( uint i = 0; i < count; ++i)
+				{
+					const Vector3Batch& axis = axes[i / TRIP_SIMD_WIDTH];
+					const uint lane = i % TRIP_SIMD_WIDTH;
+					Ogre::Quaternion rotation( Ogre::Radian( angles[i]), Ogre::Vector3( axis.x[lane], axis.y[lane], axis.z[lane]));
+					rotation.normalise();
+					orientations[i] = orientations[i] * rotation;
+				}
+			}
+		}
+		else
+		{
+			const SimdMath::InstructionSet previous = SimdMath::getInstructionSet();
+			if( !SimdMath::setInstructionSet( instructionSet))
+				return 0;
+
+			std::vector<QuaternionBatch> orientations( TRIP_BENCH_MATH_BATCHES);
+			QuaternionBatch rotation;
+			for( uint b = 0; b < TRIP_BENCH_MATH_BATCHES; ++b)
+			{
+				for( uint i = 0; i < TRIP_SIMD_WIDTH; ++i)
+				{
+					orientations[b].w[i] = 1;
+					orientations[b].x[i] = orientations[b].y[i] = orientations[b].z[i] = 0;
+				}
+			}
+
+			start = timer.getMicroseconds();
+			for( uint pass = 0; pass < passes; ++pass)
+			{
+				for( uint b = 0; b < TRIP_BENCH_MATH_BATCHES; ++b)
+				{
+					SimdMath::fromAngleAxis( &angles[0] + b * TRIP_SIMD_WIDTH, axes[b], rotation);
+					SimdMath::normalise( rotation);
+					SimdMath::multiply( orientations[b], rotation, orientations[b]);
+				}
+			}
+
+			SimdMath::setInstructionSet( previous);
+		}
+
+		const unsigned long elapsed = timer.getMicroseconds() - start;
+		return elapsed * 1000.0 / ((double) passes * count);
+	}
+
+
+	/**
+	 * Checks SimdMath::sinCos() against std::sin and std::cos in double precision,
+	 * from small angles up to the large times of an application that runs for weeks.
+	 * Every power of ten from 0.01 up to 1e9 contributes TRIP_BENCH_SINCOS_ANGLES angles of both signs.
+	 * @param instructionSet The instruction set of the SimdMath to check.
+	 * @return The largest absolute error of a sine or cosine or -1 if the instruction set is not supported.
+	 */
+	double Benchmark::measureSinCosError( SimdMath::InstructionSet instructionSet)
+	{
+		const SimdMath::InstructionSet previous = SimdMath::getInstructionSet();
+		if( !SimdMath::setInstructionSet( instructionSet))
+			return -1;
+
+		std::vector<float> angles;
+		for( double magnitude = 0.01; magnitude < 1e10; magnitude *= 10)
+		{
+			for( uint i = 0; i < TRIP_BENCH_SINCOS_ANGLES; ++i)
+			{
+				const float angle = (float) (magnitude * (1 + 9.0 * i / TRIP_BENCH_SINCOS_ANGLES));
+				angles.push_back( (i % 2) ? -angle : angle);
+			}
+		}
+		angles.resize( (angles.size() + TRIP_SIMD_WIDTH - 1) / TRIP_SIMD_WIDTH * TRIP_SIMD_WIDTH, 0);
+
+		double max_error = 0;
+		float s[TRIP_SIMD_WIDTH], c[TRIP_SIMD_WIDTH];
+		for( uint b = 0; b < angles.size(); b += TRIP_SIMD_WIDTH)
+		{
+			SimdMath::sinCos( &angles[b], s, c);
+			for( uint i = 0; i < TRIP_SIMD_WIDTH; ++i)
+			{
+				const double angle = angles[b + i];
+				max_error = std::max( max_error, std::abs( s[i] - std::sin( angle)));
+				max_error = std::max( max_error, std::abs( c[i] - std::cos( angle)));
+			}
+		}
+
+		SimdMath::setInstructionSet( previous);
+		return max_error;
+	}
+
+
+	/**
+	 * Measures the evaluation of a Function on one value per Node, either value by value with fun()
+	 * or all at once with funBatch(). The inputs are phase-shifted like Nodes that share a Function,
+	 * the same TRIP_BENCH_FUNCTION_VALUES inputs are evaluated over and over again.
+	 * @param function The Function to evaluate.
+	 * @param values The number of evaluations.
+	 * @param batch TRUE to measure funBatch() instead of fun().
+	 * @return The average time per value in nanoseconds.
+	 */
+	double Benchmark::measureFunction( Function* function, uint values, bool batch)
+	{
+		const uint count = TRIP_BENCH_FUNCTION_VALUES;
+		const uint passes = std::max<uint>( 1, values / count);
+
+		std::vector<float> x( count);
+		std::vector<float> out( count);
+		for( uint i = 0; i < count; ++i)
+		{
+			x[i] = 0.5f + 0.01f * i;
+		}
+
+		Ogre::Timer timer;
+		const unsigned long start = timer.getMicroseconds();
+		for( uint pass = 0; pass < passes; ++pass)
+		{
+			if( batch)
+			{
+				function->funBatch( &x[0], &out[0], count);
+			}
+			else
+			{
+				for( uint i = 0; i < count; ++i)
+				{
+					out[i] = function->fun( x[i]);
+				}
+			}
+		}
+
+		const unsigned long elapsed = timer.getMicroseconds() - start;
+		return elapsed * 1000.0 / ((double) passes * count);
+	}
+
+
+	/**
+	 * Builds the tree below the given Cluster.
+	 * The Cluster prototype TRIP_BENCH_CLUSTER and the Transformer prototype of the settings must be registered.
+	 * @param root The Cluster below which to build the tree.
+	 * @return
+	 * TRUE - the tree was built
+	 * FALSE - a prototype is missing
+	 */
+	bool Benchmark::build( Cluster* root)
+	{
+		_cluster_count = 0;
+		return buildLevel( root, _settings.depth);
+	}
+
+
+	/**
+	 * Processes the tree with the given Engine and measures it.
+	 * @param engine The Engine to drive. Its thread count has to be set.
+	 * @return The measures of the run.
+	 */
+	Benchmark::Result Benchmark::run( Engine* engine)
+	{
+		Ogre::FrameEvent evt;
+		evt.timeSinceLastEvent = TRIP_BENCH_FRAME_TIME;
+		evt.timeSinceLastFrame = TRIP_BENCH_FRAME_TIME;
+
+		// compile the plan and let the queues grow
+		for( uint i = 0; i < _settings.warmup_frames; ++i)
+		{
+			engine->frameRenderingQueued( evt);
+			_node_store->update();
+		}
+
+		// count the applications of the compiled plan
+		double applications = 0;
+		const std::vector<ExecutionPlan::Entry>& entries = engine->getPlan().getEntries();
+		for( auto it = entries.begin(); it != entries.end(); ++it)
+		{
+			applications += (double) it->node_count * it->transformer_count;
+		}
+
+		// measure
+		Ogre::Timer timer;
+		unsigned long engine_us = 0;
+		unsigned long update_us = 0;
+		const long allocations = getAllocationCount();
+
+		for( uint i = 0; i < _settings.frames; ++i)
+		{
+			unsigned long start = timer.getMicroseconds();
+			engine->frameRenderingQueued( evt);
+			unsigned long processed = timer.getMicroseconds();
+			_node_store->update();
+			unsigned long updated = timer.getMicroseconds();
+
+			engine_us += processed - start;
+			update_us += updated - processed;
+		}
+
+		const double frames = _settings.frames > 0 ? _settings.frames : 1;
+
+		Result result;
+		result.threads = engine->getThreadCount();
+		result.ns_per_frame = engine_us * 1000.0 / frames;
+		result.ns_update_per_frame = update_us * 1000.0 / frames;
+		result.ns_per_application = applications > 0 ? result.ns_per_frame / applications : 0;
+		result.allocations_per_frame = (getAllocationCount() - allocations) / frames;
+		result.applications_per_second = result.ns_per_frame > 0 ? applications * 1000000000.0 / result.ns_per_frame : 0;
+		return result;
+	}
+
+
+	/**
+	 * Builds one level of the tree and the levels below it.
+	 * @param parent The Cluster that gets the new child Clusters.
+	 * @param depth The number of levels still to build.
+	 * @return
+	 * TRUE - the level was built
+	 * FALSE - a prototype is missing
+	 */
+	bool Benchmark::buildLevel( Cluster* parent, uint depth)
+	{
+		if( depth == 0)
+			return true;
+
+		for( uint c = 0; c < _settings.fanout; ++c)
+		{
+			Cluster* cluster = ClusterManager::instance()->createCluster( TRIP_BENCH_CLUSTER);
+			if( !cluster)
+			{
+				Trip::log( "Benchmark: the Cluster prototype " + String( TRIP_BENCH_CLUSTER) + " is not registered.", MSG_ERROR);
+				return false;
+			}
+
+			cluster->setup();
+
+			for( uint t = 0; t < _settings.transformers; ++t)
+			{
+				Transformer* transformer = TransformerManager::instance()->createTransformer( _settings.transformer);
+				if( !transformer)
+				{
+					Trip::log( "Benchmark: the Transformer prototype " + _settings.transformer + " is not registered.", MSG_ERROR);
+					delete cluster;
+					return false;
+				}
+				cluster->addTransformer( transformer);
+			}
+
+			parent->addCluster( cluster);
+			++_cluster_count;
+
+			if( !buildLevel( cluster, depth - 1))
+				return false;
+		}
+		return true;
+	}
+
+} // END namespace Trip
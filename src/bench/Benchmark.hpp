@@ -0,0 +1,296 @@
+/**
+ * This file contains the Benchmark class, which measures the Engine
+ * on synthetic Cluster-trees without a render system.
+ * @author barn
+ * @version 20121210
+ */
+#ifndef __Benchmark_HPP__
+#define __Benchmark_HPP__
+
+/*===========================================================================*
+ * INCLUDES base definition file for DLL import/export
+ *===========================================================================*/
+
+/*===========================================================================*
+ * INCLUDES project headers
+ *===========================================================================*/
+#include "stdafx.h"
+#include <clusters/Cluster.hpp>
+#include <util/SimdMath.hpp>
+
+/*===========================================================================*
+ * INCLUDES C/C++ standard library (and other external libraries)
+ *===========================================================================*/
+#include <boost/detail/atomic_count.hpp>
+
+/*===========================================================================*
+ * DEFINES and MACROS
+ *===========================================================================*/
+
+/// The name of the Cluster prototype the Benchmark builds its trees from.
+#define TRIP_BENCH_CLUSTER "Bench Cluster"
+
+/*===========================================================================*
+ * NAMESPACE, CONSTANTS and TYPE DECLARATIONS/IMPLEMENTATIONS
+ *===========================================================================*/
+
+namespace Trip
+{
+	class Engine;
+	class Function;
+	class NodeStore;
+
+	/// A Cluster that creates a fixed number of Nodes in its doSetup(). Used by the Benchmark.
+	class BenchCluster : public Trip::Cluster
+	{
+	private: // vars
+
+		/// The number of Nodes to create.
+		uint _node_count;
+
+	public: // constructor
+
+		/**
+		 * Main constructor.
+		 * @param nodeCount The number of Nodes every clone creates on setup.
+		 */
+		BenchCluster( uint nodeCount)
+			: _node_count( nodeCount)
+		{
+			setName( TRIP_BENCH_CLUSTER);
+		}
+
+		Cluster* clone()
+		{
+			return new BenchCluster( *this);
+		}
+
+	protected: // helpers
+
+		void doSetup()
+		{
+			for( uint i = 0; i < _node_count; ++i)
+			{
+				createNode( Ogre::Vector3( (float) i, 0, 0));
+			}
+		}
+	};
+
+
+	/**
+	 * The Benchmark builds a Cluster-tree of a given depth and fan-out from the registered
+	 * prototypes and measures how long the Engine needs to process it.
+	 *
+	 * Every Cluster below the root has the same number of Nodes and Transformers.
+	 * The Engine is driven through frameRenderingQueued() exactly like Ogre does it,
+	 * the NodeStore is updated after every frame and measured separately.
+	 *
+	 * Allocations are counted by countAllocation(), which the benchmark executable calls
+	 * from its global operator new. Objects that Ogre allocates with its own allocator are not counted.
+	 */
+	class Benchmark
+	{
+	public: // nested types
+
+		/// The shape of the tree and the length of a run.
+		struct Settings
+		{
+			/// The number of Cluster levels below the root.
+			uint depth;
+
+			/// The number of child Clusters of every Cluster above the deepest level.
+			uint fanout;
+
+			/// The number of Nodes per Cluster.
+			uint nodes;
+
+			/// The number of Transformers per Cluster.
+			uint transformers;
+
+			/// The name of the Transformer prototype.
+			String transformer;
+
+			/// The number of frames that are measured per run.
+			uint frames;
+
+			/// The number of frames that are processed before measuring.
+			uint warmup_frames;
+
+			/// Indicates whether the Engine processes the Transformers grouped by their type.
+			bool grouped;
+
+			/// The number of rotations per instruction set in the math benchmark, 0 to skip it.
+			uint math_rotations;
+
+			/// Indicates whether the Engine processes the thread-safe Clusters on a simulation thread.
+			bool pipelined;
+
+			/// Indicates whether the FrameProfiler measures the frames, which costs time itself.
+			bool profiled;
+
+			Settings()
+				: depth(3),
+				fanout(8),
+				nodes(100),
+				transformers(2),
+				transformer("Simple Rotator"),
+				frames(200),
+				warmup_frames(10),
+				grouped(false),
+				math_rotations(1000000),
+				pipelined(false),
+				profiled(false)
+			{}
+		};
+
+		/// The measures of one run.
+		struct Result
+		{
+			/// The number of threads of the Engine.
+			uint threads;
+
+			/// The average time of the Engine per frame, in nanoseconds.
+			double ns_per_frame;
+
+			/// The average time of the NodeStore update per frame, in nanoseconds.
+			double ns_update_per_frame;
+
+			/// The average time per application of one Transformer on one Node, in nanoseconds.
+			double ns_per_application;
+
+			/// The average number of allocations per frame, including the update.
+			double allocations_per_frame;
+
+			/// Node-Transformer applications per second.
+			double applications_per_second;
+		};
+
+	private: // class vars
+
+		/// The number of allocations counted so far.
+		static boost::detail::atomic_count __allocations;
+
+	private: // vars
+
+		/// The settings of the Benchmark.
+		Settings _settings;
+
+		/// The store of all Nodes.
+		NodeStore* _node_store;
+
+		/// The number of Clusters built below the root.
+		uint _cluster_count;
+
+	public: // constructor & destructor
+
+		/**
+		 * Main constructor.
+		 * @param settings The shape of the tree and the length of a run.
+		 * @param nodeStore The NodeStore the Engine works on. It is updated after every frame.
+		 */
+		Benchmark( const Settings& settings, NodeStore* nodeStore)
+			: _settings( settings),
+			_node_store( nodeStore),
+			_cluster_count(0)
+		{}
+
+		/**
+		 * Destructor.
+		 */
+		~Benchmark()
+		{}
+
+	public: // class methods
+
+		/**
+		 * Counts one allocation. Call it from the global operator new.
+		 */
+		static void countAllocation()
+		{
+			++__allocations;
+		}
+
+		/**
+		 * Retrieves the number of allocations counted so far.
+		 * @return The number of allocations.
+		 */
+		static long getAllocationCount()
+		{
+			return __allocations;
+		}
+
+		/**
+		 * Measures the rotation math of rotator-style Transformers: building a rotation from
+		 * an angle and an axis, normalising it and rotating an orientation with it.
+		 * @param rotations The number of rotations to compute.
+		 * @param instructionSet The instruction set of the SimdMath to use.
+		 * @param ogre TRUE to measure Ogre::Quaternion instead of the SimdMath.
+		 * @return The average time per rotation in nanoseconds or 0 if the instruction set is not supported.
+		 */
+		static double measureRotations( uint rotations, SimdMath::InstructionSet instructionSet, bool ogre);
+
+		/**
+		 * Checks SimdMath::sinCos() against std::sin and std::cos in double precision,
+		 * from small angles up to the large times of an application that runs for weeks.
+		 * @param instructionSet The instruction set of the SimdMath to check.
+		 * @return The largest absolute error of a sine or cosine or -1 if the instruction set is not supported.
+		 */
+		static double measureSinCosError( SimdMath::InstructionSet instructionSet);
+
+		/**
+		 * Measures the evaluation of a Function on one value per Node, either value by value with fun()
+		 * or all at once with funBatch(). The inputs are phase-shifted like Nodes that share a Function.
+		 * @param function The Function to evaluate.
+		 * @param values The number of evaluations.
+		 * @param batch TRUE to measure funBatch() instead of fun().
+		 * @return The average time per value in nanoseconds.
+		 */
+		static double measureFunction( Function* function, uint values, bool batch);
+
+	public: // methods
+
+		/**
+		 * Builds the tree below the given Cluster.
+		 * The Cluster prototype TRIP_BENCH_CLUSTER and the Transformer prototype of the settings must be registered.
+		 * @param root The Cluster below which to build the tree.
+		 * @return
+		 * TRUE - the tree was built
+		 * FALSE - a prototype is missing
+		 */
+		bool build( Cluster* root);
+
+		/**
+		 * Processes the tree with the given Engine and measures it.
+		 * @param engine The Engine to drive. Its thread count has to be set.
+		 * @return The measures of the run.
+		 */
+		Result run( Engine* engine);
+
+	public: // getters & setters
+
+		/**
+		 * Retrieves the number of Clusters built below the root.
+		 * @return The number of Clusters.
+		 */
+		uint getClusterCount()
+		{
+			return _cluster_count;
+		}
+
+	private: // helpers
+
+		/**
+		 * Builds one level of the tree and the levels below it.
+		 * @param parent The Cluster that gets the new child Clusters.
+		 * @param depth The number of levels still to build.
+		 * @return
+		 * TRUE - the level was built
+		 * FALSE - a prototype is missing
+		 */
+		bool buildLevel( Cluster* parent, uint depth);
+
+	}; // END class Benchmark
+
+} // END namespace Trip
+
+#endif /* __Benchmark_HPP__ */
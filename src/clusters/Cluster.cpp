@@ -1,7 +1,7 @@
 /**
  * The implementation file of the Cluster.hpp header.
  * @author barn
- * @version 20121027
+ * @version 20121210
  */
 
 /*===========================================================================*
@@ -17,6 +17,9 @@
 /*===========================================================================*
  * INCLUDES C/C++ standard library (and other external libraries)
  *===========================================================================*/
+#include <algorithm>
+#include <cmath>
+#include <limits>
 
 
 /*===========================================================================*
@@ -45,29 +48,193 @@ namespace Trip
 		}
 	}
 
+	/**
+	 * Convenience function that creates a Node and adds it to the Node List of the Cluster.
+	 * The new Node is a child of the Cluster's cluster node.
+	 * @param name The name of the Node.
+	 * @param translate Initial translation offset of child relative to parent.
+	 * @param rotate Initial rotation relative to parent.
+	 */
+	Ogre::Node* Cluster::createNode( const String& name, const Ogre::Vector3& translate, const Ogre::Quaternion& rotate)
+	{
+		Ogre::Node* ret = _node_store->createNode( name, getClusterNode(), translate, rotate);
+		_nodes.push_back( ret);
+		Engine::invalidatePlan();
+		return ret;
+	}
+
+	/**
+	 * Creates a Node and adds it to the Node List of the corresponding Cluster.
+	 * The new Node is a child of the Cluster's cluster node.
+	 * @param translate Initial translation offset of child relative to parent.
+     * @param rotate Initial rotation relative to parent.
+	 */
+	Ogre::Node* Cluster::createNode( const Ogre::Vector3& translate, const Ogre::Quaternion& rotate)
+	{
+		Ogre::Node* ret = _node_store->createNode( getClusterNode(), translate, rotate);
+		_nodes.push_back( ret);
+		Engine::invalidatePlan();
+		return ret;
+	}
+
+
 	/**
 	 * Convenience function that creates an Ogre::SceneNode and adds it to the Node List of the Cluster.
+	 * The new SceneNode is a child of the Cluster's cluster node.
+	 * Only works if the NodeStore has a SceneManager.
 	 * @param name The name of the SceneNode.
 	 * @param translate Initial translation offset of child relative to parent.
 	 * @param rotate Initial rotation relative to parent.
+	 * @return The new SceneNode or NULL, if the NodeStore does not render.
 	 */
 	Ogre::SceneNode* Cluster::createSceneNode( const String& name, const Ogre::Vector3& translate, const Ogre::Quaternion& rotate)
 	{
-		Ogre::SceneNode* ret = _scene_manager->getRootSceneNode()->createChildSceneNode( name, translate, rotate);
-		_nodes.push_back( ret);
-		return ret;
+		if( !getSceneManager())
+		{
+			Trip::log( "Cannot create the SceneNode " + name + ", the NodeStore does not render.", MSG_ERROR);
+			return 0;
+		}
+
+		// nodes of a store with a SceneManager are SceneNodes
+		return static_cast<Ogre::SceneNode*>( createNode( name, translate, rotate));
 	}
 
 	/**
 	 * Creates a Ogre::SceneNode and adds it to the Node List of the corresponding Cluster.
+	 * The new SceneNode is a child of the Cluster's cluster node.
+	 * Only works if the NodeStore has a SceneManager.
 	 * @param translate Initial translation offset of child relative to parent.
      * @param rotate Initial rotation relative to parent.
+	 * @return The new SceneNode or NULL, if the NodeStore does not render.
 	 */
 	Ogre::SceneNode* Cluster::createSceneNode( const Ogre::Vector3& translate, const Ogre::Quaternion& rotate)
 	{
-		Ogre::SceneNode* ret = _scene_manager->getRootSceneNode()->createChildSceneNode( translate, rotate);
-		_nodes.push_back( ret);
-		return ret;
+		if( !getSceneManager())
+		{
+			Trip::log( "Cannot create a SceneNode, the NodeStore does not render.", MSG_ERROR);
+			return 0;
+		}
+
+		// nodes of a store with a SceneManager are SceneNodes
+		return static_cast<Ogre::SceneNode*>( createNode( translate, rotate));
+	}
+
+
+	/**
+	 * Retrieves the cluster node of this Cluster, which is the parent of
+	 * all Nodes of this Cluster and of the cluster nodes of its child Clusters.
+	 * The cluster node will be created on the first call.
+	 * @return The Cluster's own node.
+	 */
+	Ogre::Node* Cluster::getClusterNode()
+	{
+		if( !_cluster_node)
+		{
+			_cluster_node = _node_store->createNode( 0);
+		}
+		return _cluster_node;
+	}
+
+
+	/**
+	 * Retrieves a sphere around the Nodes of this Cluster and of all its descendants, in world space.
+	 * The sphere is kept in the space of the cluster node and recomputed every
+	 * TRIP_CLUSTER_BOUNDS_REFRESH updates, so moving the cluster node costs nothing.
+	 * It includes the bounding radii of the objects attached to the Nodes, but not of
+	 * SceneNodes below the Nodes that belong to no Cluster.
+	 * It relies on the derived transforms of the last rendered frame.
+	 * @return The bounding sphere in world space.
+	 * @see ageBounds()
+	 */
+	Ogre::Sphere Cluster::getWorldBounds()
+	{
+		updateLocalBounds();
+
+		Ogre::Node* node = getClusterNode();
+		const Ogre::Vector3& scale = node->_getDerivedScale();
+		const float max_scale = std::max( std::abs( scale.x), std::max( std::abs( scale.y), std::abs( scale.z)));
+
+		const Ogre::Vector3 center = node->_getDerivedOrientation() * (scale * _bounds_center) + node->_getDerivedPosition();
+		return Ogre::Sphere( center, _bounds_radius * max_scale);
+	}
+
+
+	/**
+	 * Recomputes the bounding sphere in the space of the cluster node, if it is outdated.
+	 * The center is the middle of the box around all Node origins and child spheres,
+	 * the radius reaches the farthest attached object or child sphere. Without a renderer,
+	 * Nodes have no attached objects and reach TRIP_CLUSTER_BOUNDS_PADDING beyond their origins.
+	 */
+	void Cluster::updateLocalBounds()
+	{
+		if( _bounds_age < TRIP_CLUSTER_BOUNDS_REFRESH)
+			return;
+
+		_bounds_age = 0;
+		if( _nodes.empty() && _clusters.empty())
+		{
+			_bounds_center = Ogre::Vector3::ZERO;
+			_bounds_radius = _node_store->getSceneManager() ? 0 : TRIP_CLUSTER_BOUNDS_PADDING;
+			return;
+		}
+
+		// the box around the Node origins and the child Cluster origins
+		Ogre::Vector3 min_corner( std::numeric_limits<float>::max());
+		Ogre::Vector3 max_corner( -std::numeric_limits<float>::max());
+		for( auto it = _nodes.begin(); it != _nodes.end(); ++it)
+		{
+			min_corner.makeFloor( (*it)->getPosition());
+			max_corner.makeCeil( (*it)->getPosition());
+		}
+		for( auto it = _clusters.begin(); it != _clusters.end(); ++it)
+		{
+			min_corner.makeFloor( (*it)->getClusterNode()->getPosition());
+			max_corner.makeCeil( (*it)->getClusterNode()->getPosition());
+		}
+		_bounds_center = (min_corner + max_corner) * 0.5f;
+
+		// the farthest attached object or child sphere
+		float radius = 0;
+		for( auto it = _nodes.begin(); it != _nodes.end(); ++it)
+		{
+			radius = std::max( radius, (*it)->getPosition().distance( _bounds_center) + getNodeExtent( *it));
+		}
+		for( auto it = _clusters.begin(); it != _clusters.end(); ++it)
+		{
+			Cluster* child = *it;
+			child->updateLocalBounds();
+
+			Ogre::Node* node = child->getClusterNode();
+			const Ogre::Vector3& scale = node->getScale();
+			const float max_scale = std::max( std::abs( scale.x), std::max( std::abs( scale.y), std::abs( scale.z)));
+			const Ogre::Vector3 child_center = node->getOrientation() * (scale * child->_bounds_center) + node->getPosition();
+			radius = std::max( radius, child_center.distance( _bounds_center) + child->_bounds_radius * max_scale);
+		}
+		_bounds_radius = radius;
+	}
+
+
+	/**
+	 * Retrieves how far a Node's attached objects reach beyond its origin.
+	 * @param node A Node of this Cluster.
+	 * @return The largest bounding radius of the attached objects, scaled like the Node,
+	 * or TRIP_CLUSTER_BOUNDS_PADDING if the NodeStore does not render.
+	 */
+	float Cluster::getNodeExtent( Ogre::Node* node)
+	{
+		// only rendering stores create SceneNodes
+		if( !_node_store->getSceneManager())
+			return TRIP_CLUSTER_BOUNDS_PADDING;
+
+		Ogre::SceneNode* scene_node = static_cast<Ogre::SceneNode*>( node);
+		float extent = 0;
+		for( unsigned short i = 0; i < scene_node->numAttachedObjects(); ++i)
+		{
+			extent = std::max( extent, scene_node->getAttachedObject( i)->getBoundingRadius());
+		}
+
+		const Ogre::Vector3& scale = node->getScale();
+		return extent * std::max( std::abs( scale.x), std::max( std::abs( scale.y), std::abs( scale.z)));
 	}
 
 
@@ -76,13 +243,96 @@ namespace Trip
 	 */
 	void Cluster::clearAllNodes()
 	{
+		// before destroying, since the Nodes might be blended
+		Engine::invalidatePlan();
+
 		for( auto it = _nodes.begin(); it != _nodes.end(); ++it)
 		{
-			delete *it;
+			_node_store->destroyNode( *it);
 		}
 		_nodes.clear();
 	}
 
+	/**
+	 * Sets whether this Cluster is enabled or not.
+	 * Disabled Clusters and their children will not be processed by the Engine.
+	 * The active Transformers of a disabled Cluster's subtree do not count for its ancestors.
+	 * @param enabled
+	 * TRUE - enabled
+	 * FALSE - disabled
+	 */
+	void Cluster::setEnabled( bool enabled)
+	{
+		const bool was_enabled = _enabled;
+		Fadeable::setEnabled( enabled);
+		Engine::invalidatePlan();
+
+		if( _parent && was_enabled != _enabled)
+		{
+			_parent->changeSubtreeTransformers( _enabled ? (int) _subtree_transformers : -(int) _subtree_transformers);
+		}
+	}
+
+
+	/**
+	 * Adds a Cluster to this Cluster.
+	 * Also attaches the Cluster's cluster node to the cluster node of this Cluster.
+	 * A Cluster that is a child of another Cluster will be removed from it first.
+	 * @param cluster The new cluster to add.
+	 */
+	void Cluster::addCluster( Cluster* cluster)
+	{
+		if( cluster->_parent)
+		{
+			cluster->_parent->removeCluster( cluster);
+		}
+
+		Ogre::Node* node = cluster->getClusterNode();
+		if( node->getParent())
+		{
+			node->getParent()->removeChild( node);
+		}
+		getClusterNode()->addChild( node);
+
+		_clusters.push_back( cluster);
+		cluster->_parent = this;
+		if( cluster->isEnabled())
+		{
+			changeSubtreeTransformers( cluster->_subtree_transformers);
+		}
+		Engine::invalidatePlan();
+	}
+
+
+	/**
+	 * Removes the given cluster from the child list, but doesnt call its destrutor.
+	 * Also detaches the Cluster's cluster node from the cluster node of this Cluster.
+	 * Linear complexity.
+	 * @param cluster The Cluster to remove from the child Cluster list.
+	 * If that particular value is not in the list, nothing happens.
+	 */
+	void Cluster::removeCluster( Cluster* cluster)
+	{
+		Ogre::Node* node = cluster->getClusterNode();
+		if( node->getParent() == _cluster_node)
+		{
+			_cluster_node->removeChild( node);
+		}
+
+		if( cluster->_parent == this)
+		{
+			cluster->_parent = 0;
+			if( cluster->isEnabled())
+			{
+				changeSubtreeTransformers( -(int) cluster->_subtree_transformers);
+			}
+		}
+
+		_clusters.remove( cluster);
+		Engine::invalidatePlan();
+	}
+
+
 	/**
 	 * Retrieves a child Cluster from the given position. Linear complexity.
 	 * @return A Cluster or NULL if there is no cluster at a given position.
@@ -126,7 +376,7 @@ namespace Trip
 		}
 
 		Cluster* cluster = *it;
-		_clusters.remove( *it);
+		removeCluster( cluster);
 		return cluster;
 	}
 
@@ -147,6 +397,7 @@ namespace Trip
 		{
 			_transformers.insert( _transformers.begin() + pos, transformer);
 		}
+		attachTransformer( transformer);
 	}
 
 
@@ -166,6 +417,7 @@ namespace Trip
 		auto ptr = _transformers.begin() + pos;
 		Transformer* transformer = *ptr;
 		_transformers.erase( ptr);
+		detachTransformer( transformer);
 		return transformer;
 	}
 
@@ -183,6 +435,7 @@ namespace Trip
 			{
 				Transformer* transformer = *it;
 				_transformers.erase( it);
+				detachTransformer( transformer);
 				break;
 			}
 		}
@@ -199,6 +452,68 @@ namespace Trip
 			delete *it;
 		}
 		_transformers.clear();
+		changeActiveTransformers( -(int) _active_transformers);
+		Engine::invalidatePlan();
+	}
+
+
+	/**
+	 * Adjusts the number of active Transformers of this Cluster and of its subtree counts.
+	 * Called by the Transformers of this Cluster when they become active or inactive.
+	 * @param delta The change of the number of active Transformers.
+	 */
+	void Cluster::changeActiveTransformers( int delta)
+	{
+		_active_transformers += delta;
+		changeSubtreeTransformers( delta);
+	}
+
+
+	/**
+	 * Adjusts the subtree counts of this Cluster and, if it is enabled, of its ancestors.
+	 * A disabled Cluster stops the propagation, since its subtree does not count for its ancestors.
+	 * @param delta The change of the number of active Transformers in the subtree.
+	 */
+	void Cluster::changeSubtreeTransformers( int delta)
+	{
+		Cluster* cluster = this;
+		while( cluster && delta != 0)
+		{
+			cluster->_subtree_transformers += delta;
+			if( !cluster->_enabled)
+				break;
+			cluster = cluster->_parent;
+		}
+	}
+
+
+	/**
+	 * Attaches an added Transformer to this Cluster and counts it, if it is active.
+	 * @param transformer The Transformer that has been added.
+	 */
+	void Cluster::attachTransformer( Transformer* transformer)
+	{
+		transformer->setCluster( this);
+		if( transformer->isActive())
+		{
+			changeActiveTransformers( 1);
+		}
+		Engine::invalidatePlan();
+	}
+
+
+	/**
+	 * Detaches a removed Transformer from this Cluster and uncounts it, if it is active.
+	 * @param transformer The Transformer that has been removed.
+	 */
+	void Cluster::detachTransformer( Transformer* transformer)
+	{
+		transformer->setCluster( 0);
+		if( transformer->isActive())
+		{
+			changeActiveTransformers( -1);
+		}
+		Engine::invalidatePlan();
 	}
 
 
@@ -208,7 +523,11 @@ namespace Trip
 	 */
 	void Cluster::createCluster( const String& name)
 	{
-		_clusters.push_back( Trip::ClusterManager::instance()->createCluster( name));
+		Cluster* cluster = Trip::ClusterManager::instance()->createCluster( name);
+		if( cluster)
+		{
+			addCluster( cluster);
+		}
 	}
 
 
@@ -1,7 +1,7 @@
 /**
  * This file contains the class Cluster, which encapsulates the geometry of the rendered scene.
  * @author barn
- * @version 20121027
+ * @version 20121210
  */
 #ifndef __Cluster_HPP__
 #define __Cluster_HPP__
@@ -15,7 +15,9 @@
  *===========================================================================*/
 #include "stdafx.h"
 #include <Fadeable.hpp>
+#include <Engine.hpp>
 #include <managers/TripVarManager.hpp>
+#include <stores/NodeStore.hpp>
 #include <transformers/Transformer.hpp>
 
 
@@ -26,6 +28,15 @@
 /*===========================================================================*
  * DEFINES and MACROS
  *===========================================================================*/
+
+/// The distance the bounds of a Cluster reach beyond the origins of Nodes without a renderer, in the space of the cluster node.
+#define TRIP_CLUSTER_BOUNDS_PADDING 10.0f
+
+/// The number of updates after which the bounds of a Cluster are recomputed.
+#define TRIP_CLUSTER_BOUNDS_REFRESH 4
+
+/// The default priority of a Cluster, the first to be slowed down when the frame budget is exceeded.
+#define TRIP_CLUSTER_PRIORITY 0
  
 /*===========================================================================*
  * NAMESPACE, CONSTANTS and TYPE DECLARATIONS/IMPLEMENTATIONS
@@ -35,8 +46,8 @@ namespace Trip
 {
 	class Cluster;
 
-	/// A list of SceneNodes
-	typedef std::list< Ogre::SceneNode*> NodeList;
+	/// A list of Nodes
+	typedef std::list< Ogre::Node*> NodeList;
 
 	/// A list of Clusters
 	typedef std::list< Cluster*> ClusterList;
@@ -50,6 +61,20 @@ namespace Trip
 	 * It contains of (almost) all the Nodes, Entities and so on that you want to have in your scene.
 	 * You are able to combine several Cluster instances in order to create more complex scenes through its 
 	 * compositor abilities. Cluster objects manage several Ogre::Nodes and other Clusters.
+	 *
+	 * Every Cluster owns a cluster node, which is the parent of all its Nodes and of the
+	 * cluster nodes of its child Clusters. The Transformers of a Cluster are applied to its Nodes
+	 * and to the cluster nodes of its child Clusters, so that the node hierarchy
+	 * propagates them to all descendants.
+	 *
+	 * Every Cluster counts its active Transformers and those of its enabled descendants.
+	 * The counts are updated whenever a Transformer or Cluster is added, removed, enabled,
+	 * disabled or its influence drops to 0, so the Engine can skip static subtrees
+	 * without visiting them.
+	 *
+	 * All Nodes are created and destroyed by the NodeStore of the Cluster. Use createNode()
+	 * for Nodes that are only transformed. Use createSceneNode() for Nodes that carry renderable
+	 * objects, but be aware that it only works if the NodeStore has a SceneManager.
 	 * 
 	 * In general, you should not create the Clusters manually, but
 	 * use the ClusterManager, that uses the Prototype pattern to create Clusters
@@ -77,7 +102,11 @@ namespace Trip
 	
 	protected: // vars
 
-		Ogre::SceneManager* _scene_manager;
+		/// The store that creates and destroys the Nodes of this Cluster.
+		NodeStore* _node_store;
+
+		/// The parent node of all Nodes and child Cluster nodes. Created on demand.
+		Ogre::Node* _cluster_node;
 
 		/// The name of this Cluster.
 		String _name;
@@ -94,31 +123,110 @@ namespace Trip
 		/// All Transformers that will be applied on the Nodes of the NodeGroups.
 		TransformerVector _transformers;
 
+		/// The Cluster this Cluster is a child of or NULL.
+		Cluster* _parent;
+
+		/// The number of active Transformers of this Cluster.
+		uint _active_transformers;
+
+		/// The number of active Transformers of this Cluster and all its enabled descendants.
+		uint _subtree_transformers;
+
+		/// The time of the frames in which the Transformers of this Cluster have not been applied.
+		float _deferred_time;
+
+		/// The center of the bounding sphere of the subtree in the space of the cluster node.
+		Ogre::Vector3 _bounds_center;
+
+		/// The radius of the bounding sphere of the subtree in the space of the cluster node.
+		float _bounds_radius;
+
+		/// The number of updates since the bounds were computed.
+		uint _bounds_age;
+
+		/// The number of degradation levels this Cluster is spared from, see LodPolicy.
+		uint _priority;
+
 
 	public: // constructor & destructor
 
 		/**
 		 * Main Constructor.
+		 * Uses the NodeStore of the TripVarManager.
 		 */
 		Cluster()
 			: _name("zero"),
-			_scene_manager( TripVarManager::instance()->getSceneManager())
+			_node_store( TripVarManager::instance()->getNodeStore()),
+			_cluster_node(0),
+			_parent(0),
+			_active_transformers(0),
+			_subtree_transformers(0),
+			_deferred_time(0),
+			_bounds_center( Ogre::Vector3::ZERO),
+			_bounds_radius(0),
+			_bounds_age( TRIP_CLUSTER_BOUNDS_REFRESH),
+			_priority( TRIP_CLUSTER_PRIORITY)
 		{}
 
 		/**
 		 * 2nd Constructor.
+		 * @param nodeStore The store that creates the Nodes of this Cluster.
 		 */
-		Cluster( Ogre::SceneManager* sceneManager)
+		Cluster( NodeStore* nodeStore)
 			: _name("zero"),
-			_scene_manager( sceneManager)
+			_node_store( nodeStore),
+			_cluster_node(0),
+			_parent(0),
+			_active_transformers(0),
+			_subtree_transformers(0),
+			_deferred_time(0),
+			_bounds_center( Ogre::Vector3::ZERO),
+			_bounds_radius(0),
+			_bounds_age( TRIP_CLUSTER_BOUNDS_REFRESH),
+			_priority( TRIP_CLUSTER_PRIORITY)
 		{}
 
 		/**
 		 * 3rd Constructor.
+		 * @param nodeStore The store that creates the Nodes of this Cluster.
+		 * @param name The name of the Cluster.
 		 */
-		Cluster( Ogre::SceneManager* sceneManager, const String& name)
+		Cluster( NodeStore* nodeStore, const String& name)
 			: _name(name),
-			_scene_manager( sceneManager)
+			_node_store( nodeStore),
+			_cluster_node(0),
+			_parent(0),
+			_active_transformers(0),
+			_subtree_transformers(0),
+			_deferred_time(0),
+			_bounds_center( Ogre::Vector3::ZERO),
+			_bounds_radius(0),
+			_bounds_age( TRIP_CLUSTER_BOUNDS_REFRESH),
+			_priority( TRIP_CLUSTER_PRIORITY)
+		{}
+
+		/**
+		 * Copy Constructor.
+		 * The copy gets its own cluster node, which will be created on demand,
+		 * and is not attached to any parent.
+		 */
+		Cluster( const Cluster& other)
+			: Fadeable( other),
+			_node_store( other._node_store),
+			_cluster_node(0),
+			_name( other._name),
+			_clusters( other._clusters),
+			_nodes( other._nodes),
+			_material( other._material),
+			_transformers( other._transformers),
+			_parent(0),
+			_active_transformers( other._active_transformers),
+			_subtree_transformers( other._subtree_transformers),
+			_deferred_time(0),
+			_bounds_center( Ogre::Vector3::ZERO),
+			_bounds_radius(0),
+			_bounds_age( TRIP_CLUSTER_BOUNDS_REFRESH),
+			_priority( other._priority)
 		{}
 
 		/**
@@ -127,9 +235,12 @@ namespace Trip
 		 */
 		~Cluster()
 		{
+			Engine::invalidatePlan();
+
 			// delete Clusters
 			for( auto it = _clusters.begin(); it != _clusters.end(); ++it)
 			{
+				(*it)->_parent = 0;
 				delete *it;
 			}
 			_clusters.clear();
@@ -137,10 +248,17 @@ namespace Trip
 			// delete Nodes
 			for( auto it = _nodes.begin(); it != _nodes.end(); ++it)
 			{
-				_scene_manager->destroySceneNode( *it);
+				_node_store->destroyNode( *it);
 			}
 			_nodes.clear();
 
+			// delete the Cluster's own node
+			if( _cluster_node)
+			{
+				_node_store->destroyNode( _cluster_node);
+				_cluster_node = 0;
+			}
+
 			// delete Transformers
 			for( auto it = _transformers.begin(); it != _transformers.end(); ++it)
 			{
@@ -167,18 +285,37 @@ namespace Trip
 		 */
 		void setup();
 
+		/**
+		 * Creates a Node and adds it to the Node List of the corresponding Cluster.
+		 * @param name The name of the Node.
+		 * @param translate Initial translation offset of child relative to parent.
+         * @param rotate Initial rotation relative to parent.
+		 */
+		Ogre::Node* createNode( const String& name, const Ogre::Vector3& translate = Ogre::Vector3::ZERO, const Ogre::Quaternion& rotate = Ogre::Quaternion::IDENTITY);
+
+		/**
+		 * Creates a Node and adds it to the Node List of the corresponding Cluster.
+		 * @param translate Initial translation offset of child relative to parent.
+         * @param rotate Initial rotation relative to parent.
+		 */
+		Ogre::Node* createNode( const Ogre::Vector3& translate = Ogre::Vector3::ZERO, const Ogre::Quaternion& rotate = Ogre::Quaternion::IDENTITY);
+
 		/**
 		 * Creates a Ogre::SceneNode and adds it to the Node List of the corresponding Cluster.
+		 * Only works if the NodeStore has a SceneManager.
 		 * @param name The name of the SceneNode.
 		 * @param translate Initial translation offset of child relative to parent.
          * @param rotate Initial rotation relative to parent.
+		 * @return The new SceneNode or NULL, if the NodeStore does not render.
 		 */
 		Ogre::SceneNode* createSceneNode( const String& name, const Ogre::Vector3& translate = Ogre::Vector3::ZERO, const Ogre::Quaternion& rotate = Ogre::Quaternion::IDENTITY);
 
 		/**
 		 * Creates a Ogre::SceneNode and adds it to the Node List of the corresponding Cluster.
+		 * Only works if the NodeStore has a SceneManager.
 		 * @param translate Initial translation offset of child relative to parent.
          * @param rotate Initial rotation relative to parent.
+		 * @return The new SceneNode or NULL, if the NodeStore does not render.
 		 */
 		Ogre::SceneNode* createSceneNode( const Ogre::Vector3& translate = Ogre::Vector3::ZERO, const Ogre::Quaternion& rotate = Ogre::Quaternion::IDENTITY);
 
@@ -190,6 +327,37 @@ namespace Trip
 
 	public: // getters & setters
 
+		/**
+		 * Sets whether this Cluster is enabled or not.
+		 * Disabled Clusters and their children will not be processed by the Engine.
+		 * @param enabled
+		 * TRUE - enabled
+		 * FALSE - disabled
+		 */
+		void setEnabled( bool enabled);
+
+
+		/**
+		 * Sets the priority of this Cluster.
+		 * When the Engine exceeds its frame budget, Clusters of low priority are updated
+		 * less often first. A Cluster of priority p keeps its rate for the first p degradation levels.
+		 * @param priority The priority, TRIP_CLUSTER_PRIORITY by default.
+		 */
+		void setPriority( uint priority)
+		{
+			_priority = priority;
+		}
+
+
+		/**
+		 * Retrieves the priority of this Cluster.
+		 * @return The number of degradation levels this Cluster is spared from.
+		 */
+		uint getPriority()
+		{
+			return _priority;
+		}
+
 
 		/**
 		 * This function sets the name of this particular Cluster.
@@ -211,6 +379,35 @@ namespace Trip
 		}
 
 
+		/**
+		 * Retrieves the cluster node of this Cluster, which is the parent of
+		 * all Nodes of this Cluster and of the cluster nodes of its child Clusters.
+		 * The cluster node will be created on the first call.
+		 * @return The Cluster's own node.
+		 */
+		Ogre::Node* getClusterNode();
+
+
+		/**
+		 * Retrieves the NodeStore that creates the Nodes of this Cluster.
+		 * @return The NodeStore.
+		 */
+		NodeStore* getNodeStore()
+		{
+			return _node_store;
+		}
+
+
+		/**
+		 * Retrieves the SceneManager of the NodeStore, which you can use to create renderable objects.
+		 * @return The SceneManager or NULL, if the NodeStore does not render.
+		 */
+		Ogre::SceneManager* getSceneManager()
+		{
+			return _node_store->getSceneManager();
+		}
+
+
 		/**
 		 * Retrieves the list of nodes that are direct within this Cluster.
 		 * @return the List of Ogre::Nodes that belong to this Cluster.
@@ -229,12 +426,10 @@ namespace Trip
 
 		/**
 		 * Adds a Cluster to this Cluster.
+		 * Also attaches the Cluster's cluster node to the cluster node of this Cluster.
 		 * @param cluster The new cluster to add.
 		 */
-		void addCluster( Cluster* cluster)
-		{
-			_clusters.push_back( cluster);
-		}
+		void addCluster( Cluster* cluster);
 		
 		
 		/**
@@ -276,14 +471,12 @@ namespace Trip
 		
 		/**
 		 * Removes the given cluster from the child list, but doesnt call its destrutor.
+		 * Also detaches the Cluster's cluster node from the cluster node of this Cluster.
 		 * Linear complexity.
 		 * @param cluster The Cluster to remove from the child Cluster list.
 		 * If that particular value is not in the list, nothing happens.
 		 */
-		void removeCluster( Cluster* cluster)
-		{
-			_clusters.remove( cluster);
-		}
+		void removeCluster( Cluster* cluster);
 		
 
 		/**
@@ -293,6 +486,7 @@ namespace Trip
 		void addTransformer( Transformer* transformer)
 		{
 			_transformers.push_back( transformer);
+			attachTransformer( transformer);
 		}
 
 		/**
@@ -374,18 +568,132 @@ namespace Trip
 			return _material;
 		}
 
+		/**
+		 * Retrieves the parent Cluster.
+		 * @return The Cluster this Cluster is a child of or NULL.
+		 */
+		Cluster* getParent()
+		{
+			return _parent;
+		}
+
+		/**
+		 * Retrieves the number of active Transformers of this Cluster.
+		 * @return The number of enabled Transformers with an influence greater than 0.
+		 * @see Transformer::isActive()
+		 */
+		uint getActiveTransformerCount()
+		{
+			return _active_transformers;
+		}
+
+		/**
+		 * Retrieves the number of active Transformers of this Cluster and all its enabled descendants.
+		 * If it is 0, nothing within the subtree changes. Constant complexity.
+		 * @return The number of active Transformers in the subtree.
+		 */
+		uint getSubtreeTransformerCount()
+		{
+			return _subtree_transformers;
+		}
+
+		/**
+		 * Adjusts the number of active Transformers of this Cluster and of its subtree counts.
+		 * Called by the Transformers of this Cluster when they become active or inactive.
+		 * @param delta The change of the number of active Transformers.
+		 */
+		void changeActiveTransformers( int delta);
+
+		/**
+		 * Remembers the time of a frame in which the Transformers of this Cluster are not applied,
+		 * e.g. because the Cluster is far away. The time is caught up with the next update.
+		 * @param tlc The time of the skipped frame.
+		 * @see takeDeferredTime()
+		 */
+		void deferTime( float tlc)
+		{
+			_deferred_time += tlc;
+		}
+
+		/**
+		 * Retrieves the time of all frames skipped since the last update and forgets it.
+		 * @return The deferred time in seconds.
+		 */
+		float takeDeferredTime()
+		{
+			const float time = _deferred_time;
+			_deferred_time = 0;
+			return time;
+		}
+
+		/**
+		 * Retrieves a sphere around the Nodes of this Cluster and of all its descendants, in world space.
+		 * The sphere is kept in the space of the cluster node and recomputed every
+		 * TRIP_CLUSTER_BOUNDS_REFRESH updates, so moving the cluster node costs nothing.
+		 * It includes the bounding radii of the objects attached to the Nodes, but not of
+		 * SceneNodes below the Nodes that belong to no Cluster.
+		 * It relies on the derived transforms of the last rendered frame.
+		 * @return The bounding sphere in world space.
+		 * @see ageBounds()
+		 */
+		Ogre::Sphere getWorldBounds();
+
+		/**
+		 * Counts an update of this Cluster's Transformers, which may have moved its Nodes.
+		 * Outdated bounds are recomputed by the next call of getWorldBounds().
+		 * @param catchUp TRUE if the update catches up deferred frames. Its Nodes may have
+		 * moved a lot, so the bounds are outdated right away.
+		 */
+		void ageBounds( bool catchUp)
+		{
+			_bounds_age = catchUp ? TRIP_CLUSTER_BOUNDS_REFRESH : _bounds_age + 1;
+		}
+
 		
 	protected: // helpers
 
+		/**
+		 * Adjusts the subtree counts of this Cluster and, if it is enabled, of its ancestors.
+		 * @param delta The change of the number of active Transformers in the subtree.
+		 */
+		void changeSubtreeTransformers( int delta);
+
+		/**
+		 * Recomputes the bounding sphere in the space of the cluster node, if it is outdated.
+		 * Includes the bounds of the child Clusters.
+		 */
+		void updateLocalBounds();
+
+		/**
+		 * Retrieves how far a Node's attached objects reach beyond its origin.
+		 * @param node A Node of this Cluster.
+		 * @return The largest bounding radius of the attached objects, scaled like the Node,
+		 * or TRIP_CLUSTER_BOUNDS_PADDING if the NodeStore does not render.
+		 */
+		float getNodeExtent( Ogre::Node* node);
+
+		/**
+		 * Attaches an added Transformer to this Cluster and counts it, if it is active.
+		 * @param transformer The Transformer that has been added.
+		 */
+		void attachTransformer( Transformer* transformer);
+
+		/**
+		 * Detaches a removed Transformer from this Cluster and uncounts it, if it is active.
+		 * @param transformer The Transformer that has been removed.
+		 */
+		void detachTransformer( Transformer* transformer);
+
 		/**
 		 * Creates all the stuff the particular Cluster contains.
 		 * Build your scene nodes here, attach them to the NodeList,
 		 * Generate internal Clusters here and add them to the ClusterList.
 		 * Do not call create on the internal Clusters, 
 		 * that will be done externally by the setup() method of this object.
-		 * Feel free to use the helper methods createSceneNode() and createCluster().
+		 * Feel free to use the helper methods createNode(), createSceneNode() and createCluster().
 		 *
 		 * @see setup()
+		 * @see createNode()
 		 * @see createSceneNode()
 		 * @see createCluster()
 		 */
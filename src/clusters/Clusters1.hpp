@@ -59,8 +59,15 @@ namespace Trip
 
 		void doSetup()
 		{
+			// without a render system, the Schnecki is just a Node
+			if( !getSceneManager())
+			{
+				createNode();
+				return;
+			}
+
 			Ogre::SceneNode* schnecknode = createSceneNode();
-			Ogre::Entity* schnecke = _scene_manager->createEntity( "3dschnecki.mesh");
+			Ogre::Entity* schnecke = getSceneManager()->createEntity( "3dschnecki.mesh");
 			schnecknode->attachObject(schnecke);
 		}
 	};
@@ -0,0 +1,251 @@
+/**
+ * This file contains curves that are composed at compile time and the CurveFunction,
+ * which registers such a composite as a Function.
+ * @author barn
+ * @version 20121209
+ */
+#ifndef __CurveFunction_HPP__
+#define __CurveFunction_HPP__
+
+/*===========================================================================*
+ * INCLUDES base definition file for DLL import/export
+ *===========================================================================*/
+
+/*===========================================================================*
+ * INCLUDES project headers
+ *===========================================================================*/
+#include "stdafx.h"
+#include "Function.hpp"
+
+/*===========================================================================*
+ * INCLUDES C/C++ standard library (and other external libraries)
+ *===========================================================================*/
+#include <algorithm>
+#include <cmath>
+
+/*===========================================================================*
+ * DEFINES and MACROS
+ *===========================================================================*/
+
+/*===========================================================================*
+ * NAMESPACE, CONSTANTS and TYPE DECLARATIONS/IMPLEMENTATIONS
+ *===========================================================================*/
+
+namespace Trip
+{
+	/**
+	 * Curves are small value types with an inline "float operator()( float x) const".
+	 * The templates compose them into new curves, e.g. Product< Stretch<Sine>, Stretch<Exp> >
+	 * for sin( 3x) * exp( -x), which the compiler inlines into a single expression:
+	 * there are no virtual calls and no allocations per level.
+	 * The lower case functions build the composites without spelling out their types.
+	 * Wrap the finished curve into a CurveFunction to use it as a Function.
+	 */
+	namespace Curves
+	{
+
+		/// f(x) = x
+		struct Lin
+		{
+			float operator()( float x) const { return x; }
+		};
+
+		/// f(x) = k
+		struct Constant
+		{
+			float k;
+			Constant( float value = 0) : k( value) {}
+			float operator()( float x) const { return k; }
+		};
+
+		/// f(x) = sin( x)
+		struct Sine
+		{
+			float operator()( float x) const { return std::sin( x); }
+		};
+
+		/// f(x) = cos( x)
+		struct Cosine
+		{
+			float operator()( float x) const { return std::cos( x); }
+		};
+
+		/// f(x) = exp( x)
+		struct Exp
+		{
+			float operator()( float x) const { return std::exp( x); }
+		};
+
+		/// f(x) = |x|
+		struct Abs
+		{
+			float operator()( float x) const { return std::fabs( x); }
+		};
+
+
+		/// f(x) = factor * F(x)
+		template< class F>
+		struct Scale
+		{
+			F f;
+			float factor;
+			Scale( float factor = 1, const F& f = F()) : f( f), factor( factor) {}
+			float operator()( float x) const { return factor * f( x); }
+		};
+
+		/// f(x) = F(x) + offset
+		template< class F>
+		struct Offset
+		{
+			F f;
+			float offset;
+			Offset( float offset = 0, const F& f = F()) : f( f), offset( offset) {}
+			float operator()( float x) const { return f( x) + offset; }
+		};
+
+		/// f(x) = F(factor * x)
+		template< class F>
+		struct Stretch
+		{
+			F f;
+			float factor;
+			Stretch( float factor = 1, const F& f = F()) : f( f), factor( factor) {}
+			float operator()( float x) const { return f( factor * x); }
+		};
+
+		/// f(x) = F(x + shift)
+		template< class F>
+		struct Shift
+		{
+			F f;
+			float shift;
+			Shift( float shift = 0, const F& f = F()) : f( f), shift( shift) {}
+			float operator()( float x) const { return f( x + shift); }
+		};
+
+		/// f(x) = min( max( F(x), low), high)
+		template< class F>
+		struct Clamp
+		{
+			F f;
+			float low;
+			float high;
+			Clamp( float low = 0, float high = 1, const F& f = F()) : f( f), low( low), high( high) {}
+			float operator()( float x) const { return std::min( std::max( f( x), low), high); }
+		};
+
+		/// f(x) = F(G(x))
+		template< class F, class G>
+		struct Compose
+		{
+			F f;
+			G g;
+			Compose( const F& f = F(), const G& g = G()) : f( f), g( g) {}
+			float operator()( float x) const { return f( g( x)); }
+		};
+
+		/// f(x) = F(x) + G(x)
+		template< class F, class G>
+		struct Sum
+		{
+			F f;
+			G g;
+			Sum( const F& f = F(), const G& g = G()) : f( f), g( g) {}
+			float operator()( float x) const { return f( x) + g( x); }
+		};
+
+		/// f(x) = F(x) * G(x)
+		template< class F, class G>
+		struct Product
+		{
+			F f;
+			G g;
+			Product( const F& f = F(), const G& g = G()) : f( f), g( g) {}
+			float operator()( float x) const { return f( x) * g( x); }
+		};
+
+
+		template< class F> Scale<F> scale( float factor, const F& f) { return Scale<F>( factor, f); }
+		template< class F> Offset<F> offset( float offset, const F& f) { return Offset<F>( offset, f); }
+		template< class F> Stretch<F> stretch( float factor, const F& f) { return Stretch<F>( factor, f); }
+		template< class F> Shift<F> shift( float shift, const F& f) { return Shift<F>( shift, f); }
+		template< class F> Clamp<F> clamp( float low, float high, const F& f) { return Clamp<F>( low, high, f); }
+		template< class F, class G> Compose<F, G> compose( const F& f, const G& g) { return Compose<F, G>( f, g); }
+		template< class F, class G> Sum<F, G> sum( const F& f, const G& g) { return Sum<F, G>( f, g); }
+		template< class F, class G> Product<F, G> product( const F& f, const G& g) { return Product<F, G>( f, g); }
+
+	} // END namespace Curves
+
+
+	/**
+	 * The CurveFunction adapts a curve of the Curves namespace to the Function interface,
+	 * so it can be registered with the FunctionManager as a prototype.
+	 * Evaluating it costs one virtual call for the whole curve, doFunBatch() none per value.
+	 * @see makeCurveFunction()
+	 */
+	template< class F>
+	class CurveFunction : public Function
+	{
+	private: // vars
+
+		/// The curve.
+		F _curve;
+
+	public: // constructor
+
+		/**
+		 * Main constructor.
+		 * @param curve The curve to evaluate.
+		 */
+		CurveFunction( const F& curve = F())
+			: _curve( curve)
+		{}
+
+	public: // methods
+
+		Function* clone()
+		{
+			return new CurveFunction( *this);
+		}
+
+		/**
+		 * Retrieves the curve.
+		 * @return The curve the Function evaluates.
+		 */
+		const F& getCurve()
+		{
+			return _curve;
+		}
+
+	protected: // overridden methods
+
+		float doFun( float x)
+		{
+			return _curve( x);
+		}
+
+		void doFunBatch( const float* x, float* out, size_t n)
+		{
+			for( size_t i = 0; i < n; ++i)
+			{
+				out[i] = _curve( x[i]);
+			}
+		}
+
+	}; // END class CurveFunction
+
+
+	/**
+	 * Creates a CurveFunction without spelling out the type of the curve.
+	 * @param curve The curve, e.g. Curves::product( Curves::stretch( 3, Curves::Sine()), Curves::stretch( -1, Curves::Exp())).
+	 * @return A new Function that evaluates the curve.
+	 */
+	template< class F>
+	Function* makeCurveFunction( const F& curve)
+	{
+		return new CurveFunction<F>( curve);
+	}
+
+} // END namespace Trip
+
+#endif /* __CurveFunction_HPP__ */
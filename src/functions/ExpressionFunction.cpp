@@ -0,0 +1,742 @@
+/**
+ * Implementation file for the ExpressionFunction.hpp.
+ * Contains the parser, the constant folding and the bytecode interpreter.
+ * @author barn
+ * @version 20121208
+ */
+
+/*===========================================================================*
+ * INCLUDES (associated header files)
+ *===========================================================================*/
+#include "ExpressionFunction.hpp"
+
+/*===========================================================================*
+ * INCLUDES project headers
+ *===========================================================================*/
+#include <util/Util.hpp>
+
+/*===========================================================================*
+ * INCLUDES C/C++ standard library (and other external libraries)
+ *===========================================================================*/
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+
+/*===========================================================================*
+ * DEFINES and MACROS
+ *===========================================================================*/
+
+/*===========================================================================*
+ * NAMESPACE, CONSTANTS and TYPE DECLARATIONS/IMPLEMENTATIONS
+ *===========================================================================*/
+
+namespace Trip
+{
+	typedef ExpressionFunction::OpCode OpCode;
+	typedef ExpressionFunction::Instruction Instruction;
+
+
+	/// A node of the syntax tree. Uses the OpCodes without constant operands.
+	struct ExpressionTerm
+	{
+		/// The operation.
+		OpCode op;
+
+		/// The value of an OP_CONST.
+		float k;
+
+		/// The index of the first operand or -1.
+		int a;
+
+		/// The index of the second operand or -1.
+		int b;
+	};
+
+
+	/// A function that may be called in an expression.
+	struct ExpressionCall
+	{
+		/// The name in the expression.
+		const char* name;
+
+		/// The operation.
+		OpCode op;
+
+		/// The number of arguments, 1 or 2.
+		uint args;
+	};
+
+	/// All functions that may be called in an expression.
+	static const ExpressionCall __expression_calls[] =
+	{
+		{ "sin", ExpressionFunction::OP_SIN, 1 },
+		{ "cos", ExpressionFunction::OP_COS, 1 },
+		{ "tan", ExpressionFunction::OP_TAN, 1 },
+		{ "exp", ExpressionFunction::OP_EXP, 1 },
+		{ "log", ExpressionFunction::OP_LOG, 1 },
+		{ "sqrt", ExpressionFunction::OP_SQRT, 1 },
+		{ "abs", ExpressionFunction::OP_ABS, 1 },
+		{ "floor", ExpressionFunction::OP_FLOOR, 1 },
+		{ "ceil", ExpressionFunction::OP_CEIL, 1 },
+		{ "min", ExpressionFunction::OP_MIN, 2 },
+		{ "max", ExpressionFunction::OP_MAX, 2 },
+		{ "pow", ExpressionFunction::OP_POW, 2 }
+	};
+
+
+	/**
+	 * Applies an operation of the syntax tree to constant operands.
+	 * @param op The operation.
+	 * @param a The first operand.
+	 * @param b The second operand, ignored by unary operations.
+	 * @return The result.
+	 */
+	static float applyOp( OpCode op, float a, float b)
+	{
+		switch( op)
+		{
+		case ExpressionFunction::OP_NEG:	return -a;
+		case ExpressionFunction::OP_ADD:	return a + b;
+		case ExpressionFunction::OP_SUB:	return a - b;
+		case ExpressionFunction::OP_MUL:	return a * b;
+		case ExpressionFunction::OP_DIV:	return a / b;
+		case ExpressionFunction::OP_POW:	return std::pow( a, b);
+		case ExpressionFunction::OP_MIN:	return std::min( a, b);
+		case ExpressionFunction::OP_MAX:	return std::max( a, b);
+		case ExpressionFunction::OP_SIN:	return std::sin( a);
+		case ExpressionFunction::OP_COS:	return std::cos( a);
+		case ExpressionFunction::OP_TAN:	return std::tan( a);
+		case ExpressionFunction::OP_EXP:	return std::exp( a);
+		case ExpressionFunction::OP_LOG:	return std::log( a);
+		case ExpressionFunction::OP_SQRT:	return std::sqrt( a);
+		case ExpressionFunction::OP_ABS:	return std::fabs( a);
+		case ExpressionFunction::OP_FLOOR:	return std::floor( a);
+		case ExpressionFunction::OP_CEIL:	return std::ceil( a);
+		default:							return 0;
+		}
+	}
+
+
+	/**
+	 * The ExpressionParser builds the syntax tree of an expression by recursive descent.
+	 * Subtrees of constants are folded into a single constant while they are built.
+	 *
+	 * sum     := product (('+' | '-') product)*
+	 * product := unary (('*' | '/') unary)*
+	 * unary   := ('-' | '+') unary | power
+	 * power   := primary ('^' unary)?
+	 * primary := number | name | name '(' sum (',' sum)? ')' | '(' sum ')'
+	 */
+	class ExpressionParser
+	{
+	private: // vars
+
+		/// The expression.
+		const String& _text;
+
+		/// The position of the next character.
+		size_t _pos;
+
+		/// The first error or an empty string.
+		String _error;
+
+		/// Receives the nodes of the tree.
+		std::vector<ExpressionTerm>& _terms;
+
+	public: // constructor
+
+		/**
+		 * Main constructor.
+		 * @param text The expression to parse.
+		 * @param terms Receives the nodes of the tree.
+		 */
+		ExpressionParser( const String& text, std::vector<ExpressionTerm>& terms)
+			: _text( text),
+			_pos(0),
+			_terms( terms)
+		{}
+
+	public: // methods
+
+		/**
+		 * Parses the whole expression.
+		 * @return The index of the root node or -1 on an error, see getError().
+		 */
+		int parse()
+		{
+			const int root = parseSum();
+			if( root < 0)
+				return -1;
+
+			skipSpace();
+			if( _pos < _text.size())
+				return fail( String( "unexpected '") + _text[_pos] + "'");
+
+			return root;
+		}
+
+		/**
+		 * Retrieves the first error.
+		 * @return The description of the error or an empty string.
+		 */
+		const String& getError()
+		{
+			return _error;
+		}
+
+		/**
+		 * Retrieves the position the parser stopped at.
+		 * @return The index of the character.
+		 */
+		size_t getPosition()
+		{
+			return _pos;
+		}
+
+	private: // helpers
+
+		int parseSum()
+		{
+			int left = parseProduct();
+			while( left >= 0)
+			{
+				if( accept( '+'))
+					left = make( ExpressionFunction::OP_ADD, left, parseProduct());
+				else if( accept( '-'))
+					left = make( ExpressionFunction::OP_SUB, left, parseProduct());
+				else
+					break;
+			}
+			return left;
+		}
+
+		int parseProduct()
+		{
+			int left = parseUnary();
+			while( left >= 0)
+			{
+				if( accept( '*'))
+					left = make( ExpressionFunction::OP_MUL, left, parseUnary());
+				else if( accept( '/'))
+					left = make( ExpressionFunction::OP_DIV, left, parseUnary());
+				else
+					break;
+			}
+			return left;
+		}
+
+		int parseUnary()
+		{
+			if( accept( '-'))
+				return make( ExpressionFunction::OP_NEG, parseUnary());
+			if( accept( '+'))
+				return parseUnary();
+
+			return parsePower();
+		}
+
+		int parsePower()
+		{
+			const int base = parsePrimary();
+			if( base >= 0 && accept( '^'))
+				return make( ExpressionFunction::OP_POW, base, parseUnary());
+
+			return base;
+		}
+
+		int parsePrimary()
+		{
+			skipSpace();
+			if( _pos >= _text.size())
+				return fail( "unexpected end");
+
+			const char c = _text[_pos];
+
+			// number
+			if( std::isdigit( (unsigned char) c) || c == '.')
+			{
+				const char* begin = _text.c_str() + _pos;
+				char* end = 0;
+				const double value = std::strtod( begin, &end);
+				if( end == begin)
+					return fail( "invalid number");
+
+				_pos += end - begin;
+				return makeConstant( (float) value);
+			}
+
+			// parentheses
+			if( accept( '('))
+			{
+				const int inner = parseSum();
+				if( inner < 0)
+					return -1;
+				if( !accept( ')'))
+					return fail( "')' expected");
+
+				return inner;
+			}
+
+			if( !std::isalpha( (unsigned char) c))
+				return fail( String( "unexpected '") + c + "'");
+
+			// variable, constant or call
+			const size_t begin = _pos;
+			while( _pos < _text.size() && std::isalnum( (unsigned char) _text[_pos]))
+			{
+				++_pos;
+			}
+			const String name = _text.substr( begin, _pos - begin);
+
+			if( name == "x")
+				return makeX();
+			if( name == "pi")
+				return makeConstant( 3.14159265358979f);
+			if( name == "e")
+				return makeConstant( 2.71828182845905f);
+
+			const uint call_count = sizeof( __expression_calls) / sizeof( __expression_calls[0]);
+			for( uint i = 0; i < call_count; ++i)
+			{
+				const ExpressionCall& call = __expression_calls[i];
+				if( name != call.name)
+					continue;
+
+				if( !accept( '('))
+					return fail( "'(' expected after " + name);
+
+				const int a = parseSum();
+				int b = -1;
+				if( a >= 0 && call.args == 2)
+				{
+					if( !accept( ','))
+						return fail( "',' expected, " + name + " takes 2 arguments");
+					b = parseSum();
+				}
+				if( a < 0 || (call.args == 2 && b < 0))
+					return -1;
+				if( !accept( ')'))
+					return fail( "')' expected");
+
+				return make( call.op, a, b);
+			}
+
+			_pos = begin;
+			return fail( "unknown name '" + name + "'");
+		}
+
+		/**
+		 * Adds an operation to the tree. Folds it into a constant if all operands are constants.
+		 * @param op The operation.
+		 * @param a The first operand or -1 after an error.
+		 * @param b The second operand, -1 for unary operations.
+		 * @return The index of the node or -1 after an error.
+		 */
+		int make( OpCode op, int a, int b = -1)
+		{
+			const bool unary = op == ExpressionFunction::OP_NEG || op >= ExpressionFunction::OP_SIN;
+			if( a < 0 || (!unary && b < 0))
+				return -1;
+
+			if( _terms[a].op == ExpressionFunction::OP_CONST && (unary || _terms[b].op == ExpressionFunction::OP_CONST))
+				return makeConstant( applyOp( op, _terms[a].k, unary ? 0 : _terms[b].k));
+
+			ExpressionTerm term = { op, 0, a, b };
+			_terms.push_back( term);
+			return _terms.size() - 1;
+		}
+
+		int makeConstant( float k)
+		{
+			ExpressionTerm term = { ExpressionFunction::OP_CONST, k, -1, -1 };
+			_terms.push_back( term);
+			return _terms.size() - 1;
+		}
+
+		int makeX()
+		{
+			ExpressionTerm term = { ExpressionFunction::OP_X, 0, -1, -1 };
+			_terms.push_back( term);
+			return _terms.size() - 1;
+		}
+
+		/**
+		 * Skips white space and consumes the given character, if it is next.
+		 * @param c The character.
+		 * @return
+		 * TRUE - the character was consumed
+		 * FALSE - another character or the end is next
+		 */
+		bool accept( char c)
+		{
+			skipSpace();
+			if( _pos < _text.size() && _text[_pos] == c)
+			{
+				++_pos;
+				return true;
+			}
+			return false;
+		}
+
+		void skipSpace()
+		{
+			while( _pos < _text.size() && std::isspace( (unsigned char) _text[_pos]))
+			{
+				++_pos;
+			}
+		}
+
+		/**
+		 * Records an error, unless there is one already.
+		 * @param message The description of the error.
+		 * @return -1
+		 */
+		int fail( const String& message)
+		{
+			if( _error.empty())
+			{
+				_error = message;
+			}
+			return -1;
+		}
+
+	}; // END class ExpressionParser
+
+
+	/**
+	 * Appends an instruction to the bytecode.
+	 */
+	static void emitInstruction( std::vector<Instruction>& code, OpCode op, uint dst, uint a = 0, uint b = 0, float k = 0)
+	{
+		Instruction instruction = { (unsigned char) op, (unsigned char) dst, (unsigned char) a, (unsigned char) b, k };
+		code.push_back( instruction);
+	}
+
+
+	/**
+	 * Appends an addition or a multiplication by a constant to the bytecode.
+	 * Merges it into the last instruction, if that adds to or multiplies the same register, too.
+	 */
+	static void emitAccumulation( std::vector<Instruction>& code, OpCode op, uint dst, float k)
+	{
+		if( !code.empty())
+		{
+			Instruction& last = code.back();
+			if( last.op == op && last.dst == dst && last.a == dst)
+			{
+				if( op == ExpressionFunction::OP_ADD_K)
+					last.k += k;
+				else
+					last.k *= k;
+				return;
+			}
+		}
+		emitInstruction( code, op, dst, dst, 0, k);
+	}
+
+
+	/**
+	 * Appends the instruction that applies a binary operation to a register and a constant.
+	 * Operations that do not change the register emit nothing.
+	 * @param code The bytecode.
+	 * @param op The binary operation of the syntax tree.
+	 * @param dst The register of the first operand, receives the result.
+	 * @param k The constant second operand.
+	 */
+	static void emitConstantOperand( std::vector<Instruction>& code, OpCode op, uint dst, float k)
+	{
+		switch( op)
+		{
+		case ExpressionFunction::OP_ADD:
+			if( k != 0)
+				emitAccumulation( code, ExpressionFunction::OP_ADD_K, dst, k);
+			break;
+		case ExpressionFunction::OP_SUB:
+			if( k != 0)
+				emitAccumulation( code, ExpressionFunction::OP_ADD_K, dst, -k);
+			break;
+		case ExpressionFunction::OP_MUL:
+			if( k != 1)
+				emitAccumulation( code, ExpressionFunction::OP_MUL_K, dst, k);
+			break;
+		case ExpressionFunction::OP_DIV:
+			if( k != 1)
+				emitAccumulation( code, ExpressionFunction::OP_MUL_K, dst, 1 / k);
+			break;
+		case ExpressionFunction::OP_POW:
+			if( k == 2)
+				emitInstruction( code, ExpressionFunction::OP_MUL, dst, dst, dst);
+			else if( k != 1)
+				emitInstruction( code, ExpressionFunction::OP_POW_K, dst, dst, 0, k);
+			break;
+		case ExpressionFunction::OP_MIN:
+			emitInstruction( code, ExpressionFunction::OP_MIN_K, dst, dst, 0, k);
+			break;
+		default:
+			emitInstruction( code, ExpressionFunction::OP_MAX_K, dst, dst, 0, k);
+			break;
+		}
+	}
+
+
+	/**
+	 * Emits the bytecode of a subtree. Registers above dst may be used for intermediate results.
+	 * @param terms The syntax tree.
+	 * @param t The index of the subtree.
+	 * @param dst The register that receives the result.
+	 * @param code The bytecode.
+	 * @param registers The number of registers used so far. Receives the new number.
+	 * @return
+	 * TRUE - the subtree was emitted
+	 * FALSE - the subtree needs more than TRIP_EXPRESSION_REGISTERS registers
+	 */
+	static bool emitTerm( const std::vector<ExpressionTerm>& terms, int t, uint dst, std::vector<Instruction>& code, uint& registers)
+	{
+		if( dst >= TRIP_EXPRESSION_REGISTERS)
+			return false;
+		registers = std::max( registers, dst + 1);
+
+		const ExpressionTerm& term = terms[t];
+		switch( term.op)
+		{
+		case ExpressionFunction::OP_CONST:
+			emitInstruction( code, term.op, dst, 0, 0, term.k);
+			return true;
+
+		case ExpressionFunction::OP_X:
+			emitInstruction( code, term.op, dst);
+			return true;
+
+		case ExpressionFunction::OP_ADD:
+		case ExpressionFunction::OP_SUB:
+		case ExpressionFunction::OP_MUL:
+		case ExpressionFunction::OP_DIV:
+		case ExpressionFunction::OP_POW:
+		case ExpressionFunction::OP_MIN:
+		case ExpressionFunction::OP_MAX:
+			break;
+
+		default:
+			// unary operations work in place
+			if( !emitTerm( terms, term.a, dst, code, registers))
+				return false;
+			emitInstruction( code, term.op, dst, dst);
+			return true;
+		}
+
+		const ExpressionTerm& a = terms[term.a];
+		const ExpressionTerm& b = terms[term.b];
+
+		// a constant second operand goes into the instruction
+		if( b.op == ExpressionFunction::OP_CONST)
+		{
+			if( !emitTerm( terms, term.a, dst, code, registers))
+				return false;
+			emitConstantOperand( code, term.op, dst, b.k);
+			return true;
+		}
+
+		// so does a constant first operand
+		if( a.op == ExpressionFunction::OP_CONST)
+		{
+			switch( term.op)
+			{
+			case ExpressionFunction::OP_ADD:
+			case ExpressionFunction::OP_MUL:
+			case ExpressionFunction::OP_MIN:
+			case ExpressionFunction::OP_MAX:
+				if( !emitTerm( terms, term.b, dst, code, registers))
+					return false;
+				emitConstantOperand( code, term.op, dst, a.k);
+				return true;
+
+			case ExpressionFunction::OP_SUB:
+				if( !emitTerm( terms, term.b, dst, code, registers))
+					return false;
+				emitInstruction( code, ExpressionFunction::OP_RSUB_K, dst, dst, 0, a.k);
+				return true;
+
+			case ExpressionFunction::OP_DIV:
+				if( !emitTerm( terms, term.b, dst, code, registers))
+					return false;
+				emitInstruction( code, ExpressionFunction::OP_RDIV_K, dst, dst, 0, a.k);
+				return true;
+
+			default:
+				// k ^ b = exp( b * log( k)) for positive k
+				if( a.k > 0)
+				{
+					if( !emitTerm( terms, term.b, dst, code, registers))
+						return false;
+					emitConstantOperand( code, ExpressionFunction::OP_MUL, dst, std::log( a.k));
+					emitInstruction( code, ExpressionFunction::OP_EXP, dst, dst);
+					return true;
+				}
+				break;
+			}
+		}
+
+		if( !emitTerm( terms, term.a, dst, code, registers) || !emitTerm( terms, term.b, dst + 1, code, registers))
+			return false;
+		emitInstruction( code, term.op, dst, dst, dst + 1);
+		return true;
+	}
+
+
+	/**
+	 * Compiles an expression of x into the bytecode.
+	 * @param expression The expression, e.g. "sin(x*3)*exp(-x)".
+	 * @return
+	 * TRUE - the expression is compiled and will be evaluated from now on, a baked table is dropped
+	 * FALSE - the expression has an error, which is logged. The Function did not change.
+	 */
+	bool ExpressionFunction::compile( const String& expression)
+	{
+		std::vector<ExpressionTerm> terms;
+		ExpressionParser parser( expression, terms);
+		const int root = parser.parse();
+		if( root < 0)
+		{
+			Trip::log( "ExpressionFunction: " + parser.getError() + " at position "
+				+ Util::itos( parser.getPosition()) + " of \"" + expression + "\".", MSG_ERROR);
+			return false;
+		}
+
+		std::vector<Instruction> code;
+		uint registers = 0;
+		if( !emitTerm( terms, root, 0, code, registers))
+		{
+			Trip::log( "ExpressionFunction: \"" + expression + "\" nests too deeply, "
+				+ Util::itos( TRIP_EXPRESSION_REGISTERS) + " registers are available.", MSG_ERROR);
+			return false;
+		}
+
+		_expression = expression;
+		_code.swap( code);
+		_register_count = registers;
+
+		// the table shows the old expression
+		unbake();
+		return true;
+	}
+
+
+	/**
+	 * Evaluates the bytecode.
+	 * @param x The input variable.
+	 * @return The value of the expression.
+	 */
+	float ExpressionFunction::doFun( float x)
+	{
+		float r[TRIP_EXPRESSION_REGISTERS];
+		r[0] = 0;
+
+		const Instruction* it = _code.empty() ? 0 : &_code[0];
+		const Instruction* end = it + _code.size();
+		for( ; it != end; ++it)
+		{
+			const Instruction& i = *it;
+			switch( i.op)
+			{
+			case OP_CONST:	r[i.dst] = i.k; break;
+			case OP_X:		r[i.dst] = x; break;
+			case OP_NEG:	r[i.dst] = -r[i.a]; break;
+			case OP_ADD:	r[i.dst] = r[i.a] + r[i.b]; break;
+			case OP_SUB:	r[i.dst] = r[i.a] - r[i.b]; break;
+			case OP_MUL:	r[i.dst] = r[i.a] * r[i.b]; break;
+			case OP_DIV:	r[i.dst] = r[i.a] / r[i.b]; break;
+			case OP_POW:	r[i.dst] = std::pow( r[i.a], r[i.b]); break;
+			case OP_MIN:	r[i.dst] = std::min( r[i.a], r[i.b]); break;
+			case OP_MAX:	r[i.dst] = std::max( r[i.a], r[i.b]); break;
+			case OP_ADD_K:	r[i.dst] = r[i.a] + i.k; break;
+			case OP_RSUB_K:	r[i.dst] = i.k - r[i.a]; break;
+			case OP_MUL_K:	r[i.dst] = r[i.a] * i.k; break;
+			case OP_RDIV_K:	r[i.dst] = i.k / r[i.a]; break;
+			case OP_POW_K:	r[i.dst] = std::pow( r[i.a], i.k); break;
+			case OP_MIN_K:	r[i.dst] = std::min( r[i.a], i.k); break;
+			case OP_MAX_K:	r[i.dst] = std::max( r[i.a], i.k); break;
+			case OP_SIN:	r[i.dst] = std::sin( r[i.a]); break;
+			case OP_COS:	r[i.dst] = std::cos( r[i.a]); break;
+			case OP_TAN:	r[i.dst] = std::tan( r[i.a]); break;
+			case OP_EXP:	r[i.dst] = std::exp( r[i.a]); break;
+			case OP_LOG:	r[i.dst] = std::log( r[i.a]); break;
+			case OP_SQRT:	r[i.dst] = std::sqrt( r[i.a]); break;
+			case OP_ABS:	r[i.dst] = std::fabs( r[i.a]); break;
+			case OP_FLOOR:	r[i.dst] = std::floor( r[i.a]); break;
+			case OP_CEIL:	r[i.dst] = std::ceil( r[i.a]); break;
+			}
+		}
+		return r[0];
+	}
+
+
+	/**
+	 * Evaluates the bytecode for an array, every instruction on TRIP_EXPRESSION_BLOCK values at once.
+	 * @param x The input variables.
+	 * @param out Receives the values of the expression. May be x.
+	 * @param n The number of values.
+	 */
+	void ExpressionFunction::doFunBatch( const float* x, float* out, size_t n)
+	{
+		if( _code.empty())
+		{
+			std::fill( out, out + n, 0.0f);
+			return;
+		}
+
+		float r[TRIP_EXPRESSION_REGISTERS][TRIP_EXPRESSION_BLOCK];
+		float scratch[TRIP_SIMD_WIDTH];
+
+		for( size_t begin = 0; begin < n; begin += TRIP_EXPRESSION_BLOCK)
+		{
+			const uint count = (uint) std::min<size_t>( TRIP_EXPRESSION_BLOCK, n - begin);
+
+			// the sines and cosines run on whole batches, x is padded with zeros to them
+			const uint padded = (count + TRIP_SIMD_WIDTH - 1) / TRIP_SIMD_WIDTH * TRIP_SIMD_WIDTH;
+			const float* in = x + begin;
+
+			for( auto it = _code.begin(); it != _code.end(); ++it)
+			{
+				const Instruction& i = *it;
+				float* d = r[i.dst];
+				const float* a = r[i.a];
+				const float* b = r[i.b];
+				const float k = i.k;
+
+				switch( i.op)
+				{
+				case OP_CONST:	std::fill( d, d + padded, k); break;
+				case OP_X:		std::copy( in, in + count, d); std::fill( d + count, d + padded, 0.0f); break;
+				case OP_NEG:	for( uint j = 0; j < padded; ++j) d[j] = -a[j]; break;
+				case OP_ADD:	for( uint j = 0; j < padded; ++j) d[j] = a[j] + b[j]; break;
+				case OP_SUB:	for( uint j = 0; j < padded; ++j) d[j] = a[j] - b[j]; break;
+				case OP_MUL:	for( uint j = 0; j < padded; ++j) d[j] = a[j] * b[j]; break;
+				case OP_DIV:	for( uint j = 0; j < padded; ++j) d[j] = a[j] / b[j]; break;
+				case OP_POW:	for( uint j = 0; j < padded; ++j) d[j] = std::pow( a[j], b[j]); break;
+				case OP_MIN:	for( uint j = 0; j < padded; ++j) d[j] = std::min( a[j], b[j]); break;
+				case OP_MAX:	for( uint j = 0; j < padded; ++j) d[j] = std::max( a[j], b[j]); break;
+				case OP_ADD_K:	for( uint j = 0; j < padded; ++j) d[j] = a[j] + k; break;
+				case OP_RSUB_K:	for( uint j = 0; j < padded; ++j) d[j] = k - a[j]; break;
+				case OP_MUL_K:	for( uint j = 0; j < padded; ++j) d[j] = a[j] * k; break;
+				case OP_RDIV_K:	for( uint j = 0; j < padded; ++j) d[j] = k / a[j]; break;
+				case OP_POW_K:	for( uint j = 0; j < padded; ++j) d[j] = std::pow( a[j], k); break;
+				case OP_MIN_K:	for( uint j = 0; j < padded; ++j) d[j] = std::min( a[j], k); break;
+				case OP_MAX_K:	for( uint j = 0; j < padded; ++j) d[j] = std::max( a[j], k); break;
+				case OP_SIN:	for( uint j = 0; j < padded; j += TRIP_SIMD_WIDTH) SimdMath::sinCos( a + j, d + j, scratch); break;
+				case OP_COS:	for( uint j = 0; j < padded; j += TRIP_SIMD_WIDTH) SimdMath::sinCos( a + j, scratch, d + j); break;
+				case OP_TAN:	for( uint j = 0; j < padded; ++j) d[j] = std::tan( a[j]); break;
+				case OP_EXP:	for( uint j = 0; j < padded; ++j) d[j] = std::exp( a[j]); break;
+				case OP_LOG:	for( uint j = 0; j < padded; ++j) d[j] = std::log( a[j]); break;
+				case OP_SQRT:	for( uint j = 0; j < padded; ++j) d[j] = std::sqrt( a[j]); break;
+				case OP_ABS:	for( uint j = 0; j < padded; ++j) d[j] = std::fabs( a[j]); break;
+				case OP_FLOOR:	for( uint j = 0; j < padded; ++j) d[j] = std::floor( a[j]); break;
+				case OP_CEIL:	for( uint j = 0; j < padded; ++j) d[j] = std::ceil( a[j]); break;
+				}
+			}
+
+			std::copy( r[0], r[0] + count, out + begin);
+		}
+	}
+
+} // END namespace Trip
@@ -0,0 +1,183 @@
+/**
+ * This file contains the ExpressionFunction, a Function compiled from an expression string at runtime.
+ * @author barn
+ * @version 20121208
+ */
+#ifndef __ExpressionFunction_HPP__
+#define __ExpressionFunction_HPP__
+
+/*===========================================================================*
+ * INCLUDES base definition file for DLL import/export
+ *===========================================================================*/
+
+/*===========================================================================*
+ * INCLUDES project headers
+ *===========================================================================*/
+#include "stdafx.h"
+#include "Function.hpp"
+
+/*===========================================================================*
+ * INCLUDES C/C++ standard library (and other external libraries)
+ *===========================================================================*/
+
+/*===========================================================================*
+ * DEFINES and MACROS
+ *===========================================================================*/
+
+/// The number of registers of the bytecode. Limits how deeply an expression may nest.
+#define TRIP_EXPRESSION_REGISTERS 16
+
+/// The number of values doFunBatch() runs every instruction on. A multiple of TRIP_SIMD_WIDTH.
+#define TRIP_EXPRESSION_BLOCK 64
+
+/*===========================================================================*
+ * NAMESPACE, CONSTANTS and TYPE DECLARATIONS/IMPLEMENTATIONS
+ *===========================================================================*/
+
+namespace Trip
+{
+
+	/**
+	 * An ExpressionFunction evaluates an expression of x, e.g. "sin(x*3)*exp(-x)",
+	 * so new curves can be defined without a rebuild.
+	 *
+	 * The expression may use numbers, x, pi, e, the operators + - * / ^ and parentheses,
+	 * and the functions sin, cos, tan, exp, log, sqrt, abs, floor, ceil, min, max and pow.
+	 *
+	 * compile() parses the expression once, folds all constant subexpressions and emits a
+	 * register-based bytecode. Operations with a constant operand carry it in the instruction,
+	 * so evaluating the bytecode needs no lookups besides the registers and no allocations.
+	 * doFunBatch() runs every instruction on a block of values, sines and cosines with the SimdMath.
+	 * Clones copy the bytecode.
+	 */
+	class ExpressionFunction : public Function
+	{
+	public: // nested types
+
+		/// The operations of the bytecode.
+		enum OpCode
+		{
+			OP_CONST,	//< dst = k
+			OP_X,		//< dst = x
+			OP_NEG,		//< dst = -a
+			OP_ADD,		//< dst = a + b
+			OP_SUB,		//< dst = a - b
+			OP_MUL,		//< dst = a * b
+			OP_DIV,		//< dst = a / b
+			OP_POW,		//< dst = a ^ b
+			OP_MIN,		//< dst = min( a, b)
+			OP_MAX,		//< dst = max( a, b)
+			OP_ADD_K,	//< dst = a + k
+			OP_RSUB_K,	//< dst = k - a
+			OP_MUL_K,	//< dst = a * k
+			OP_RDIV_K,	//< dst = k / a
+			OP_POW_K,	//< dst = a ^ k
+			OP_MIN_K,	//< dst = min( a, k)
+			OP_MAX_K,	//< dst = max( a, k)
+			OP_SIN,		//< dst = sin( a)
+			OP_COS,		//< dst = cos( a)
+			OP_TAN,		//< dst = tan( a)
+			OP_EXP,		//< dst = exp( a)
+			OP_LOG,		//< dst = log( a)
+			OP_SQRT,	//< dst = sqrt( a)
+			OP_ABS,		//< dst = abs( a)
+			OP_FLOOR,	//< dst = floor( a)
+			OP_CEIL		//< dst = ceil( a)
+		};
+
+		/// One instruction of the bytecode.
+		struct Instruction
+		{
+			/// The OpCode.
+			unsigned char op;
+
+			/// The register that receives the result.
+			unsigned char dst;
+
+			/// The register of the first operand.
+			unsigned char a;
+
+			/// The register of the second operand.
+			unsigned char b;
+
+			/// The constant operand.
+			float k;
+		};
+
+	private: // vars
+
+		/// The expression the bytecode was compiled from.
+		String _expression;
+
+		/// The compiled bytecode. Leaves the result in register 0.
+		std::vector<Instruction> _code;
+
+		/// The number of registers the bytecode uses.
+		uint _register_count;
+
+	public: // constructor
+
+		/**
+		 * Main constructor.
+		 * Evaluates to 0 until an expression is compiled.
+		 */
+		ExpressionFunction()
+			: _register_count(0)
+		{}
+
+	public: // methods
+
+		Function* clone()
+		{
+			return new ExpressionFunction( *this);
+		}
+
+		/**
+		 * Compiles an expression of x into the bytecode.
+		 * @param expression The expression, e.g. "sin(x*3)*exp(-x)".
+		 * @return
+		 * TRUE - the expression is compiled and will be evaluated from now on, a baked table is dropped
+		 * FALSE - the expression has an error, which is logged. The Function did not change.
+		 */
+		bool compile( const String& expression);
+
+	protected: // overridden methods
+
+		float doFun( float x);
+
+		void doFunBatch( const float* x, float* out, size_t n);
+
+	public: // getters
+
+		/**
+		 * Retrieves the expression the Function evaluates.
+		 * @return The last compiled expression or an empty string.
+		 */
+		const String& getExpression()
+		{
+			return _expression;
+		}
+
+		/**
+		 * Retrieves the length of the bytecode.
+		 * @return The number of instructions per evaluation.
+		 */
+		uint getInstructionCount()
+		{
+			return _code.size();
+		}
+
+		/**
+		 * Retrieves the number of registers the bytecode uses.
+		 * @return The number of registers, at most TRIP_EXPRESSION_REGISTERS.
+		 */
+		uint getRegisterCount()
+		{
+			return _register_count;
+		}
+
+	}; // END class ExpressionFunction
+
+} // END namespace Trip
+
+#endif /* __ExpressionFunction_HPP__ */
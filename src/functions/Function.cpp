@@ -1,7 +1,7 @@
 /**
  * Implementation file for the Function.hpp.
  * @author barn
- * @version 20121027
+ * @version 20121208
  */
 
 /*===========================================================================*
@@ -12,6 +12,7 @@
 /*===========================================================================*
  * INCLUDES project headers
  *===========================================================================*/
+#include <util/Util.hpp>
 
 /*===========================================================================*
  * INCLUDES C/C++ standard library (and other external libraries)
@@ -27,6 +28,28 @@
  
 namespace Trip
 {
+	/**
+	 * Scales and offsets an array, out = v * factor + offset.
+	 * @param v The values.
+	 * @param out Receives the results. May be v.
+	 * @param n The number of values.
+	 * @param factor The factor of all values.
+	 * @param offset The offset of all values.
+	 */
+	static void affineArray( const float* v, float* out, size_t n, float factor, float offset)
+	{
+		const size_t batched = n - n % TRIP_SIMD_WIDTH;
+		for( size_t i = 0; i < batched; i += TRIP_SIMD_WIDTH)
+		{
+			SimdMath::affine( v + i, out + i, factor, offset);
+		}
+		for( size_t i = batched; i < n; ++i)
+		{
+			out[i] = v[i] * factor + offset;
+		}
+	}
+
+
 	/**
 	 * TODO doc
 	 */
@@ -38,4 +61,126 @@ namespace Trip
 		_y_offset = y_offset;
 	}
 
+
+	/**
+	 * Samples doFun() over a domain into a table, which is interpolated from now on.
+	 * Measures the maximum difference to doFun() at TRIP_FUNCTION_ERROR_SAMPLES points per interval.
+	 * @param min The start of the domain.
+	 * @param max The end of the domain.
+	 * @param intervals The number of intervals across the domain, up to TRIP_FUNCTION_TABLE_MAX_INTERVALS.
+	 * @param interpolation The interpolation between the samples.
+	 * @param periodic Indicates whether doFun() repeats itself with the period max - min.
+	 * Then the table is used for every input, else only within the domain.
+	 * @return
+	 * TRUE - the Function is baked
+	 * FALSE - the domain or the number of intervals is invalid, nothing changed
+	 */
+	bool Function::bake( float min, float max, uint intervals, Interpolation interpolation, bool periodic)
+	{
+		if( !(max > min) || intervals < 1 || intervals > TRIP_FUNCTION_TABLE_MAX_INTERVALS)
+		{
+			Trip::log( "Function::bake(): the domain must not be empty and have 1 to "
+				+ Util::itos( TRIP_FUNCTION_TABLE_MAX_INTERVALS) + " intervals.", MSG_ERROR);
+			return false;
+		}
+
+		const float step = (max - min) / intervals;
+
+		Table* table = new Table();
+		table->min = min;
+		table->inv_step = 1.0f / step;
+		table->intervals = intervals;
+		table->inv_intervals = 1.0f / intervals;
+		table->periodic = periodic;
+		table->interpolation = interpolation;
+		table->max_error = 0;
+
+		// one sample before and two after the domain, so every interval has four neighbours
+		table->samples.resize( intervals + 3);
+		for( uint j = 0; j < intervals + 3; ++j)
+		{
+			table->samples[j] = doFun( min + ((float) j - 1) * step);
+		}
+		_table.reset( table);
+
+		// compare between the samples, NaN of doFun() is ignored
+		float max_error = 0;
+		for( uint i = 0; i < intervals; ++i)
+		{
+			for( uint s = 1; s <= TRIP_FUNCTION_ERROR_SAMPLES; ++s)
+			{
+				const float u = min + (i + (float) s / (TRIP_FUNCTION_ERROR_SAMPLES + 1)) * step;
+				const float error = std::fabs( lookup( u) - doFun( u));
+				if( error > max_error)
+				{
+					max_error = error;
+				}
+			}
+		}
+		table->max_error = max_error;
+
+		return true;
+	}
+
+
+	/**
+	 * Applies the function with the set stretch factors and offset to an array.
+	 * Stretch factors of 1 and offsets of 0 are skipped.
+	 * @param x The input variables.
+	 * @param out Receives the function values. May be x.
+	 * @param n The number of values.
+	 */
+	void Function::funBatch( const float* x, float* out, size_t n)
+	{
+		const float* u = x;
+		if( _x_stretch != 1.0f || _x_offset != 0.0f)
+		{
+			affineArray( x, out, n, _x_stretch, _x_offset);
+			u = out;
+		}
+
+		if( _table)
+		{
+			for( size_t i = 0; i < n; ++i)
+			{
+				out[i] = lookup( u[i]);
+			}
+		}
+		else
+		{
+			doFunBatch( u, out, n);
+		}
+
+		if( _y_stretch != 1.0f || _y_offset != 0.0f)
+		{
+			affineArray( out, out, n, _y_stretch, _y_offset);
+		}
+	}
+
+
+	/**
+	 * Applies a kernel to an array, batch by batch.
+	 * The rest of the array is padded with zeros to a whole batch.
+	 * @param kernel The kernel.
+	 * @param x The input variables.
+	 * @param out Receives the function values. May be x.
+	 * @param n The number of values.
+	 */
+	void Function::forEachBatch( BatchKernel kernel, const float* x, float* out, size_t n)
+	{
+		const size_t batched = n - n % TRIP_SIMD_WIDTH;
+		for( size_t i = 0; i < batched; i += TRIP_SIMD_WIDTH)
+		{
+			kernel( x + i, out + i);
+		}
+
+		if( batched < n)
+		{
+			float rest[TRIP_SIMD_WIDTH] = { 0 };
+			std::copy( x + batched, x + n, rest);
+			kernel( rest, rest);
+			std::copy( rest, rest + (n - batched), out + batched);
+		}
+	}
+
 } // END namespace Trip
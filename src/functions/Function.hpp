@@ -1,7 +1,7 @@
 /**
  * This file contains Function classes that encapsulate mathematical functions
  * @author barn
- * @version 20121027
+ * @version 20121208
  */
 #ifndef __Function_HPP__
 #define __Function_HPP__
@@ -14,15 +14,27 @@
  * INCLUDES project headers
  *===========================================================================*/
  #include "stdafx.h"
+#include <util/SimdMath.hpp>
 
 /*===========================================================================*
  * INCLUDES C/C++ standard library (and other external libraries)
  *===========================================================================*/
+#include <boost/shared_ptr.hpp>
+#include <cmath>
 
 /*===========================================================================*
  * DEFINES and MACROS
  *===========================================================================*/
 
+/// The default number of intervals of a baked table.
+#define TRIP_FUNCTION_TABLE_INTERVALS 256
+
+/// The maximum number of intervals of a baked table.
+#define TRIP_FUNCTION_TABLE_MAX_INTERVALS 65536
+
+/// The number of points per interval at which bake() compares the table with the Function.
+#define TRIP_FUNCTION_ERROR_SAMPLES 4
+
 /*===========================================================================*
  * NAMESPACE, CONSTANTS and TYPE DECLARATIONS/IMPLEMENTATIONS
  *===========================================================================*/
@@ -31,9 +43,57 @@ namespace Trip
 {
 	/**
 	 * This class represents real mathematical functions.
+	 *
+	 * An expensive Function can be baked: bake() samples doFun() over a domain into a table,
+	 * which is then interpolated instead of calling doFun(). Outside the domain, doFun() is called,
+	 * unless the Function is periodic over the domain. The table is shared by copies of the Function,
+	 * the FunctionManager hands it on to the Functions it creates from a baked prototype.
+	 *
+	 * funBatch() evaluates whole arrays, e.g. one value per Node. Subclasses may override doFunBatch()
+	 * with vectorized implementations built from the SimdMath and forEachBatch(), the default calls doFun() per value.
 	 */
 	class Function
 	{
+	public: // nested types
+
+		/// The interpolation between the samples of a baked table.
+		enum Interpolation
+		{
+			/// Straight lines between two samples.
+			INTERPOLATION_LINEAR,
+
+			/// Catmull-Rom splines through four samples.
+			INTERPOLATION_CUBIC
+		};
+
+		/// The samples of a baked Function.
+		struct Table
+		{
+			/// The samples at min + (i - 1) / inv_step, one before and two after the domain for the interpolation.
+			std::vector<float> samples;
+
+			/// The start of the domain.
+			float min;
+
+			/// The number of intervals per unit.
+			float inv_step;
+
+			/// The number of intervals across the domain.
+			uint intervals;
+
+			/// 1 / intervals, to wrap periodic inputs without a division.
+			float inv_intervals;
+
+			/// Indicates whether the Function repeats itself after the domain.
+			bool periodic;
+
+			/// The interpolation between the samples.
+			Interpolation interpolation;
+
+			/// The maximum difference to doFun() that bake() has measured.
+			float max_error;
+		};
+
 	protected: // vars
 
 		float _x_stretch; //< Stretch factor in x/input direction
@@ -41,12 +101,22 @@ namespace Trip
 		float _x_offset; //< additive offset in x direction
 		float _y_offset; //< additive offset in y direction
 
+		/// The baked table or NULL to call doFun() on every evaluation.
+		boost::shared_ptr<const Table> _table;
+
 	public: // constructors & destructor
 
 		Function()
 			: _x_stretch(1.0f), _y_stretch(1.0f), _x_offset(0.0f), _y_offset(0.0f)
 		{}
 
+		/**
+		 * Destructor.
+		 * Functions are deleted through Function pointers, e.g. by the FunctionManager.
+		 */
+		virtual ~Function()
+		{}
+
 	public: // methods
 
 		/**
@@ -71,11 +141,56 @@ namespace Trip
 		}
 
 		/**
-		 * TODO doc
+		 * Applies the function with the set stretch factors and offset.
+		 * @param x The input variable.
+		 * @return The corresponding function value to x.
 		 */
 		float fun( float x)
 		{
-			return doFun( x * _x_stretch + _x_offset) * _y_stretch + _y_offset;
+			const float u = x * _x_stretch + _x_offset;
+			return (_table ? lookup( u) : doFun( u)) * _y_stretch + _y_offset;
+		}
+
+		/**
+		 * Applies the function with the set stretch factors and offset to an array.
+		 * The stretch factors and offsets are applied to whole batches, as is doFunBatch().
+		 * @param x The input variables.
+		 * @param out Receives the function values. May be x.
+		 * @param n The number of values.
+		 */
+		void funBatch( const float* x, float* out, size_t n);
+
+		/**
+		 * Samples doFun() over a domain into a table, which is interpolated from now on.
+		 * Measures the maximum difference to doFun() between the samples, see getTable().
+		 * @param min The start of the domain.
+		 * @param max The end of the domain.
+		 * @param intervals The number of intervals across the domain, up to TRIP_FUNCTION_TABLE_MAX_INTERVALS.
+		 * @param interpolation The interpolation between the samples.
+		 * @param periodic Indicates whether doFun() repeats itself with the period max - min.
+		 * Then the table is used for every input, else only within the domain.
+		 * @return
+		 * TRUE - the Function is baked
+		 * FALSE - the domain or the number of intervals is invalid, nothing changed
+		 */
+		bool bake( float min, float max, uint intervals = TRIP_FUNCTION_TABLE_INTERVALS,
+			Interpolation interpolation = INTERPOLATION_LINEAR, bool periodic = false);
+
+		/**
+		 * Drops the table and calls doFun() on every evaluation again.
+		 */
+		void unbake()
+		{
+			_table.reset();
+		}
+
+		/**
+		 * Uses the table of another Function, e.g. of the prototype this Function was cloned from.
+		 * @param other The Function to share the table with. Must compute the same doFun().
+		 */
+		void shareTable( const Function& other)
+		{
+			_table = other._table;
 		}
 
 	protected: // overridable methods
@@ -88,6 +203,73 @@ namespace Trip
 			return 0.0f;
 		}
 
+		/**
+		 * Applies doFun() to an array, without the stretch factors and offsets.
+		 * Override it with a vectorized implementation, the default calls doFun() per value.
+		 * @param x The input variables.
+		 * @param out Receives the function values. May be x.
+		 * @param n The number of values.
+		 */
+		virtual void doFunBatch( const float* x, float* out, size_t n)
+		{
+			for( size_t i = 0; i < n; ++i)
+			{
+				out[i] = doFun( x[i]);
+			}
+		}
+
+	protected: // class helpers
+
+		/// Computes TRIP_SIMD_WIDTH function values, see forEachBatch(). out may be x.
+		typedef void (*BatchKernel)( const float* x, float* out);
+
+		/**
+		 * Applies a kernel to an array, batch by batch.
+		 * The rest of the array is padded with zeros to a whole batch.
+		 * @param kernel The kernel.
+		 * @param x The input variables.
+		 * @param out Receives the function values. May be x.
+		 * @param n The number of values.
+		 */
+		static void forEachBatch( BatchKernel kernel, const float* x, float* out, size_t n);
+
+	private: // helpers
+
+		/**
+		 * Interpolates the baked table.
+		 * @param u The input of doFun().
+		 * @return The interpolated value of doFun().
+		 */
+		float lookup( float u)
+		{
+			const Table& table = *_table;
+			float t = (u - table.min) * table.inv_step;
+			if( table.periodic)
+			{
+				t -= std::floor( t * table.inv_intervals) * table.intervals;
+			}
+
+			// outside the domain
+			if( !(t >= 0 && t <= table.intervals))
+				return doFun( u);
+
+			uint i = (uint) t;
+			if( i >= table.intervals)
+			{
+				i = table.intervals - 1;
+			}
+			const float f = t - i;
+
+			// the samples i - 1, i, i + 1 and i + 2
+			const float* p = &table.samples[i];
+			if( table.interpolation == INTERPOLATION_LINEAR)
+				return p[1] + (p[2] - p[1]) * f;
+
+			return p[1] + 0.5f * f * (p[2] - p[0]
+				+ f * (2.0f * p[0] - 5.0f * p[1] + 4.0f * p[2] - p[3]
+				+ f * (3.0f * (p[1] - p[2]) + p[3] - p[0])));
+		}
+
 	public: // setters & getters
 
 		/**
@@ -135,6 +317,12 @@ namespace Trip
 		 */
 		float getOffsetY() { return _y_offset; }
 
+		/**
+		 * Retrieves the baked table.
+		 * @return The table or NULL, if the Function is not baked.
+		 */
+		const Table* getTable() { return _table.get(); }
+
 	}; // END class Function
 
 } // END namespace Trip
@@ -1,7 +1,7 @@
 /**
  * This file contains a bunch of Functions.
  * @author barn
- * @version 20121029
+ * @version 20121210
  */
 #ifndef __Functions1_HPP__
 #define __Functions1_HPP__
@@ -15,6 +15,7 @@
  *===========================================================================*/
 #include "stdafx.h"
 #include "Function.hpp"
+#include "CurveFunction.hpp"
 
 /*===========================================================================*
  * INCLUDES C/C++ standard library (and other external libraries)
@@ -32,29 +33,53 @@ namespace Trip
 {
 
 	/// Simple linear function
-	class Lin : public Function
+	class Lin : public CurveFunction<Curves::Lin>
 	{
 	public:
-		float doFun( float x) { return x; }
+		void doFunBatch( const float* x, float* out, size_t n) { if( out != x) std::copy( x, x + n, out); }
 		Function* clone() { return new Lin(); }
 	};
 
+	/// ((1 - cos( 10x)) * 0.5) * x
+	typedef Curves::Product< Curves::Offset< Curves::Scale< Curves::Stretch<Curves::Cosine> > >, Curves::Lin> CosFadeCurve;
+
 	/// Cosine Wave getting smaller: lim->0 = 0.
-	class CosFade : public Function
+	class CosFade : public CurveFunction<CosFadeCurve>
 	{
 	public:
 
-		float doFun( float x) { return ( (1 - std::cosf( x*10)) * 0.5f) * x; }
+		CosFade()
+			: CurveFunction<CosFadeCurve>( CosFadeCurve( Curves::offset( 0.5f, Curves::scale( -0.5f, Curves::stretch( 10, Curves::Cosine()))), Curves::Lin()))
+		{}
+
+		void doFunBatch( const float* x, float* out, size_t n) { forEachBatch( &batch, x, out, n); }
 		Function* clone() { return new CosFade(); }
+
+	private:
+		static void batch( const float* x, float* out)
+		{
+			float angles[TRIP_SIMD_WIDTH], s[TRIP_SIMD_WIDTH], c[TRIP_SIMD_WIDTH];
+			SimdMath::affine( x, angles, 10, 0);
+			SimdMath::sinCos( angles, s, c);
+			SimdMath::affine( c, c, -0.5f, 0.5f);
+			SimdMath::product( c, x, out);
+		}
 	};
 
 
 	/// Simple sine wave
-	class Sine : public Function
+	class Sine : public CurveFunction<Curves::Sine>
 	{
 	public:
-		float doFun( float x) { return std::sinf( x); }
+		void doFunBatch( const float* x, float* out, size_t n) { forEachBatch( &batch, x, out, n); }
 		Function* clone() { return new Sine(); }
+
+	private:
+		static void batch( const float* x, float* out)
+		{
+			float c[TRIP_SIMD_WIDTH];
+			SimdMath::sinCos( x, out, c);
+		}
 	};
 	
 } // END namespace Trip
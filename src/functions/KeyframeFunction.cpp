@@ -0,0 +1,242 @@
+/**
+ * Implementation file for the KeyframeFunction.hpp.
+ * @author barn
+ * @version 20121209
+ */
+
+/*===========================================================================*
+ * INCLUDES (associated header files)
+ *===========================================================================*/
+#include "KeyframeFunction.hpp"
+
+/*===========================================================================*
+ * INCLUDES project headers
+ *===========================================================================*/
+#include <util/Util.hpp>
+
+/*===========================================================================*
+ * INCLUDES C/C++ standard library (and other external libraries)
+ *===========================================================================*/
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+/*===========================================================================*
+ * DEFINES and MACROS
+ *===========================================================================*/
+
+/*===========================================================================*
+ * NAMESPACE, CONSTANTS and TYPE DECLARATIONS/IMPLEMENTATIONS
+ *===========================================================================*/
+
+namespace Trip
+{
+	typedef KeyframeFunction::Key Key;
+	typedef KeyframeFunction::Segment Segment;
+
+
+	/// Orders keys by their time.
+	static bool isEarlier( const Key& a, const Key& b)
+	{
+		return a.time < b.time;
+	}
+
+
+	/**
+	 * Reads a float from a whole token.
+	 * @param token The token, e.g. "-0.5".
+	 * @param value Receives the float.
+	 * @return
+	 * TRUE - the token is a float
+	 * FALSE - the token is no float, the value did not change
+	 */
+	static bool toFloat( const String& token, float& value)
+	{
+		char* end = 0;
+		const double parsed = std::strtod( token.c_str(), &end);
+		if( token.empty() || *end != 0)
+			return false;
+
+		value = (float) parsed;
+		return true;
+	}
+
+
+	/**
+	 * Computes the slope of a Catmull-Rom spline at a key from its neighbours.
+	 * The first and the last key use the slope towards their only neighbour.
+	 * @param keys The keys, sorted by time.
+	 * @param k The index of the key.
+	 * @return The slope at the key.
+	 */
+	static float catmullRomSlope( const std::vector<Key>& keys, uint k)
+	{
+		const uint prev = k > 0 ? k - 1 : k;
+		const uint next = k + 1 < keys.size() ? k + 1 : k;
+		const float dt = keys[next].time - keys[prev].time;
+		return dt > 0 ? (keys[next].value - keys[prev].value) / dt : 0;
+	}
+
+
+	/**
+	 * Sets the keys and computes the segments between them. A baked table is dropped.
+	 * Linear segments keep c2 and c3 at 0, Bezier and Catmull-Rom segments are
+	 * Hermite curves through the values of their keys with the slopes at both ends.
+	 * @param keys The keys in any order. Of keys with the same time, the later one is reached from then on.
+	 */
+	void KeyframeFunction::setKeys( const std::vector<Key>& keys)
+	{
+		unbake();
+		_segment = 0;
+		if( keys.empty())
+		{
+			_spline.reset();
+			return;
+		}
+
+		boost::shared_ptr<Spline> spline( new Spline());
+		spline->keys = keys;
+		std::stable_sort( spline->keys.begin(), spline->keys.end(), &isEarlier);
+
+		const std::vector<Key>& sorted = spline->keys;
+		spline->times.reserve( sorted.size());
+		spline->segments.reserve( sorted.size() - 1);
+		for( uint i = 0; i < sorted.size(); ++i)
+		{
+			spline->times.push_back( sorted[i].time);
+			if( i + 1 == sorted.size())
+				break;
+
+			const Key& a = sorted[i];
+			const Key& b = sorted[i + 1];
+			const float dt = b.time - a.time;
+
+			Segment segment;
+			segment.c0 = a.value;
+			segment.c1 = segment.c2 = segment.c3 = 0;
+
+			// segments of keys with the same time are never evaluated
+			if( dt > 0)
+			{
+				const float slope = (b.value - a.value) / dt;
+				if( a.interpolation == KEY_LINEAR)
+				{
+					segment.c1 = slope;
+				}
+				else
+				{
+					const float m0 = a.interpolation == KEY_BEZIER ? a.out_slope : catmullRomSlope( sorted, i);
+					const float m1 = a.interpolation == KEY_BEZIER ? b.in_slope : catmullRomSlope( sorted, i + 1);
+					segment.c1 = m0;
+					segment.c2 = (3 * slope - 2 * m0 - m1) / dt;
+					segment.c3 = (m0 + m1 - 2 * slope) / (dt * dt);
+				}
+			}
+			spline->segments.push_back( segment);
+		}
+
+		_spline = spline;
+	}
+
+
+	/**
+	 * Parses keys from a compact text and sets them.
+	 * Every key is its time and value, optionally followed by its interpolation:
+	 * "l" for linear, "c" for Catmull-Rom or "b" and the slopes of the incoming and the outgoing handle for Bezier.
+	 * Keys without an interpolation are linear. A "#" comments out the rest of the line.
+	 * @param text The keys.
+	 * @return
+	 * TRUE - the keys are set
+	 * FALSE - the text has an error, which is logged. The Function did not change.
+	 */
+	bool KeyframeFunction::parse( const String& text)
+	{
+		// split into tokens without the comments
+		std::vector<String> tokens;
+		std::istringstream lines( text);
+		String line;
+		while( std::getline( lines, line))
+		{
+			std::istringstream words( line.substr( 0, line.find( '#')));
+			String word;
+			while( words >> word)
+			{
+				tokens.push_back( word);
+			}
+		}
+
+		std::vector<Key> keys;
+		for( uint i = 0; i < tokens.size(); )
+		{
+			Key key;
+			if( i + 1 >= tokens.size() || !toFloat( tokens[i], key.time) || !toFloat( tokens[i + 1], key.value))
+			{
+				Trip::log( "KeyframeFunction: expected the time and the value of key " + Trip::Util::itos( keys.size())
+					+ " at \"" + tokens[i] + "\".", MSG_ERROR);
+				return false;
+			}
+			i += 2;
+
+			float number;
+			if( i < tokens.size() && !toFloat( tokens[i], number))
+			{
+				const String& type = tokens[i++];
+				if( type == "c")
+				{
+					key.interpolation = KEY_CATMULL_ROM;
+				}
+				else if( type == "b")
+				{
+					if( i + 1 >= tokens.size() || !toFloat( tokens[i], key.in_slope) || !toFloat( tokens[i + 1], key.out_slope))
+					{
+						Trip::log( "KeyframeFunction: the Bezier key " + Trip::Util::itos( keys.size())
+							+ " needs the slopes of both handles.", MSG_ERROR);
+						return false;
+					}
+					key.interpolation = KEY_BEZIER;
+					i += 2;
+				}
+				else if( type != "l")
+				{
+					Trip::log( "KeyframeFunction: unknown interpolation \"" + type + "\", use l, c or b.", MSG_ERROR);
+					return false;
+				}
+			}
+
+			keys.push_back( key);
+		}
+
+		if( keys.empty())
+		{
+			Trip::log( "KeyframeFunction: no keys given.", MSG_ERROR);
+			return false;
+		}
+
+		setKeys( keys);
+		return true;
+	}
+
+
+	/**
+	 * Loads keys in the format of parse() from a file and sets them.
+	 * @param filename The name of the file, including the path.
+	 * @return
+	 * TRUE - the keys are set
+	 * FALSE - the file cannot be read or has an error, which is logged. The Function did not change.
+	 */
+	bool KeyframeFunction::load( const String& filename)
+	{
+		std::ifstream file( filename.c_str());
+		if( !file)
+		{
+			Trip::log( "KeyframeFunction: cannot read the file " + filename + ".", MSG_ERROR);
+			return false;
+		}
+
+		std::ostringstream text;
+		text << file.rdbuf();
+		return parse( text.str());
+	}
+
+} // END namespace Trip
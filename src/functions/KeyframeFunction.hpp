@@ -0,0 +1,259 @@
+/**
+ * This file contains the KeyframeFunction, a Function that interpolates authored keyframes.
+ * @author barn
+ * @version 20121210
+ */
+#ifndef __KeyframeFunction_HPP__
+#define __KeyframeFunction_HPP__
+
+/*===========================================================================*
+ * INCLUDES base definition file for DLL import/export
+ *===========================================================================*/
+
+/*===========================================================================*
+ * INCLUDES project headers
+ *===========================================================================*/
+#include "stdafx.h"
+#include "Function.hpp"
+
+/*===========================================================================*
+ * INCLUDES C/C++ standard library (and other external libraries)
+ *===========================================================================*/
+#include <boost/shared_ptr.hpp>
+#include <algorithm>
+#include <vector>
+
+/*===========================================================================*
+ * DEFINES and MACROS
+ *===========================================================================*/
+
+/*===========================================================================*
+ * NAMESPACE, CONSTANTS and TYPE DECLARATIONS/IMPLEMENTATIONS
+ *===========================================================================*/
+
+namespace Trip
+{
+
+	/**
+	 * A KeyframeFunction interpolates a curve through keyframes, e.g. an authored fade or timeline.
+	 * Every key chooses how the segment up to the next key is interpolated: linearly,
+	 * as a cubic Bezier curve with the slopes of its handles or as a Catmull-Rom spline
+	 * through the neighbouring keys. Before the first and after the last key the value is held.
+	 *
+	 * setKeys() converts every segment into the coefficients of a cubic polynomial once,
+	 * so an evaluation is one lookup and three multiply-adds. The segment of the last evaluation
+	 * is remembered: inputs that increase monotonically, like the time of a fade, find their segment
+	 * in O(1), other inputs fall back to a binary search.
+	 * Clones share the keys and the coefficients, but every clone remembers its own segment.
+	 * Remembering it writes to the Function on every evaluation, so an instance is not thread-safe:
+	 * evaluate it on one thread at a time, e.g. as the clone a Transformer owns, and clone it for other threads.
+	 *
+	 * The keys can be parsed from a compact text, see parse(), or loaded from a file with the same format.
+	 */
+	class KeyframeFunction : public Function
+	{
+	public: // nested types
+
+		/// How a key interpolates the segment up to the next key.
+		enum KeyInterpolation
+		{
+			/// A straight line.
+			KEY_LINEAR,
+
+			/// A cubic Bezier curve. The handles leave the keys with their slopes.
+			KEY_BEZIER,
+
+			/// A Catmull-Rom spline, the slopes follow the neighbouring keys.
+			KEY_CATMULL_ROM
+		};
+
+		/// A keyframe.
+		struct Key
+		{
+			/// The input of the key.
+			float time;
+
+			/// The value at the time.
+			float value;
+
+			/// The interpolation up to the next key.
+			KeyInterpolation interpolation;
+
+			/// The slope of the incoming handle, for a KEY_BEZIER before this key.
+			float in_slope;
+
+			/// The slope of the outgoing handle, for a KEY_BEZIER key.
+			float out_slope;
+
+			Key( float time = 0, float value = 0, KeyInterpolation interpolation = KEY_LINEAR, float inSlope = 0, float outSlope = 0)
+				: time( time), value( value), interpolation( interpolation), in_slope( inSlope), out_slope( outSlope)
+			{}
+		};
+
+		/// c0 + c1 * u + c2 * u^2 + c3 * u^3 with u the input relative to the start of the segment.
+		struct Segment
+		{
+			float c0;
+			float c1;
+			float c2;
+			float c3;
+		};
+
+		/// The keys and the segments between them.
+		struct Spline
+		{
+			/// The keys, sorted by time.
+			std::vector<Key> keys;
+
+			/// The times of the keys, apart from the keys for a cache-friendly search.
+			std::vector<float> times;
+
+			/// One segment per pair of neighbouring keys.
+			std::vector<Segment> segments;
+		};
+
+	private: // vars
+
+		/// The keys and segments or NULL without keys.
+		boost::shared_ptr<const Spline> _spline;
+
+		/// The segment of the last evaluation. Written by every evaluation without synchronization.
+		uint _segment;
+
+	public: // constructor
+
+		/**
+		 * Main constructor.
+		 * Evaluates to 0 until keys are set.
+		 */
+		KeyframeFunction()
+			: _segment(0)
+		{}
+
+	public: // methods
+
+		Function* clone()
+		{
+			return new KeyframeFunction( *this);
+		}
+
+		/**
+		 * Sets the keys and computes the segments between them. A baked table is dropped.
+		 * @param keys The keys in any order. Of keys with the same time, the later one is reached from then on.
+		 */
+		void setKeys( const std::vector<Key>& keys);
+
+		/**
+		 * Parses keys from a compact text and sets them.
+		 * Every key is its time and value, optionally followed by its interpolation:
+		 * "l" for linear, "c" for Catmull-Rom or "b" and the slopes of the incoming and the outgoing handle for Bezier.
+		 * Keys without an interpolation are linear. A "#" comments out the rest of the line.
+		 * E.g. "0 0 c  1 1 c  2 0.5 b 0 0  3 0" runs through a spline, eases into 0.5 and goes straight to 0.
+		 * @param text The keys.
+		 * @return
+		 * TRUE - the keys are set
+		 * FALSE - the text has an error, which is logged. The Function did not change.
+		 */
+		bool parse( const String& text);
+
+		/**
+		 * Loads keys in the format of parse() from a file and sets them.
+		 * @param filename The name of the file, including the path.
+		 * @return
+		 * TRUE - the keys are set
+		 * FALSE - the file cannot be read or has an error, which is logged. The Function did not change.
+		 */
+		bool load( const String& filename);
+
+	protected: // overridden methods
+
+		float doFun( float x)
+		{
+			return evaluate( x);
+		}
+
+		void doFunBatch( const float* x, float* out, size_t n)
+		{
+			for( size_t i = 0; i < n; ++i)
+			{
+				out[i] = evaluate( x[i]);
+			}
+		}
+
+	private: // helpers
+
+		/**
+		 * Evaluates the segment the input falls into.
+		 * @param x The input.
+		 * @return The interpolated value.
+		 */
+		float evaluate( float x)
+		{
+			if( !_spline)
+				return 0;
+
+			// NaN fails the comparisons below and would find no segment
+			if( x != x)
+				return x;
+
+			const Spline& spline = *_spline;
+			if( x <= spline.times.front())
+				return spline.keys.front().value;
+			if( x >= spline.times.back())
+				return spline.keys.back().value;
+
+			const uint s = findSegment( x);
+			const Segment& segment = spline.segments[s];
+			const float u = x - spline.times[s];
+			return ((segment.c3 * u + segment.c2) * u + segment.c1) * u + segment.c0;
+		}
+
+		/**
+		 * Finds the segment of an input inside the keys, trying the remembered segment and the one after it first.
+		 * Not thread-safe, since the found segment is remembered in the Function.
+		 * @param x The input, greater than the time of the first key and less than the time of the last key.
+		 * @return The index of the segment, which is remembered.
+		 */
+		uint findSegment( float x)
+		{
+			const std::vector<float>& times = _spline->times;
+			const uint s = _segment;
+			if( s + 1 < times.size() && times[s] <= x)
+			{
+				if( x < times[s + 1])
+					return s;
+				if( s + 2 < times.size() && x < times[s + 2])
+					return _segment = s + 1;
+			}
+
+			// never past the last segment, whatever the input
+			const uint found = (uint) (std::upper_bound( times.begin(), times.end(), x) - times.begin());
+			_segment = std::min<uint>( found > 0 ? found - 1 : 0, _spline->segments.size() - 1);
+			return _segment;
+		}
+
+	public: // getters
+
+		/**
+		 * Retrieves the keys.
+		 * @return The keys sorted by time or NULL without keys.
+		 */
+		const Spline* getSpline()
+		{
+			return _spline.get();
+		}
+
+		/**
+		 * Retrieves the number of keys.
+		 * @return The number of keys.
+		 */
+		uint getKeyCount()
+		{
+			return _spline ? _spline->keys.size() : 0;
+		}
+
+	}; // END class KeyframeFunction
+
+} // END namespace Trip
+
+#endif /* __KeyframeFunction_HPP__ */
@@ -1,7 +1,7 @@
 /**
  * Implementation file for the TripConsole.hpp.
  * @author barn
- * @version 20121029
+ * @version 20121210
  */
 
 /*===========================================================================*
@@ -15,16 +15,25 @@
 #include <Defines.h>
 #include <managers/TransformerManager.hpp>
 #include <managers/FunctionManager.hpp>
+#include <functions/ExpressionFunction.hpp>
+#include <functions/KeyframeFunction.hpp>
 #include <managers/TripVarManager.hpp>
+#include <FrameProfiler.hpp>
+#include <FrameStatistics.hpp>
+#include <LodPolicy.hpp>
 
 /*===========================================================================*
  * INCLUDES C/C++ standard library (and other external libraries)
  *===========================================================================*/
+#include <cstdlib>
 
 /*===========================================================================*
  * DEFINES and MACROS
  *===========================================================================*/
 
+/// the default number of Transformers and Clusters printed by onPrintFrameInfo
+#define TRIP_FRAME_INFO_COUNT 10
+
 /// maps a keyword to a callback
 #define CALLBACK_MAP(keyword, associated_callback)	\
 	if( callback_name.compare( keyword) == 0) \
@@ -42,6 +51,69 @@ namespace Trip
 	/// Pairs of commands and callbacks
 	typedef std::pair<String, ConsoleCallback> CommandCallbackPair;
 
+
+	/**
+	 * Indicates whether a Function was defined on the console.
+	 * @param function The Function.
+	 * @return
+	 * TRUE - the Function is an ExpressionFunction or a KeyframeFunction
+	 * FALSE - the Function is built in
+	 */
+	static bool isUserDefined( Function* function)
+	{
+		return dynamic_cast<ExpressionFunction*>( function) || dynamic_cast<KeyframeFunction*>( function);
+	}
+
+
+	/**
+	 * Reads a float from a whole argument, like the command line with atof but without trailing garbage.
+	 * @param arg The argument, e.g. "16.6".
+	 * @param value Receives the float.
+	 * @return
+	 * TRUE - the argument is a float
+	 * FALSE - the argument is no float, the value did not change
+	 */
+	static bool toFloat( const String& arg, float& value)
+	{
+		char* end = 0;
+		const double parsed = std::strtod( arg.c_str(), &end);
+		if( arg.empty() || *end != 0)
+			return false;
+
+		value = (float) parsed;
+		return true;
+	}
+
+
+	/**
+	 * Registers a Function prototype defined on the console. Replaces a prototype that was defined
+	 * on the console too, of either kind; the built-in prototypes cannot be replaced.
+	 * Transformers own clones, so the old prototype can go.
+	 * @param name The name of the prototype.
+	 * @param function The new prototype. Deleted if it cannot be registered.
+	 * @return
+	 * TRUE - the prototype is registered
+	 * FALSE - a built-in prototype has the name, which is logged
+	 */
+	static bool replacePrototype( const String& name, Function* function)
+	{
+		FunctionManager* manager = FunctionManager::instance();
+		Function* existing = manager->getPrototype( name);
+		if( existing && !isUserDefined( existing))
+		{
+			Trip::log( String("The Function ").append( name).append( " is built in and cannot be redefined."), MSG_ERROR);
+			delete function;
+			return false;
+		}
+		if( existing)
+		{
+			manager->removePrototype( name);
+		}
+
+		manager->addPrototype( name, function);
+		return true;
+	}
+
 	/**
 	 * Assigns a callback to a string element.
 	 * Override this method in your subclass.
@@ -84,7 +156,18 @@ namespace Trip
 				CALLBACK_MAP("onPrintPrototypeClusters", onPrintPrototypeClusters)
 				CALLBACK_MAP("onPrintPrototypeTransformers", onPrintPrototypeTransformers)
 				CALLBACK_MAP("onPrintPrototypeFunctions", onPrintPrototypeFunctions)
+				CALLBACK_MAP("onDefineFunction", onDefineFunction)
+				CALLBACK_MAP("onDefineKeyframes", onDefineKeyframes)
+				CALLBACK_MAP("onLoadKeyframes", onLoadKeyframes)
+				CALLBACK_MAP("onBakeFunction", onBakeFunction)
+				CALLBACK_MAP("onUnbakeFunction", onUnbakeFunction)
 				CALLBACK_MAP("onPrintFrameInfo", onPrintFrameInfo)
+				CALLBACK_MAP("onSetProfiling", onSetProfiling)
+				CALLBACK_MAP("onResetFrameInfo", onResetFrameInfo)
+				CALLBACK_MAP("onSetLod", onSetLod)
+				CALLBACK_MAP("onSetCulling", onSetCulling)
+				CALLBACK_MAP("onSetBudget", onSetBudget)
+				CALLBACK_MAP("onSetPriority", onSetPriority)
 				CALLBACK_MAP("onFadeIn", onFadeIn)
 				CALLBACK_MAP("onFadeOut", onFadeOut)
 				CALLBACK_MAP("onEnable", onEnable)
@@ -231,6 +314,7 @@ namespace Trip
 
 	/**
 	 * onPrintPrototypeFunctions
+	 * Prints the names of all Function prototypes.
 	 */
 	bool ConsoleInterpreter::onPrintPrototypeFunctions( std::vector<String>& args)
 	{
@@ -241,16 +325,340 @@ namespace Trip
 	}
 
 
+	/**
+	 * onDefineFunction
+	 * Takes a name and an expression of x to register an ExpressionFunction prototype,
+	 * e.g. "Wobble sin(x*3)*exp(-x)". Prototypes defined on the console may be defined again.
+	 */
+	bool ConsoleInterpreter::onDefineFunction( std::vector<String>& args)
+	{
+		if( args.size() < 3)
+		{
+			Trip::log( String("Usage: ").append( args[0]).append( " <name> <expression of x>"), MSG_ERROR);
+			return false;
+		}
+
+		// the expression may contain spaces
+		String expression = args[2];
+		for( uint i = 3; i < args.size(); ++i)
+		{
+			expression.append( " ").append( args[i]);
+		}
+
+		ExpressionFunction* function = new ExpressionFunction();
+		if( !function->compile( expression))
+		{
+			delete function;
+			return false;
+		}
+
+		const uint instruction_count = function->getInstructionCount();
+		if( !replacePrototype( args[1], function))
+			return false;
+
+		std::cout << "Function " << args[1] << " defined, " << instruction_count << " instructions." << std::endl;
+		return true;
+	}
+
+
+	/**
+	 * onDefineKeyframes
+	 * Takes a name and keyframes to register a KeyframeFunction prototype, e.g. "Blink 0 0 c 0.5 1 c 1 0",
+	 * see KeyframeFunction::parse(). Prototypes defined on the console may be defined again.
+	 */
+	bool ConsoleInterpreter::onDefineKeyframes( std::vector<String>& args)
+	{
+		if( args.size() < 3)
+		{
+			Trip::log( String("Usage: ").append( args[0]).append( " <name> <time> <value> [l|c|b <in> <out>] ..."), MSG_ERROR);
+			return false;
+		}
+
+		String text = args[2];
+		for( uint i = 3; i < args.size(); ++i)
+		{
+			text.append( " ").append( args[i]);
+		}
+
+		KeyframeFunction* function = new KeyframeFunction();
+		if( !function->parse( text))
+		{
+			delete function;
+			return false;
+		}
+
+		const uint key_count = function->getKeyCount();
+		if( !replacePrototype( args[1], function))
+			return false;
+
+		std::cout << "Function " << args[1] << " defined, " << key_count << " keys." << std::endl;
+		return true;
+	}
+
+
+	/**
+	 * onLoadKeyframes
+	 * Takes a name and a file with keyframes to register a KeyframeFunction prototype, see KeyframeFunction::load().
+	 * Prototypes defined on the console may be defined again.
+	 */
+	bool ConsoleInterpreter::onLoadKeyframes( std::vector<String>& args)
+	{
+		if( args.size() < 3)
+		{
+			Trip::log( String("Usage: ").append( args[0]).append( " <name> <file>"), MSG_ERROR);
+			return false;
+		}
+
+		KeyframeFunction* function = new KeyframeFunction();
+		if( !function->load( args[2]))
+		{
+			delete function;
+			return false;
+		}
+
+		const uint key_count = function->getKeyCount();
+		if( !replacePrototype( args[1], function))
+			return false;
+
+		std::cout << "Function " << args[1] << " loaded, " << key_count << " keys." << std::endl;
+		return true;
+	}
+
+
+	/**
+	 * onBakeFunction
+	 * Takes a name, the start and the end of the domain and optionally the number of intervals,
+	 * "cubic" and "periodic" to sample a prototype into a table. Functions created from a baked
+	 * prototype interpolate its table.
+	 */
+	bool ConsoleInterpreter::onBakeFunction( std::vector<String>& args)
+	{
+		if( args.size() < 4)
+		{
+			Trip::log( String("Usage: ").append( args[0]).append( " <name> <min> <max> [intervals] [cubic] [periodic]"), MSG_ERROR);
+			return false;
+		}
+
+		Function* function = FunctionManager::instance()->getPrototype( args[1]);
+		if( function == 0)
+		{
+			Trip::log( String("Function ").append(args[1]).append( " not known."), MSG_ERROR);
+			return false;
+		}
+
+		float min, max;
+		if( !toFloat( args[2], min) || !toFloat( args[3], max))
+		{
+			Trip::log( String("The domain ").append( args[2]).append( " to ").append( args[3]).append( " is no pair of numbers."), MSG_ERROR);
+			return false;
+		}
+
+		uint intervals = TRIP_FUNCTION_TABLE_INTERVALS;
+		Function::Interpolation interpolation = Function::INTERPOLATION_LINEAR;
+		bool periodic = false;
+		for( uint i = 4; i < args.size(); ++i)
+		{
+			if( args[i] == "cubic")
+				interpolation = Function::INTERPOLATION_CUBIC;
+			else if( args[i] == "periodic")
+				periodic = true;
+			else if( Trip::Util::isNumber( args[i]))
+				intervals = std::atoi( args[i].c_str());
+			else
+			{
+				Trip::log( String("Unknown option ").append( args[i]).append( ", use a number of intervals, cubic or periodic."), MSG_ERROR);
+				return false;
+			}
+		}
+
+		if( !function->bake( min, max, intervals, interpolation, periodic))
+			return false;
+
+		std::cout << "Function " << args[1] << " baked into " << intervals << " intervals, max. error "
+			<< function->getTable()->max_error << "." << std::endl;
+		return true;
+	}
+
+
+	/**
+	 * onUnbakeFunction
+	 * Takes the name of a baked prototype, which computes its values exactly again.
+	 */
+	bool ConsoleInterpreter::onUnbakeFunction( std::vector<String>& args)
+	{
+		if( args.size() < 2)
+		{
+			Trip::log( String("Usage: ").append( args[0]).append( " <name>"), MSG_ERROR);
+			return false;
+		}
+
+		Function* function = FunctionManager::instance()->getPrototype( args[1]);
+		if( function == 0)
+		{
+			Trip::log( String("Function ").append(args[1]).append( " not known."), MSG_ERROR);
+			return false;
+		}
+
+		function->unbake();
+		std::cout << "Function " << args[1] << " unbaked." << std::endl;
+		return true;
+	}
+
+
 	/**
 	 * onPrintFrameInfo
+	 * Prints the frame time percentiles, the LOD state and the most expensive Transformers and Cluster subtrees
+	 * of the last frames. Takes the number of entries to print.
 	 */
 	bool ConsoleInterpreter::onPrintFrameInfo( std::vector<String>& args)
 	{
-		std::cout << "onPrintFrameInfo" << std::endl;
-		// TODO
-		return false;
+		uint count = TRIP_FRAME_INFO_COUNT;
+		if( args.size() >= 2)
+		{
+			if( !Util::isNumber( args[1]))
+			{
+				Trip::log( "Expected the number of entries to print.", MSG_ERROR);
+				return false;
+			}
+			count = std::atoi( args[1].c_str());
+		}
+
+		FrameStatistics::instance()->print();
+		std::cout << std::endl;
+		LodPolicy::instance()->print();
+		std::cout << std::endl;
+		FrameProfiler::instance()->print( count);
+		return true;
 	}
 
+
+	/**
+	 * onSetProfiling
+	 * Takes "on" or "off" to enable or disable the FrameProfiler.
+	 */
+	bool ConsoleInterpreter::onSetProfiling( std::vector<String>& args)
+	{
+		if( args.size() < 2 || (args[1] != "on" && args[1] != "off"))
+		{
+			Trip::log( String("Usage: ").append( args[0]).append( " on|off"), MSG_ERROR);
+			return false;
+		}
+
+		FrameProfiler* profiler = FrameProfiler::instance();
+		profiler->setEnabled( args[1] == "on");
+		std::cout << "Profiling " << (profiler->isEnabled() ? "enabled." : "disabled.") << std::endl;
+		return true;
+	}
+
+
+	/**
+	 * onResetFrameInfo
+	 * Forgets the recorded frame times and the measures of the FrameProfiler.
+	 */
+	bool ConsoleInterpreter::onResetFrameInfo( std::vector<String>& args)
+	{
+		FrameStatistics::instance()->reset();
+		FrameProfiler::instance()->reset();
+		std::cout << "Frame statistics reset." << std::endl;
+		return true;
+	}
+
+
+	/**
+	 * onSetLod
+	 * Takes a distance to update Clusters beyond it less often or "off".
+	 */
+	bool ConsoleInterpreter::onSetLod( std::vector<String>& args)
+	{
+		LodPolicy* lod = LodPolicy::instance();
+		float distance;
+		if( args.size() >= 2 && args[1] == "off")
+		{
+			lod->setEnabled( false);
+		}
+		else if( args.size() >= 2 && toFloat( args[1], distance) && distance > 0)
+		{
+			lod->setDistance( distance);
+			lod->setEnabled( true);
+		}
+		else
+		{
+			Trip::log( String("Usage: ").append( args[0]).append( " <distance>|off"), MSG_ERROR);
+			return false;
+		}
+		lod->print();
+		return true;
+	}
+
+
+	/**
+	 * onSetCulling
+	 * Takes "on" or "off" to update Clusters outside the camera frustum less often or not.
+	 */
+	bool ConsoleInterpreter::onSetCulling( std::vector<String>& args)
+	{
+		if( args.size() < 2 || (args[1] != "on" && args[1] != "off"))
+		{
+			Trip::log( String("Usage: ").append( args[0]).append( " on|off"), MSG_ERROR);
+			return false;
+		}
+
+		LodPolicy::instance()->setCulling( args[1] == "on");
+		LodPolicy::instance()->print();
+		return true;
+	}
+
+
+	/**
+	 * onSetBudget
+	 * Takes the milliseconds the Engine may spend per frame or "off".
+	 */
+	bool ConsoleInterpreter::onSetBudget( std::vector<String>& args)
+	{
+		float budget;
+		if( args.size() >= 2 && args[1] == "off")
+		{
+			LodPolicy::instance()->setBudget( 0);
+		}
+		else if( args.size() >= 2 && toFloat( args[1], budget) && budget > 0)
+		{
+			LodPolicy::instance()->setBudget( budget);
+		}
+		else
+		{
+			Trip::log( String("Usage: ").append( args[0]).append( " <milliseconds>|off"), MSG_ERROR);
+			return false;
+		}
+		LodPolicy::instance()->print();
+		return true;
+	}
+
+
+	/**
+	 * onSetPriority
+	 * Takes the priority of the selected Cluster. Clusters of a lower priority are slowed down first
+	 * when the frame budget is exceeded.
+	 */
+	bool ConsoleInterpreter::onSetPriority( std::vector<String>& args)
+	{
+		if( !isContext( CLUSTER))
+		{
+			Trip::log( "Select a Cluster to set its priority.", MSG_ERROR);
+			return false;
+		}
+		if( args.size() < 2 || !Util::isNumber( args[1]))
+		{
+			Trip::log( String("Usage: ").append( args[0]).append( " <priority>"), MSG_ERROR);
+			return false;
+		}
+
+		Cluster* cluster = _context_cluster_list.back();
+		cluster->setPriority( std::atoi( args[1].c_str()));
+		std::cout << "Priority of '" << cluster->getName() << "': " << cluster->getPriority() << std::endl;
+		return true;
+	}
+
+
 	/**
 	 * onFadeIn
 	 */
@@ -633,6 +1041,7 @@ namespace Trip
 		if( isContext( CLUSTER))
 		{
 			std::cout << "Cluster '" << _context_cluster_list.back()->getName() << "': " << std::endl;
+			std::cout << "priority: " << _context_cluster_list.back()->getPriority() << std::endl;
 			
 			// child clusters
 			onGetClusters( std::vector<String>());
@@ -2,7 +2,7 @@
  * This file contains an interpreter that can be used 
  * for console or script input in the Trip application.
  * @author barn
- * @version 20121030
+ * @version 20121210
  */
 #ifndef __ConsoleInterpreter_HPP__
 #define __ConsoleInterpreter_HPP__
@@ -123,8 +123,19 @@ namespace Trip
 		bool onPrintPrototypeClusters( ARGS);
 		bool onPrintPrototypeTransformers( ARGS);
 		bool onPrintPrototypeFunctions( ARGS);
+		bool onDefineFunction( ARGS);
+		bool onDefineKeyframes( ARGS);
+		bool onLoadKeyframes( ARGS);
+		bool onBakeFunction( ARGS);
+		bool onUnbakeFunction( ARGS);
 		bool onPrintPrototypeFadeFunctions( ARGS);
 		bool onPrintFrameInfo( ARGS);
+		bool onSetProfiling( ARGS);
+		bool onResetFrameInfo( ARGS);
+		bool onSetLod( ARGS);
+		bool onSetCulling( ARGS);
+		bool onSetBudget( ARGS);
+		bool onSetPriority( ARGS);
 		bool onFadeIn( ARGS);
 		bool onFadeOut( ARGS);
 		bool onEnable( ARGS);
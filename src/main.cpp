@@ -14,6 +14,12 @@
 #include <Registrator.hpp> // SEMI HACK
 
 #include <Engine.hpp>
+#include <FramePacer.hpp>
+#include <FrameStatistics.hpp>
+#include <LodPolicy.hpp>
+
+#include <stores/OgreNodeStore.hpp>
+#include <stores/HeadlessNodeStore.hpp>
 
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -23,6 +29,33 @@
 ///////////////////////////////////////////////////////////////////////////////
 // DEFINES and MACROS
 
+/// command line switch that runs the engine without a render system
+#define TRIP_HEADLESS_SWITCH "--headless"
+
+/// command line switch followed by the simulation rate in Hz, enables fixed simulation steps
+#define TRIP_SIM_RATE_SWITCH "--sim-rate"
+
+/// command line switch followed by a distance, updates Clusters beyond it less often
+#define TRIP_LOD_SWITCH "--lod"
+
+/// command line switch that updates Clusters outside the camera frustum less often
+#define TRIP_CULLING_SWITCH "--culling"
+
+/// command line switch followed by milliseconds, updates low-priority Clusters less often while the Engine takes longer per frame
+#define TRIP_BUDGET_SWITCH "--budget"
+
+/// command line switch that processes the thread-safe Clusters on a simulation thread, while the next frame is rendered
+#define TRIP_PIPELINED_SWITCH "--pipelined"
+
+/// command line switch followed by the frames per second to pace the main loop to
+#define TRIP_FPS_SWITCH "--fps"
+
+/// command line switch followed by seconds, stops simulating and rendering when nothing has happened for that long
+#define TRIP_IDLE_SWITCH "--idle"
+
+/// frames per second of the headless loop, unless set by TRIP_FPS_SWITCH
+#define TRIP_HEADLESS_FRAME_RATE 100
+
 ///////////////////////////////////////////////////////////////////////////////
 // NAMESPACE, CONSTANTS and TYPE DECLARATIONS/IMPLEMENTATIONS
 
@@ -34,11 +67,69 @@ Ogre::Root* initOgre( int argc, char** argv);
 
 void parseResourceFile( const char* fname, bool recursive = false);
 
+void initTrip( NodeStore* nodeStore);
+
+int runHeadless( float fixedStep, bool pipelined, FramePacer& pacer);
+
+void writeFrameStatistics();
+
 
 
 
 int main( int argc, char** argv)
 {
+	// dump the frame time histograms, also when exiting through the console
+	std::atexit( writeFrameStatistics);
+
+	// parse the command line
+	bool headless = false;
+	bool pipelined = false;
+	float fixed_step = 0;
+	FramePacer pacer;
+	for( int i = 1; i < argc; ++i)
+	{
+		if( String( argv[i]) == TRIP_HEADLESS_SWITCH)
+		{
+			headless = true;
+		}
+		else if( String( argv[i]) == TRIP_SIM_RATE_SWITCH && i + 1 < argc)
+		{
+			float rate = (float) std::atof( argv[++i]);
+			fixed_step = rate > 0 ? 1 / rate : 0;
+		}
+		else if( String( argv[i]) == TRIP_LOD_SWITCH && i + 1 < argc)
+		{
+			LodPolicy::instance()->setDistance( (float) std::atof( argv[++i]));
+			LodPolicy::instance()->setEnabled( true);
+		}
+		else if( String( argv[i]) == TRIP_CULLING_SWITCH)
+		{
+			LodPolicy::instance()->setCulling( true);
+		}
+		else if( String( argv[i]) == TRIP_PIPELINED_SWITCH)
+		{
+			pipelined = true;
+		}
+		else if( String( argv[i]) == TRIP_BUDGET_SWITCH && i + 1 < argc)
+		{
+			LodPolicy::instance()->setBudget( (float) std::atof( argv[++i]));
+		}
+		else if( String( argv[i]) == TRIP_FPS_SWITCH && i + 1 < argc)
+		{
+			pacer.setTargetRate( (float) std::atof( argv[++i]));
+		}
+		else if( String( argv[i]) == TRIP_IDLE_SWITCH && i + 1 < argc)
+		{
+			pacer.setIdleDelay( (float) std::atof( argv[++i]));
+		}
+	}
+
+	// run without a render system if asked to
+	if( headless)
+	{
+		return runHeadless( fixed_step, pipelined, pacer);
+	}
+
 	// set up ogre
 	Ogre::Root* ogre = initOgre( argc, argv);
 	if(!ogre)
@@ -50,22 +141,16 @@ int main( int argc, char** argv)
 	Ogre::RenderWindow* win = ogre->getAutoCreatedWindow();
 	ogre->setFrameSmoothingPeriod( 2.5f);
 	Ogre::SceneManager* scene_manager = ogre->createSceneManager(Ogre::ST_GENERIC, "scene_manager0");
+	OgreNodeStore node_store( scene_manager);
 
-	// enforce an eager manager initialization
-	FunctionManager::instance();
 	TripVarManager* varman = TripVarManager::instance();
 	varman->setWinDimensions( win->getWidth(), win->getHeight());
 	varman->setSceneManager( scene_manager);
-	ClusterManager::setup( scene_manager);
-	TransformerManager::instance();
 
 	// init all resource groups TODO maybe not necessary all the time...
 	Ogre::ResourceGroupManager::getSingleton().initialiseAllResourceGroups();
 
-	// init Functions, Transformers, Clusters
-	Trip::Registrator::registerFunctions();
-	Trip::Registrator::registerTransformers();
-	Trip::Registrator::registerClusters();
+	initTrip( &node_store);
 
 	// this is a HACK
 	{
@@ -78,6 +163,8 @@ int main( int argc, char** argv)
 		camera0->setAspectRatio( Ogre::Real( viewport0->getActualWidth())/
 									Ogre::Real( viewport0->getActualHeight()));
 
+		varman->setCam( camera0);
+
 	} // END HACK
 
 	// Set up console input
@@ -87,37 +174,189 @@ int main( int argc, char** argv)
 
 	// Connect the engine
 	Engine* engine = new Engine();
+	engine->setThreadCount( boost::thread::hardware_concurrency());
+	engine->setFixedStep( fixed_step);
+	engine->setPipelined( pipelined);
 	ogre->addFrameListener( engine);
 
+	// wake up on window events
+	Ogre::WindowEventUtilities::addWindowEventListener( win, &pacer);
+
 	// render loop
+	FrameStatistics* stats = FrameStatistics::instance();
+	Clock::Ticks frame_start = Clock::now();
+	bool paused = false;
 	while(true)
 	{
-		if (win->isActive())
+		// a moving scene keeps the loop awake
+		if( engine->isAnimating())
+		{
+			pacer.notifyActivity();
+		}
+
+		bool rendered = false;
+		if (win->isActive() && !pacer.isIdle())
 		{
+		   // do not simulate the time the loop has been paused
+		   if( paused)
+		   {
+			   ogre->clearEventTimes();
+		   }
+
+		   Clock::Ticks render_start = Clock::now();
 		   ogre->renderOneFrame();
+		   rendered = true;
+
+		   // the simulation runs within renderOneFrame()
+		   stats->record( FrameStatistics::PHASE_RENDER, Clock::now() - render_start - stats->getLast( FrameStatistics::PHASE_SIMULATION));
 		}
-		else if (win->isVisible())
+		else if (!win->isActive() && win->isVisible())
 		{
 		   win->setActive(true);
 		}
+		paused = !rendered;
 
 		Ogre::WindowEventUtilities::messagePump();
 
 
 		if( input_grabber.isReady())
 		{
+			Clock::Ticks interpreter_start = Clock::now();
+			pacer.notifyActivity();
+
+			// the command may change the Cluster-tree
+			engine->synchronize();
 			console_interpreter.interprete( input_grabber.getLine());
 			input_grabber.runThread( console_interpreter.getContextString());
+			stats->record( FrameStatistics::PHASE_INTERPRETER, Clock::now() - interpreter_start);
 		}
+
+		// the pacing is not part of the frame time, paused loops are no frames
+		if( rendered)
+		{
+			stats->record( FrameStatistics::PHASE_FRAME, Clock::now() - frame_start);
+		}
+
+		pacer.wait( rendered);
+		frame_start = Clock::now();
 	}
 
 	// TODO... be tidy
+	Ogre::WindowEventUtilities::removeWindowEventListener( win, &pacer);
 	delete engine;
 	delete ogre;
 	return 0;
 }
 
 
+/**
+ * Sets up the managers and registers all Functions, Transformers and Clusters.
+ * @param nodeStore The NodeStore in which the Clusters create their Nodes.
+ */
+void initTrip( NodeStore* nodeStore)
+{
+	// enforce an eager manager initialization
+	FunctionManager::instance();
+	TripVarManager::instance()->setNodeStore( nodeStore);
+	ClusterManager::setup( nodeStore);
+	TransformerManager::instance();
+
+	// init Functions, Transformers, Clusters
+	Trip::Registrator::registerFunctions();
+	Trip::Registrator::registerTransformers();
+	Trip::Registrator::registerClusters();
+}
+
+
+/**
+ * Writes the frame time histograms into TRIP_FRAME_STATISTICS_FILE.
+ * Registered with atexit().
+ */
+void writeFrameStatistics()
+{
+	FrameStatistics::instance()->writeCsv( TRIP_FRAME_STATISTICS_FILE);
+}
+
+
+/**
+ * Runs the Engine and the console without any render system.
+ * All Nodes are kept in plain memory.
+ * @param fixedStep The duration of a simulation step in seconds or 0 to simulate one step per frame.
+ * @param pipelined Indicates whether the thread-safe Clusters shall be processed on a simulation thread.
+ * @param pacer The FramePacer of the loop. Paces to TRIP_HEADLESS_FRAME_RATE if it has no target rate.
+ * @return The exit code of the application.
+ */
+int runHeadless( float fixedStep, bool pipelined, FramePacer& pacer)
+{
+	HeadlessNodeStore node_store;
+	initTrip( &node_store);
+
+	// Set up console input
+	ConsoleInputGrabber input_grabber;
+	ConsoleInterpreter console_interpreter( TRIP_CONSOLE_SYNTAX_MAP_FILE, TRIP_CONSOLE_SYNTAX);
+	input_grabber.runThread( console_interpreter.getContextString());
+
+	Engine* engine = new Engine();
+	engine->setThreadCount( boost::thread::hardware_concurrency());
+	engine->setFixedStep( fixedStep);
+	engine->setPipelined( pipelined);
+
+	if( pacer.getTargetRate() <= 0)
+	{
+		pacer.setTargetRate( TRIP_HEADLESS_FRAME_RATE);
+	}
+
+	// simulation loop
+	FrameStatistics* stats = FrameStatistics::instance();
+	Ogre::Timer timer;
+	unsigned long last_frame = timer.getMicroseconds();
+	Clock::Ticks frame_start = Clock::now();
+	while(true)
+	{
+		// a moving scene keeps the loop awake
+		if( engine->isAnimating())
+		{
+			pacer.notifyActivity();
+		}
+
+		// do not simulate the time the loop has been paused
+		unsigned long now = timer.getMicroseconds();
+		const bool simulated = !pacer.isIdle();
+		if( simulated)
+		{
+			engine->step( (now - last_frame) * 0.000001f);
+			node_store.update();
+		}
+		last_frame = now;
+
+		if( input_grabber.isReady())
+		{
+			Clock::Ticks interpreter_start = Clock::now();
+			pacer.notifyActivity();
+
+			// the command may change the Cluster-tree
+			engine->synchronize();
+			console_interpreter.interprete( input_grabber.getLine());
+			input_grabber.runThread( console_interpreter.getContextString());
+			stats->record( FrameStatistics::PHASE_INTERPRETER, Clock::now() - interpreter_start);
+		}
+
+		// the pacing is not part of the frame time, paused loops are no frames
+		if( simulated)
+		{
+			stats->record( FrameStatistics::PHASE_FRAME, Clock::now() - frame_start);
+		}
+
+		pacer.wait( simulated);
+		frame_start = Clock::now();
+	}
+
+	// TODO... be tidy
+	delete engine;
+	return 0;
+}
+
+
 /**
  * Initializes OGRE.
  * @param argc The argument counter, maybe the according parameter of the main function.
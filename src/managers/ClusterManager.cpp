@@ -35,7 +35,6 @@ namespace Trip
 	/**
 	 * Retrieves the singleton instance of the ClusterManager.
 	 * Before you call this method, setup() should be called once.
-	 * @param sceneManager The Ogre::SceneManager to which to connect the whole stuff.
 	 * @return The singleton ClusterManager or NULL, if setup() is not called.
 	 * @see setup()
 	 */
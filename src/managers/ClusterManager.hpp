@@ -55,11 +55,13 @@ namespace Trip
 
 		/**
 		 * Protected main constructor.
-		 * @param sceneManager The Ogre::SceneManager to which to connect the whole stuff.
+		 * @param nodeStore The NodeStore to which to connect the whole stuff.
 		 */
-		ClusterManager( Ogre::SceneManager* sceneManager)
-			: _root_cluster( new Cluster( sceneManager, "root"))
-		{}
+		ClusterManager( NodeStore* nodeStore)
+			: _root_cluster( new Cluster( nodeStore, "root"))
+		{
+			nodeStore->getRootNode()->addChild( _root_cluster->getClusterNode());
+		}
 
 	public: // destructor
 
@@ -78,21 +80,20 @@ namespace Trip
 		/**
 		 * Sets up the singleton instance of the ClusterManager.
 		 * Only sets it up, if the singleton instance is NULL.
-		 * @param sceneManager The Ogre::SceneManager to which to connect the whole stuff.
+		 * @param nodeStore The NodeStore to which to connect the whole stuff.
 		 * @return The singleton ClusterManager.
 		 * @see instance()
 		 */
-		static ClusterManager* setup( Ogre::SceneManager* sceneManager)
+		static ClusterManager* setup( NodeStore* nodeStore)
 		{
 			if (__instance == 0)
-				__instance = new ClusterManager(sceneManager);
+				__instance = new ClusterManager(nodeStore);
 			return __instance;
 		}
 
 		/**
 		 * Retrieves the singleton instance of the ClusterManager.
 		 * Before you call this method, setup() should be called once.
-		 * @param sceneManager The Ogre::SceneManager to which to connect the whole stuff.
 		 * @return The singleton ClusterManager or NULL, if setup() is not called.
 		 * @see setup()
 		 */
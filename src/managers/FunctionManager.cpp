@@ -66,14 +66,19 @@ namespace Trip
 	 * Beware that this method does no error checking if a prototype does really exist.
 	 * @param name The name of the prototype which is to be used for creation.
 	 * @return A new Function that should be a clone of the given prototype.
+	 * It shares the baked table of the prototype, if there is one.
 	 * Returns null, if the specified prototype does not exist.
 	 * @see addPrototype()
 	 */
 	Function* FunctionManager::createFunction( const String& name)
 	{
 		auto it = _prototype_functions.find( name);
+		if( it == _prototype_functions.end())
+			return 0;
 
-		return (it == _prototype_functions.end() ? 0 : it->second->clone() );
+		Function* function = it->second->clone();
+		function->shareTable( *it->second);
+		return function;
 	}
 
 
@@ -108,7 +113,9 @@ namespace Trip
 			it++;
 		}
 
-		return it->second->clone();
+		Function* function = it->second->clone();
+		function->shareTable( *it->second);
+		return function;
 	}
 
 
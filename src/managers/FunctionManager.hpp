@@ -122,11 +122,24 @@ namespace Trip
 		 * Beware that this method does no error checking if a prototype does really exist.
 		 * @param name The name of the prototype which is to be used for creation.
 		 * @return A new Function that should be a clone of the given prototype.
+		 * It shares the baked table of the prototype, if there is one.
 		 * Returns null, if the specified prototype does not exist.
 		 * @see addPrototype()
 		 */
 		Function* createFunction( const String& name);
 
+		/**
+		 * Retrieves a prototype without cloning it.
+		 * @param name The name of the prototype.
+		 * @return The prototype or NULL, if there is no prototype with that name.
+		 */
+		Function* getPrototype( const String& name)
+		{
+			auto it = _prototype_functions.find( name);
+
+			return (it == _prototype_functions.end() ? 0 : it->second);
+		}
+
 		/**
 		 * Creates a random Function from a prototype.
 		 * @return A new Function that is a clone of some prototype.
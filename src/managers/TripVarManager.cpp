@@ -38,11 +38,20 @@ namespace Trip
 
 	/**
 	 * Main constructor.
+	 * Takes the window dimensions from Ogre's auto created window, if there is one.
 	 */
 	TripVarManager::TripVarManager()
+		: _win_dimensions( 0, 0),
+		_scene_manager(0),
+		_node_store(0),
+		_cam(0)
 	{
-		Ogre::RenderWindow* win = Ogre::Root::getSingletonPtr()->getAutoCreatedWindow();
-		_win_dimensions = std::pair<unsigned int,unsigned int>( win->getWidth(), win->getHeight());
+		Ogre::Root* root = Ogre::Root::getSingletonPtr();
+		Ogre::RenderWindow* win = root ? root->getAutoCreatedWindow() : 0;
+		if( win)
+		{
+			_win_dimensions = std::pair<unsigned int,unsigned int>( win->getWidth(), win->getHeight());
+		}
 
 		_cam_pos_spherical[0] = 0;
 		_cam_pos_spherical[1] = 0;
@@ -30,9 +30,11 @@
 
 namespace Trip
 {
+	class NodeStore;
 
 	/**
 	 * This class is a resource manager for global resources in the TRiP framework.
+	 * It does not require a render window, so it can also be used when running headless.
 	 */
 	class TripVarManager
 	{
@@ -49,6 +51,9 @@ namespace Trip
 		/// Stores the SceneManager
 		Ogre::SceneManager* _scene_manager;
 
+		/// Stores the NodeStore that creates the Nodes of new Clusters.
+		NodeStore* _node_store;
+
 	public: // instance vars // TODO put them into private
 
 		/// The spherical coordinates of the camera. radius - azimuth - inclination.
@@ -131,6 +136,25 @@ namespace Trip
 			return _scene_manager;
 		}
 
+		/**
+		 * Sets the NodeStore that will be used by new Clusters.
+		 * The TripVarManager does not take ownership of the store.
+		 * @param nodeStore The NodeStore to be used.
+		 */
+		void setNodeStore( NodeStore* nodeStore)
+		{
+			_node_store = nodeStore;
+		}
+
+		/**
+		 * Retrieves the NodeStore that will be used by new Clusters.
+		 * @return The NodeStore or NULL, if none is set.
+		 */
+		NodeStore* getNodeStore()
+		{
+			return _node_store;
+		}
+
 		/**
 		 * Sets the camera position in a spherical manner around the coordinate center.
 		 * Does not really affect the camera itself, but the spherical coordinates, which you can
@@ -0,0 +1,166 @@
+/**
+ * This file contains the HeadlessNodeStore, which keeps all Nodes in plain memory
+ * and runs without any render system.
+ * @author barn
+ * @version 20121123
+ */
+#ifndef __HeadlessNodeStore_HPP__
+#define __HeadlessNodeStore_HPP__
+
+/*===========================================================================*
+ * INCLUDES base definition file for DLL import/export
+ *===========================================================================*/
+
+/*===========================================================================*
+ * INCLUDES project headers
+ *===========================================================================*/
+#include "stdafx.h"
+#include <stores/NodeStore.hpp>
+
+/*===========================================================================*
+ * INCLUDES C/C++ standard library (and other external libraries)
+ *===========================================================================*/
+
+/*===========================================================================*
+ * DEFINES and MACROS
+ *===========================================================================*/
+
+/*===========================================================================*
+ * NAMESPACE, CONSTANTS and TYPE DECLARATIONS/IMPLEMENTATIONS
+ *===========================================================================*/
+
+namespace Trip
+{
+
+	/**
+	 * A plain Node that only stores its transform and its children.
+	 * It needs neither a SceneManager nor a render system.
+	 */
+	class HeadlessNode : public Ogre::Node
+	{
+	public: // constructor & destructor
+
+		/**
+		 * Main constructor.
+		 * The Node gets a generated name.
+		 */
+		HeadlessNode()
+			: Ogre::Node()
+		{}
+
+		/**
+		 * 2nd constructor.
+		 * @param name The name of the Node.
+		 */
+		HeadlessNode( const String& name)
+			: Ogre::Node( name)
+		{}
+
+		/**
+		 * Destructor.
+		 */
+		~HeadlessNode()
+		{}
+
+	protected: // helpers
+
+		/// Method derived by Ogre::Node. Creates an unattached child of the same type.
+		Ogre::Node* createChildImpl()
+		{
+			return new HeadlessNode();
+		}
+
+		/// Method derived by Ogre::Node. Creates an unattached child of the same type.
+		Ogre::Node* createChildImpl( const String& name)
+		{
+			return new HeadlessNode( name);
+		}
+
+	}; // END class HeadlessNode
+
+
+	/**
+	 * The HeadlessNodeStore keeps all Nodes as HeadlessNodes in plain memory.
+	 * Use it to run the Engine without a window, e.g. for benchmarks or on machines without a GPU.
+	 * Since nothing is rendered, call update() once per frame after the Engine has processed
+	 * the Nodes, if you need their derived transforms.
+	 */
+	class HeadlessNodeStore : public NodeStore
+	{
+	private: // vars
+
+		/// The root of all Nodes.
+		HeadlessNode _root;
+
+	public: // constructor & destructor
+
+		/**
+		 * Main constructor.
+		 */
+		HeadlessNodeStore()
+			: _root( "root")
+		{}
+
+		/**
+		 * Destructor.
+		 * Nodes that have not been destroyed yet will be detached from the root.
+		 */
+		~HeadlessNodeStore()
+		{}
+
+	public: // methods
+
+		/**
+		 * Destroys a Node that was created by this store.
+		 * @param node The Node to destroy.
+		 */
+		void destroyNode( Ogre::Node* node)
+		{
+			delete node;
+		}
+
+		/**
+		 * Updates the derived transforms of all Nodes attached to the root Node.
+		 */
+		void update()
+		{
+			_root._update( true, false);
+		}
+
+	public: // getters & setters
+
+		/**
+		 * Retrieves the root of all Nodes.
+		 * @return The root Node.
+		 */
+		Ogre::Node* getRootNode()
+		{
+			return &_root;
+		}
+
+	protected: // helpers
+
+		/**
+		 * Creates a single HeadlessNode that is not attached to any parent.
+		 * @return The new Node.
+		 */
+		Ogre::Node* newNode()
+		{
+			return new HeadlessNode();
+		}
+
+		/**
+		 * Creates a single named HeadlessNode that is not attached to any parent.
+		 * @param name The name of the Node.
+		 * @return The new Node.
+		 */
+		Ogre::Node* newNode( const String& name)
+		{
+			return new HeadlessNode( name);
+		}
+
+	}; // END class HeadlessNodeStore
+
+} // END namespace Trip
+
+#endif /* __HeadlessNodeStore_HPP__ */
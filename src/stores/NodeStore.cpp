@@ -0,0 +1,73 @@
+/**
+ * Implementation file for the NodeStore.hpp.
+ * @author barn
+ * @version 20121123
+ */
+
+/*===========================================================================*
+ * INCLUDES (associated header files)
+ *===========================================================================*/
+#include "NodeStore.hpp"
+
+/*===========================================================================*
+ * INCLUDES project headers
+ *===========================================================================*/
+
+/*===========================================================================*
+ * INCLUDES C/C++ standard library (and other external libraries)
+ *===========================================================================*/
+
+/*===========================================================================*
+ * DEFINES and MACROS
+ *===========================================================================*/
+
+/*===========================================================================*
+ * NAMESPACE, CONSTANTS and TYPE DECLARATIONS/IMPLEMENTATIONS
+ *===========================================================================*/
+
+namespace Trip
+{
+
+	/**
+	 * Creates a Node and attaches it to the given parent.
+	 * @param parent The parent of the new Node or NULL to keep the Node unattached.
+	 * @param translate Initial translation offset of the Node relative to its parent.
+	 * @param rotate Initial rotation relative to the parent.
+	 * @return The new Node.
+	 */
+	Ogre::Node* NodeStore::createNode( Ogre::Node* parent, const Ogre::Vector3& translate, const Ogre::Quaternion& rotate)
+	{
+		Ogre::Node* node = newNode();
+		node->setPosition( translate);
+		node->setOrientation( rotate);
+
+		if( parent)
+		{
+			parent->addChild( node);
+		}
+		return node;
+	}
+
+
+	/**
+	 * Creates a named Node and attaches it to the given parent.
+	 * @param name The name of the Node.
+	 * @param parent The parent of the new Node or NULL to keep the Node unattached.
+	 * @param translate Initial translation offset of the Node relative to its parent.
+	 * @param rotate Initial rotation relative to the parent.
+	 * @return The new Node.
+	 */
+	Ogre::Node* NodeStore::createNode( const String& name, Ogre::Node* parent, const Ogre::Vector3& translate, const Ogre::Quaternion& rotate)
+	{
+		Ogre::Node* node = newNode( name);
+		node->setPosition( translate);
+		node->setOrientation( rotate);
+
+		if( parent)
+		{
+			parent->addChild( node);
+		}
+		return node;
+	}
+
+} // END namespace Trip
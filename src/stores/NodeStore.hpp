@@ -0,0 +1,140 @@
+/**
+ * This file contains the NodeStore interface, which creates and destroys
+ * the Nodes the Clusters and Transformers work on.
+ * @author barn
+ * @version 20121123
+ */
+#ifndef __NodeStore_HPP__
+#define __NodeStore_HPP__
+
+/*===========================================================================*
+ * INCLUDES base definition file for DLL import/export
+ *===========================================================================*/
+
+/*===========================================================================*
+ * INCLUDES project headers
+ *===========================================================================*/
+#include "stdafx.h"
+
+/*===========================================================================*
+ * INCLUDES C/C++ standard library (and other external libraries)
+ *===========================================================================*/
+
+/*===========================================================================*
+ * DEFINES and MACROS
+ *===========================================================================*/
+
+/*===========================================================================*
+ * NAMESPACE, CONSTANTS and TYPE DECLARATIONS/IMPLEMENTATIONS
+ *===========================================================================*/
+
+namespace Trip
+{
+
+	/**
+	 * The NodeStore is the storage of all Nodes and their transforms that the Engine processes.
+	 * Clusters create and destroy their Nodes only through a NodeStore, so that the
+	 * Cluster-tree does not depend on a specific scene representation.
+	 *
+	 * The OgreNodeStore keeps the Nodes in an Ogre::SceneManager and lets Ogre render them.
+	 * The HeadlessNodeStore keeps the Nodes in plain memory and runs without any render system.
+	 *
+	 * When you create your own subclasses, you have to override those methods:
+	 * newNode() - creates a single Node that is not attached to any parent, with or without a name;
+	 * destroyNode() - destroys a Node created by this store;
+	 * getRootNode() - retrieves the root of all Nodes.
+	 *
+	 * @see OgreNodeStore
+	 * @see HeadlessNodeStore
+	 */
+	class NodeStore
+	{
+	public: // constructor & destructor
+
+		/**
+		 * Main constructor.
+		 */
+		NodeStore()
+		{}
+
+		/**
+		 * Destructor.
+		 */
+		virtual ~NodeStore()
+		{}
+
+	public: // methods
+
+		/**
+		 * Creates a Node and attaches it to the given parent.
+		 * @param parent The parent of the new Node or NULL to keep the Node unattached.
+		 * @param translate Initial translation offset of the Node relative to its parent.
+		 * @param rotate Initial rotation relative to the parent.
+		 * @return The new Node.
+		 */
+		Ogre::Node* createNode( Ogre::Node* parent, const Ogre::Vector3& translate = Ogre::Vector3::ZERO, const Ogre::Quaternion& rotate = Ogre::Quaternion::IDENTITY);
+
+		/**
+		 * Creates a named Node and attaches it to the given parent.
+		 * @param name The name of the Node.
+		 * @param parent The parent of the new Node or NULL to keep the Node unattached.
+		 * @param translate Initial translation offset of the Node relative to its parent.
+		 * @param rotate Initial rotation relative to the parent.
+		 * @return The new Node.
+		 */
+		Ogre::Node* createNode( const String& name, Ogre::Node* parent, const Ogre::Vector3& translate = Ogre::Vector3::ZERO, const Ogre::Quaternion& rotate = Ogre::Quaternion::IDENTITY);
+
+		/**
+		 * Destroys a Node that was created by this store.
+		 * The Node will be detached from its parent, its children will be detached from it.
+		 * @param node The Node to destroy.
+		 */
+		virtual void destroyNode( Ogre::Node* node) = 0;
+
+		/**
+		 * Updates the derived transforms of all Nodes attached to the root Node.
+		 * Does nothing by default, since a renderer updates them on its own.
+		 */
+		virtual void update()
+		{
+			/* EMPTY IMPLEMENTATION */
+		}
+
+	public: // getters & setters
+
+		/**
+		 * Retrieves the root of all Nodes of the store.
+		 * @return The root Node.
+		 */
+		virtual Ogre::Node* getRootNode() = 0;
+
+		/**
+		 * Retrieves the Ogre::SceneManager that holds the Nodes.
+		 * Use it to attach renderable objects to Nodes.
+		 * @return The SceneManager or NULL, if the store does not render.
+		 */
+		virtual Ogre::SceneManager* getSceneManager()
+		{
+			return 0;
+		}
+
+	protected: // helpers
+
+		/**
+		 * Creates a single Node that is not attached to any parent.
+		 * @return The new Node.
+		 */
+		virtual Ogre::Node* newNode() = 0;
+
+		/**
+		 * Creates a single named Node that is not attached to any parent.
+		 * @param name The name of the Node.
+		 * @return The new Node.
+		 */
+		virtual Ogre::Node* newNode( const String& name) = 0;
+
+	}; // END class NodeStore
+
+} // END namespace Trip
+
+#endif /* __NodeStore_HPP__ */
@@ -0,0 +1,61 @@
+/**
+ * Implementation file for the OgreNodeStore.hpp.
+ * @author barn
+ * @version 20121123
+ */
+
+/*===========================================================================*
+ * INCLUDES (associated header files)
+ *===========================================================================*/
+#include "OgreNodeStore.hpp"
+
+/*===========================================================================*
+ * INCLUDES project headers
+ *===========================================================================*/
+
+/*===========================================================================*
+ * INCLUDES C/C++ standard library (and other external libraries)
+ *===========================================================================*/
+
+/*===========================================================================*
+ * DEFINES and MACROS
+ *===========================================================================*/
+
+/*===========================================================================*
+ * NAMESPACE, CONSTANTS and TYPE DECLARATIONS/IMPLEMENTATIONS
+ *===========================================================================*/
+
+namespace Trip
+{
+
+	/**
+	 * Destroys a SceneNode that was created by this store.
+	 * @param node The SceneNode to destroy.
+	 */
+	void OgreNodeStore::destroyNode( Ogre::Node* node)
+	{
+		_scene_manager->destroySceneNode( static_cast<Ogre::SceneNode*>( node));
+	}
+
+
+	/**
+	 * Creates a single SceneNode that is not attached to any parent.
+	 * @return The new SceneNode.
+	 */
+	Ogre::Node* OgreNodeStore::newNode()
+	{
+		return _scene_manager->createSceneNode();
+	}
+
+
+	/**
+	 * Creates a single named SceneNode that is not attached to any parent.
+	 * @param name The name of the SceneNode.
+	 * @return The new SceneNode.
+	 */
+	Ogre::Node* OgreNodeStore::newNode( const String& name)
+	{
+		return _scene_manager->createSceneNode( name);
+	}
+
+} // END namespace Trip
@@ -0,0 +1,110 @@
+/**
+ * This file contains the OgreNodeStore, which keeps all Nodes
+ * as SceneNodes of an Ogre::SceneManager.
+ * @author barn
+ * @version 20121123
+ */
+#ifndef __OgreNodeStore_HPP__
+#define __OgreNodeStore_HPP__
+
+/*===========================================================================*
+ * INCLUDES base definition file for DLL import/export
+ *===========================================================================*/
+
+/*===========================================================================*
+ * INCLUDES project headers
+ *===========================================================================*/
+#include "stdafx.h"
+#include <stores/NodeStore.hpp>
+
+/*===========================================================================*
+ * INCLUDES C/C++ standard library (and other external libraries)
+ *===========================================================================*/
+
+/*===========================================================================*
+ * DEFINES and MACROS
+ *===========================================================================*/
+
+/*===========================================================================*
+ * NAMESPACE, CONSTANTS and TYPE DECLARATIONS/IMPLEMENTATIONS
+ *===========================================================================*/
+
+namespace Trip
+{
+
+	/**
+	 * The OgreNodeStore creates all Nodes as Ogre::SceneNodes of the given SceneManager,
+	 * so that they are rendered by Ogre. Every Node it creates can be cast to an Ogre::SceneNode.
+	 * Ogre updates the derived transforms while rendering, so update() does nothing.
+	 */
+	class OgreNodeStore : public NodeStore
+	{
+	private: // vars
+
+		/// The SceneManager that holds all the Nodes.
+		Ogre::SceneManager* _scene_manager;
+
+	public: // constructor & destructor
+
+		/**
+		 * Main constructor.
+		 * @param sceneManager The SceneManager in which to create the Nodes.
+		 */
+		OgreNodeStore( Ogre::SceneManager* sceneManager)
+			: _scene_manager( sceneManager)
+		{}
+
+		/**
+		 * Destructor.
+		 */
+		~OgreNodeStore()
+		{}
+
+	public: // methods
+
+		/**
+		 * Destroys a SceneNode that was created by this store.
+		 * @param node The SceneNode to destroy.
+		 */
+		void destroyNode( Ogre::Node* node);
+
+	public: // getters & setters
+
+		/**
+		 * Retrieves the root SceneNode of the SceneManager.
+		 * @return The root Node.
+		 */
+		Ogre::Node* getRootNode()
+		{
+			return _scene_manager->getRootSceneNode();
+		}
+
+		/**
+		 * Retrieves the Ogre::SceneManager that holds the Nodes.
+		 * @return The SceneManager.
+		 */
+		Ogre::SceneManager* getSceneManager()
+		{
+			return _scene_manager;
+		}
+
+	protected: // helpers
+
+		/**
+		 * Creates a single SceneNode that is not attached to any parent.
+		 * @return The new SceneNode.
+		 */
+		Ogre::Node* newNode();
+
+		/**
+		 * Creates a single named SceneNode that is not attached to any parent.
+		 * @param name The name of the SceneNode.
+		 * @return The new SceneNode.
+		 */
+		Ogre::Node* newNode( const String& name);
+
+	}; // END class OgreNodeStore
+
+} // END namespace Trip
+
+#endif /* __OgreNodeStore_HPP__ */
@@ -0,0 +1,117 @@
+/**
+ * Implementation file for the TransformDelta.hpp.
+ * @author barn
+ * @version 20121130
+ */
+
+/*===========================================================================*
+ * INCLUDES (associated header files)
+ *===========================================================================*/
+#include "TransformDelta.hpp"
+
+/*===========================================================================*
+ * INCLUDES project headers
+ *===========================================================================*/
+#include <util/SimdMath.hpp>
+
+/*===========================================================================*
+ * INCLUDES C/C++ standard library (and other external libraries)
+ *===========================================================================*/
+
+/*===========================================================================*
+ * DEFINES and MACROS
+ *===========================================================================*/
+
+/*===========================================================================*
+ * NAMESPACE, CONSTANTS and TYPE DECLARATIONS/IMPLEMENTATIONS
+ *===========================================================================*/
+
+namespace Trip
+{
+
+	/**
+	 * Commits deltas to a range of Nodes, TRIP_SIMD_WIDTH Nodes at a time.
+	 * The current transforms and the changes are gathered into batches, combined with the SimdMath
+	 * and written back to the Nodes whose delta changes the component. Unused lanes get neutral values.
+	 * @param nodes The first Node of the range.
+	 * @param deltas The delta of the first Node.
+	 * @param step The distance between the deltas of two Nodes, 0 to commit the same delta to all.
+	 * @param count The number of Nodes.
+	 */
+	void TransformDelta::commitLanes( Ogre::Node* const* nodes, const TransformDelta* deltas, uint step, uint count)
+	{
+		QuaternionBatch orientation, rotation;
+		Vector3Batch vector, change;
+
+		for( uint base = 0; base < count; base += TRIP_SIMD_WIDTH)
+		{
+			Ogre::Node* const* lane_nodes = nodes + base;
+			const TransformDelta* lane_deltas = deltas + base * step;
+			const uint n = std::min<uint>( TRIP_SIMD_WIDTH, count - base);
+
+			uint changes = 0;
+			for( uint i = 0; i < n; ++i)
+			{
+				changes |= lane_deltas[i * step]._changes;
+			}
+
+			if( changes & CHANGED_POSITION)
+			{
+				for( uint i = 0; i < TRIP_SIMD_WIDTH; ++i)
+				{
+					const Ogre::Vector3& p = i < n ? lane_nodes[i]->getPosition() : Ogre::Vector3::ZERO;
+					const Ogre::Vector3& d = i < n ? lane_deltas[i * step]._translation : Ogre::Vector3::ZERO;
+					vector.x[i] = p.x; vector.y[i] = p.y; vector.z[i] = p.z;
+					change.x[i] = d.x; change.y[i] = d.y; change.z[i] = d.z;
+				}
+
+				SimdMath::translate( vector, change);
+
+				for( uint i = 0; i < n; ++i)
+				{
+					if( lane_deltas[i * step]._changes & CHANGED_POSITION)
+						lane_nodes[i]->setPosition( vector.x[i], vector.y[i], vector.z[i]);
+				}
+			}
+
+			if( changes & CHANGED_ORIENTATION)
+			{
+				for( uint i = 0; i < TRIP_SIMD_WIDTH; ++i)
+				{
+					const Ogre::Quaternion& q = i < n ? lane_nodes[i]->getOrientation() : Ogre::Quaternion::IDENTITY;
+					const Ogre::Quaternion& r = i < n ? lane_deltas[i * step]._rotation : Ogre::Quaternion::IDENTITY;
+					orientation.w[i] = q.w; orientation.x[i] = q.x; orientation.y[i] = q.y; orientation.z[i] = q.z;
+					rotation.w[i] = r.w; rotation.x[i] = r.x; rotation.y[i] = r.y; rotation.z[i] = r.z;
+				}
+
+				SimdMath::multiply( orientation, rotation, orientation);
+
+				for( uint i = 0; i < n; ++i)
+				{
+					if( lane_deltas[i * step]._changes & CHANGED_ORIENTATION)
+						lane_nodes[i]->setOrientation( orientation.w[i], orientation.x[i], orientation.y[i], orientation.z[i]);
+				}
+			}
+
+			if( changes & CHANGED_SCALE)
+			{
+				for( uint i = 0; i < TRIP_SIMD_WIDTH; ++i)
+				{
+					const Ogre::Vector3& s = i < n ? lane_nodes[i]->getScale() : Ogre::Vector3::UNIT_SCALE;
+					const Ogre::Vector3& f = i < n ? lane_deltas[i * step]._scale : Ogre::Vector3::UNIT_SCALE;
+					vector.x[i] = s.x; vector.y[i] = s.y; vector.z[i] = s.z;
+					change.x[i] = f.x; change.y[i] = f.y; change.z[i] = f.z;
+				}
+
+				SimdMath::scale( vector, change);
+
+				for( uint i = 0; i < n; ++i)
+				{
+					if( lane_deltas[i * step]._changes & CHANGED_SCALE)
+						lane_nodes[i]->setScale( vector.x[i], vector.y[i], vector.z[i]);
+				}
+			}
+		}
+	}
+
+} // END namespace Trip
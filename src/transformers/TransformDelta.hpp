@@ -0,0 +1,229 @@
+/**
+ * This file contains the TransformDelta, which collects the changes
+ * several Transformers make to one Node within a frame.
+ * @author barn
+ * @version 20121130
+ */
+#ifndef __TransformDelta_HPP__
+#define __TransformDelta_HPP__
+
+/*===========================================================================*
+ * INCLUDES base definition file for DLL import/export
+ *===========================================================================*/
+
+/*===========================================================================*
+ * INCLUDES project headers
+ *===========================================================================*/
+#include "stdafx.h"
+
+/*===========================================================================*
+ * INCLUDES C/C++ standard library (and other external libraries)
+ *===========================================================================*/
+
+/*===========================================================================*
+ * DEFINES and MACROS
+ *===========================================================================*/
+
+/*===========================================================================*
+ * NAMESPACE, CONSTANTS and TYPE DECLARATIONS/IMPLEMENTATIONS
+ *===========================================================================*/
+
+namespace Trip
+{
+
+	/**
+	 * A TransformDelta accumulates translations, rotations and scalings for one Node
+	 * and applies them with a single update per component in commit().
+	 * The result is the same as calling Ogre::Node::translate() in parent space,
+	 * Ogre::Node::rotate() in local space and Ogre::Node::scale() in the same order,
+	 * since each kind of change is independent of the others.
+	 *
+	 * Accumulating Transformers only write into their TransformDeltas, so they never
+	 * touch a Node and never make Ogre recompute anything before the commit.
+	 * Ranges of Nodes are committed with commitBatch() and commitShared(), which
+	 * compute TRIP_SIMD_WIDTH Nodes at once with the SimdMath.
+	 */
+	class TransformDelta
+	{
+	private: // nested types
+
+		/// Flags for the components that have been changed.
+		enum Changes
+		{
+			CHANGED_POSITION = 1,
+			CHANGED_ORIENTATION = 2,
+			CHANGED_SCALE = 4
+		};
+
+	private: // vars
+
+		/// The accumulated translation in parent space.
+		Ogre::Vector3 _translation;
+
+		/// The accumulated rotation in local space.
+		Ogre::Quaternion _rotation;
+
+		/// The accumulated scale factors.
+		Ogre::Vector3 _scale;
+
+		/// The components that have been changed since the last reset().
+		uint _changes;
+
+	public: // constructor & destructor
+
+		/**
+		 * Main constructor.
+		 * Creates a delta that does not change anything.
+		 */
+		TransformDelta()
+			: _translation( Ogre::Vector3::ZERO),
+			_rotation( Ogre::Quaternion::IDENTITY),
+			_scale( Ogre::Vector3::UNIT_SCALE),
+			_changes(0)
+		{}
+
+	public: // methods
+
+		/**
+		 * Forgets all accumulated changes.
+		 */
+		void reset()
+		{
+			_translation = Ogre::Vector3::ZERO;
+			_rotation = Ogre::Quaternion::IDENTITY;
+			_scale = Ogre::Vector3::UNIT_SCALE;
+			_changes = 0;
+		}
+
+		/**
+		 * Adds a translation in parent space, like Ogre::Node::translate().
+		 * @param d The translation.
+		 */
+		void translate( const Ogre::Vector3& d)
+		{
+			_translation += d;
+			_changes |= CHANGED_POSITION;
+		}
+
+		/**
+		 * Adds a rotation in local space, like Ogre::Node::rotate().
+		 * @param q The rotation, will be normalised.
+		 */
+		void rotate( const Ogre::Quaternion& q)
+		{
+			Ogre::Quaternion qnorm = q;
+			qnorm.normalise();
+			_rotation = _rotation * qnorm;
+			_changes |= CHANGED_ORIENTATION;
+		}
+
+		/**
+		 * Adds a rotation in local space that is normalised already.
+		 * @param q The normalised rotation.
+		 */
+		void rotateNormalised( const Ogre::Quaternion& q)
+		{
+			_rotation = _rotation * q;
+			_changes |= CHANGED_ORIENTATION;
+		}
+
+		/**
+		 * Adds a rotation around an axis in local space, like Ogre::Node::rotate().
+		 * @param axis The rotation axis.
+		 * @param angle The rotation angle.
+		 */
+		void rotate( const Ogre::Vector3& axis, const Ogre::Radian& angle)
+		{
+			rotate( Ogre::Quaternion( angle, axis));
+		}
+
+		/**
+		 * Multiplies the scale, like Ogre::Node::scale().
+		 * @param s The scale factors.
+		 */
+		void scale( const Ogre::Vector3& s)
+		{
+			_scale *= s;
+			_changes |= CHANGED_SCALE;
+		}
+
+		/**
+		 * Adds all changes of another delta, as if they had been made on this one.
+		 * @param other The delta whose changes follow the changes of this delta.
+		 */
+		void append( const TransformDelta& other)
+		{
+			_translation += other._translation;
+			_rotation = _rotation * other._rotation;
+			_scale *= other._scale;
+			_changes |= other._changes;
+		}
+
+		/**
+		 * Applies the accumulated changes on the Node, with one update per changed component.
+		 * @param node The Node to change.
+		 */
+		void commit( Ogre::Node* node)
+		{
+			if( _changes & CHANGED_POSITION)
+				node->setPosition( node->getPosition() + _translation);
+
+			if( _changes & CHANGED_ORIENTATION)
+				node->setOrientation( node->getOrientation() * _rotation);
+
+			if( _changes & CHANGED_SCALE)
+				node->setScale( node->getScale() * _scale);
+		}
+
+		/**
+		 * Applies this delta on every Node of a range, like commit() on each of them.
+		 * @param nodes The first Node of the range.
+		 * @param count The number of Nodes.
+		 */
+		void commitShared( Ogre::Node* const* nodes, uint count) const
+		{
+			commitLanes( nodes, this, 0, count);
+		}
+
+	public: // class methods
+
+		/**
+		 * Applies one delta per Node on a range of Nodes, like commit() on each of them.
+		 * @param nodes The first Node of the range.
+		 * @param deltas The delta of the first Node, one per Node.
+		 * @param count The number of Nodes.
+		 */
+		static void commitBatch( Ogre::Node* const* nodes, const TransformDelta* deltas, uint count)
+		{
+			commitLanes( nodes, deltas, 1, count);
+		}
+
+	public: // getters & setters
+
+		/**
+		 * Indicates whether the delta changes anything.
+		 * @return
+		 * TRUE - nothing has been accumulated since the last reset()
+		 * FALSE - commit() will change the Node
+		 */
+		bool isEmpty()
+		{
+			return _changes == 0;
+		}
+
+	private: // class helpers
+
+		/**
+		 * Commits deltas to a range of Nodes, TRIP_SIMD_WIDTH Nodes at a time.
+		 * @param nodes The first Node of the range.
+		 * @param deltas The delta of the first Node.
+		 * @param step The distance between the deltas of two Nodes, 0 to commit the same delta to all.
+		 * @param count The number of Nodes.
+		 */
+		static void commitLanes( Ogre::Node* const* nodes, const TransformDelta* deltas, uint step, uint count);
+
+	}; // END class TransformDelta
+
+} // END namespace Trip
+
+#endif /* __TransformDelta_HPP__ */
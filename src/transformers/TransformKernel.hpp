@@ -0,0 +1,103 @@
+/**
+ * This file contains the TransformKernel, which processes the work of many
+ * Transformers of the same type in one pass.
+ * @author barn
+ * @version 20121129
+ */
+#ifndef __TransformKernel_HPP__
+#define __TransformKernel_HPP__
+
+/*===========================================================================*
+ * INCLUDES base definition file for DLL import/export
+ *===========================================================================*/
+
+/*===========================================================================*
+ * INCLUDES project headers
+ *===========================================================================*/
+#include "stdafx.h"
+#include <transformers/TransformDelta.hpp>
+
+/*===========================================================================*
+ * INCLUDES C/C++ standard library (and other external libraries)
+ *===========================================================================*/
+
+/*===========================================================================*
+ * DEFINES and MACROS
+ *===========================================================================*/
+
+/// The number of items a kernel gathers into its parameter arrays at once.
+#define TRIP_KERNEL_BLOCK 64
+
+/*===========================================================================*
+ * NAMESPACE, CONSTANTS and TYPE DECLARATIONS/IMPLEMENTATIONS
+ *===========================================================================*/
+
+namespace Trip
+{
+	class Transformer;
+
+	/**
+	 * A TransformKernel applies many accumulating Transformers of one concrete type,
+	 * each on its own range of Nodes, within one tight loop.
+	 * Implementations usually gather the parameters of a block of items into
+	 * local arrays, one array per parameter, compute the changes for the whole block
+	 * and then write them into the TransformDeltas of the Nodes.
+	 *
+	 * A kernel must not keep any state between calls, since one instance is shared
+	 * by all Transformers of its type. Every Transformer of an item returns this kernel
+	 * from Transformer::getKernel(), so it may be cast to the kernel's type.
+	 *
+	 * @see Transformer::getKernel()
+	 */
+	class TransformKernel
+	{
+	public: // nested types
+
+		/// The work of one Transformer on one range of Nodes.
+		struct Item
+		{
+			/// The Transformer to apply.
+			Transformer* transformer;
+
+			/// The first Node of the range.
+			Ogre::Node** nodes;
+
+			/// The delta of the first Node of the range, one per Node.
+			TransformDelta* deltas;
+
+			/// The number of Nodes.
+			uint count;
+
+			/// The running variable of the first Node.
+			uint first_index;
+
+			/// An additional factor for the influence, e.g. the fade value of the Cluster.
+			float weight;
+
+			/// The time to simulate, usually the time since the last frame rendered.
+			float tlc;
+		};
+
+	public: // constructor & destructor
+
+		/**
+		 * Destructor.
+		 */
+		virtual ~TransformKernel()
+		{}
+
+	public: // methods
+
+		/**
+		 * Adds the changes of all items to the deltas of their Nodes.
+		 * Disabled Transformers must be skipped.
+		 * @param items The items to process.
+		 * @param count The number of items.
+		 */
+		virtual void execute( const Item* items, uint count) = 0;
+
+	}; // END class TransformKernel
+
+} // END namespace Trip
+
+#endif /* __TransformKernel_HPP__ */
@@ -12,6 +12,8 @@
 /*===========================================================================*
  * INCLUDES project headers
  *===========================================================================*/
+#include <Engine.hpp>
+#include <clusters/Cluster.hpp>
 
 /*===========================================================================*
  * INCLUDES C/C++ standard library (and other external libraries)
@@ -30,8 +32,9 @@ namespace Trip
 
 	/**
 	 * Applies the transform strategy once on the given Node.
-	 * It takes the _influence variable, the fade-in and fade-out parameters into account and
+	 * It takes the _influence variable and the current fade value into account and
 	 * calls apply() with adjusted influence values internally.
+	 * The fading itself is advanced once per frame by the FadeScheduler.
 	 * @param nd The Node on which to apply the strategy.
 	 * @param tlc The time since the last frame rendered,
 	 * multiply it in the implementations in order to keep the right timing.
@@ -45,40 +48,93 @@ namespace Trip
 		if( !_enabled)
 			return;
 
-		float inf = _influence;
+		// apply transformation
+		apply( nd, tlc, i, _influence * _fade_value);
+	}
 
-		if( _fade_in)
-		{
-			// process fading in
-
-			if( _fade_time <= _fade_in_time)
-			{
-				_fade_time += tlc;
-				inf *= _fade_in_fun->fun( _fade_time);
-			}
-			else
-			{
-				_fade_in = false;
-			}
-		}
-		else if( _fade_out)
+
+	/**
+	 * Applies the transform strategy once on each of the given Nodes.
+	 * The influence, the current fade value and the given weight are combined once
+	 * for the whole batch, then applyBatch() is called.
+	 * Doesn't do anything if the Transformer is not enabled.
+	 * @param nodes The Nodes on which to apply the strategy.
+	 * @param count The number of Nodes.
+	 * @param firstIndex The running variable of the first Node.
+	 * The k-th Node gets the running variable firstIndex + k.
+	 * @param tlc The time since the last frame rendered.
+	 * @param weight An additional factor for the influence, e.g. the fade value of the Cluster.
+	 */
+	void Transformer::transformBatch( Ogre::Node* const* nodes, uint count, uint firstIndex, float tlc, float weight)
+	{
+		// abort when disabled
+		if( !_enabled)
+			return;
+
+		applyBatch( nodes, count, firstIndex, tlc, _influence * _fade_value * weight);
+	}
+
+
+	/**
+	 * Adds the changes of the transform strategy on each of the given Nodes to their deltas,
+	 * without changing the Nodes. Only call it if isAccumulating() holds.
+	 * The influence, the current fade value and the given weight are combined once
+	 * for the whole batch, then accumulateBatch() is called.
+	 * Doesn't do anything if the Transformer is not enabled.
+	 * @param nodes The Nodes on which to apply the strategy. Only read them.
+	 * @param deltas The deltas of the Nodes, one per Node.
+	 * @param count The number of Nodes.
+	 * @param firstIndex The running variable of the first Node.
+	 * The k-th Node gets the running variable firstIndex + k.
+	 * @param tlc The time since the last frame rendered.
+	 * @param weight An additional factor for the influence, e.g. the fade value of the Cluster.
+	 */
+	void Transformer::accumulate( Ogre::Node* const* nodes, TransformDelta* deltas, uint count, uint firstIndex, float tlc, float weight)
+	{
+		// abort when disabled
+		if( !_enabled)
+			return;
+
+		accumulateBatch( nodes, deltas, count, firstIndex, tlc, _influence * _fade_value * weight);
+	}
+
+
+	/**
+	 * Adds the changes of the transform strategy, which are the same for every Node, to one delta.
+	 * Only call it if isAccumulating() and isUniform() hold.
+	 * Doesn't do anything if the Transformer is not enabled.
+	 * @param delta The delta that collects the changes for all Nodes.
+	 * @param tlc The time since the last frame rendered.
+	 * @param weight An additional factor for the influence, e.g. the fade value of the Cluster.
+	 */
+	void Transformer::accumulateUniform( TransformDelta& delta, float tlc, float weight)
+	{
+		// abort when disabled
+		if( !_enabled)
+			return;
+
+		accumulateOnce( delta, tlc, _influence * _fade_value * weight);
+	}
+
+
+	/**
+	 * Sets whether this Transformer is enabled or not.
+	 * This also stops all fadings, not just pausing it.
+	 * Since only enabled Transformers are part of the Engine's ExecutionPlan,
+	 * changing the state invalidates the plan.
+	 * @param enabled
+	 * TRUE - enabled
+	 * FALSE - disabled
+	 */
+	void Transformer::setEnabled( bool enabled)
+	{
+		if( enabled != _enabled)
 		{
-			// process fading out
-
-			if( _fade_time >= tlc)
-			{
-				_fade_time -= tlc;
-				inf *= _fade_out_fun->fun( _fade_time);
-			}
-			else
-			{
-				setEnabled( false);
-				return;
-			}
+			Engine::invalidatePlan();
 		}
 
-		// apply transformation
-		apply( nd, tlc, i, inf);
+		Fadeable::setEnabled( enabled);
+		updateActive();
 	}
 
 
@@ -97,7 +153,7 @@ namespace Trip
 				f = 1.0f;
 
 			if (!_enabled)
-				_enabled = true;
+				setEnabled( true);
 		}
 		else if( f < 0.0f)
 		{
@@ -106,6 +162,28 @@ namespace Trip
 		}
 
 		_influence = f;
+		updateActive();
+	}
+
+
+	/**
+	 * Updates whether the Transformer is active and tells its Cluster about a change.
+	 * Inactive Transformers are not part of the Engine's ExecutionPlan,
+	 * so a change invalidates the plan.
+	 */
+	void Transformer::updateActive()
+	{
+		const bool active = _enabled && _influence > 0.0f;
+		if( active == _active)
+			return;
+
+		_active = active;
+		Engine::invalidatePlan();
+
+		if( _cluster)
+		{
+			_cluster->changeActiveTransformers( active ? 1 : -1);
+		}
 	}
 
 
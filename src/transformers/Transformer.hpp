@@ -16,6 +16,8 @@
  *===========================================================================*/
 #include "stdafx.h"
 #include "Fadeable.hpp"
+#include <transformers/TransformDelta.hpp>
+#include <transformers/TransformKernel.hpp>
 
 /*===========================================================================*
  * INCLUDES C/C++ standard library (and other external libraries)
@@ -31,6 +33,7 @@
 
 namespace Trip
 {
+	class Cluster;
 
 	/**
 	 * The class Transformer provides an interface for appliyng continuous changes
@@ -56,6 +59,15 @@ namespace Trip
 	 *
 	 * When you have parameters that you want to be changeable by clients, use the _params vector
 	 * also be aware of describing your parameters within the _param_descriptions vector.
+	 *
+	 * If your strategy only translates, rotates or scales the Nodes relatively, override
+	 * accumulateBatch() and isAccumulating() as well. The Engine then collects the changes of
+	 * all accumulating Transformers of a Node in a TransformDelta and updates the Node once.
+	 * If the changes are the same for every Node and running index, also override isUniform()
+	 * and accumulateOnce(), so that the Engine computes them only once for all Nodes.
+	 * For scenes with many Transformers of your type, also provide a TransformKernel through
+	 * getKernel(). In grouped mode, the Engine hands the work of all of them to the kernel at once.
+	 * Override isDeferrable() if your strategy must not be applied with the time of several frames at once.
 	 */
 	class Transformer : public Fadeable
 	{
@@ -70,6 +82,12 @@ namespace Trip
 		 */
 		float _influence;
 
+		/// Indicates whether the Transformer is enabled and has an influence greater than 0.
+		bool _active;
+
+		/// The Cluster this Transformer is attached to or NULL.
+		Cluster* _cluster;
+
 	protected: // vars
 
 		/**
@@ -96,7 +114,23 @@ namespace Trip
 		 */
 		Transformer()
 			: _name("<unnamed transformer>"),
-			_influence(1)
+			_influence(1),
+			_active(true),
+			_cluster(0)
+		{}
+
+		/**
+		 * Copy constructor.
+		 * The copy is not attached to any Cluster.
+		 */
+		Transformer( const Transformer& other)
+			: Fadeable( other),
+			_name( other._name),
+			_influence( other._influence),
+			_active( other._active),
+			_cluster(0),
+			_params( other._params),
+			_param_descriptions( other._param_descriptions)
 		{}
 
 		/**
@@ -110,7 +144,7 @@ namespace Trip
 
 		/**
 		 * Applies the transform strategy once on the given Node.
-		 * It takes the fade-in and fade-out parameters into account and
+		 * It takes the current fade value into account and
 		 * calls the protected method apply() with adjusted influence values internally.
 		 * Doesn't do anything if the TransformStrategy is not enabled.
 		 * @param nd The Node on which to apply the strategy.
@@ -125,6 +159,46 @@ namespace Trip
 		 */
 		void transform( Ogre::Node* nd, float tlc, uint i = 0);
 
+		/**
+		 * Applies the transform strategy once on each of the given Nodes.
+		 * The influence, the current fade value and the given weight are combined once
+		 * for the whole batch, then applyBatch() is called.
+		 * Doesn't do anything if the Transformer is not enabled.
+		 * @param nodes The Nodes on which to apply the strategy.
+		 * @param count The number of Nodes.
+		 * @param firstIndex The running variable of the first Node.
+		 * The k-th Node gets the running variable firstIndex + k.
+		 * @param tlc The time since the last frame rendered.
+		 * @param weight An additional factor for the influence, e.g. the fade value of the Cluster.
+		 */
+		void transformBatch( Ogre::Node* const* nodes, uint count, uint firstIndex, float tlc, float weight = 1.0f);
+
+		/**
+		 * Adds the changes of the transform strategy on each of the given Nodes to their deltas,
+		 * without changing the Nodes. Only call it if isAccumulating() holds.
+		 * The influence, the current fade value and the given weight are combined once
+		 * for the whole batch, then accumulateBatch() is called.
+		 * Doesn't do anything if the Transformer is not enabled.
+		 * @param nodes The Nodes on which to apply the strategy. Only read them.
+		 * @param deltas The deltas of the Nodes, one per Node.
+		 * @param count The number of Nodes.
+		 * @param firstIndex The running variable of the first Node.
+		 * The k-th Node gets the running variable firstIndex + k.
+		 * @param tlc The time since the last frame rendered.
+		 * @param weight An additional factor for the influence, e.g. the fade value of the Cluster.
+		 */
+		void accumulate( Ogre::Node* const* nodes, TransformDelta* deltas, uint count, uint firstIndex, float tlc, float weight = 1.0f);
+
+		/**
+		 * Adds the changes of the transform strategy, which are the same for every Node, to one delta.
+		 * Only call it if isAccumulating() and isUniform() hold.
+		 * Doesn't do anything if the Transformer is not enabled.
+		 * @param delta The delta that collects the changes for all Nodes.
+		 * @param tlc The time since the last frame rendered.
+		 * @param weight An additional factor for the influence, e.g. the fade value of the Cluster.
+		 */
+		void accumulateUniform( TransformDelta& delta, float tlc, float weight = 1.0f);
+
 		/**
 		 * Clones the Transformer. Override this method in order to use prototypes of your own subclass.
 		 */
@@ -133,6 +207,69 @@ namespace Trip
 			return new Transformer( *this);
 		}
 
+		/**
+		 * Indicates whether apply() may be called for different Nodes from several threads at once.
+		 * Override this method and return true, if your apply() only changes the given Node
+		 * and only reads the Transformer's members. The Engine may then process your Transformer
+		 * in parallel.
+		 * @return
+		 * TRUE - apply() is thread-safe per Node
+		 * FALSE - apply() must be called from one thread only
+		 */
+		virtual bool isThreadSafe()
+		{
+			return false;
+		}
+
+		/**
+		 * Indicates whether the Transformer writes its changes into TransformDeltas.
+		 * Override this method and return true, if you override accumulateBatch().
+		 * @return
+		 * TRUE - the Engine calls accumulate() instead of transformBatch()
+		 * FALSE - the Engine calls transformBatch(), which changes the Nodes directly
+		 */
+		virtual bool isAccumulating()
+		{
+			return false;
+		}
+
+		/**
+		 * Indicates whether the changes of an accumulating Transformer depend neither on the Node
+		 * nor on its running index. Override this method and return true, if you override accumulateOnce().
+		 * @return
+		 * TRUE - the Engine calls accumulateUniform() once for all Nodes
+		 * FALSE - the Engine calls accumulate() with all Nodes
+		 */
+		virtual bool isUniform()
+		{
+			return false;
+		}
+
+		/**
+		 * Retrieves the kernel that processes many Transformers of this type at once.
+		 * Only accumulating Transformers may have a kernel. All Transformers of a type
+		 * must return the same kernel, so override this method with a static kernel.
+		 * @return The kernel of the Transformer's type or NULL, if there is none.
+		 */
+		virtual TransformKernel* getKernel()
+		{
+			return 0;
+		}
+
+		/**
+		 * Indicates whether the Engine may skip this Transformer in some frames, e.g. while its Cluster
+		 * is off-screen or far away, and apply the skipped time in one larger step later.
+		 * Override this method and return false, if your strategy must see every frame,
+		 * e.g. an integrator that becomes unstable with large steps.
+		 * @return
+		 * TRUE - the Cluster of the Transformer may be updated less often
+		 * FALSE - the Cluster of the Transformer is updated every frame
+		 */
+		virtual bool isDeferrable()
+		{
+			return true;
+		}
+
 	public: // getters & setters
 
 		/**
@@ -155,6 +292,16 @@ namespace Trip
 		}
 
 
+		/**
+		 * Sets whether this Transformer is enabled or not.
+		 * This also stops all fadings, not just pausing it.
+		 * @param enabled
+		 * TRUE - enabled
+		 * FALSE - disabled
+		 */
+		void setEnabled( bool enabled);
+
+
 		/**
 		 * Speficies the influence that this Transformer shall have.
 		 * Should be a value within [0,1]. Higher/Lower values will be cut.
@@ -171,6 +318,38 @@ namespace Trip
 			return _influence;
 		}
 
+		/**
+		 * Indicates whether the Transformer changes anything,
+		 * meaning it is enabled and has an influence greater than 0.
+		 * @return
+		 * TRUE - the Transformer is enabled and has an influence
+		 * FALSE - the Transformer is disabled or has no influence
+		 */
+		bool isActive()
+		{
+			return _active;
+		}
+
+		/**
+		 * Sets the Cluster this Transformer is attached to.
+		 * Called by the Cluster when adding or removing the Transformer,
+		 * so that the Cluster learns when the Transformer becomes active or inactive.
+		 * @param cluster The Cluster or NULL.
+		 */
+		void setCluster( Cluster* cluster)
+		{
+			_cluster = cluster;
+		}
+
+		/**
+		 * Retrieves the Cluster this Transformer is attached to.
+		 * @return The Cluster or NULL.
+		 */
+		Cluster* getCluster()
+		{
+			return _cluster;
+		}
+
 		/**
 		 * Retrieves the param vector from which you can
 		 * read and write parameters in order to change the
@@ -213,6 +392,11 @@ namespace Trip
 
 	protected: // helpers
 
+		/**
+		 * Updates whether the Transformer is active and tells its Cluster about a change.
+		 */
+		void updateActive();
+
 		/**
 		 * Applies the transform strategy once on the given Node.
 		 * @param nd The Node on which to apply the strategy.
@@ -230,6 +414,53 @@ namespace Trip
 			/* EMPTY IMPLEMENTATION */
 		}
 
+		/**
+		 * Applies the transform strategy once on each of the given Nodes.
+		 * The default implementation calls apply() for every Node.
+		 * Override it if your strategy can share work between the Nodes.
+		 * @param nodes The Nodes on which to apply the strategy.
+		 * @param count The number of Nodes.
+		 * @param firstIndex The running variable of the first Node.
+		 * The k-th Node gets the running variable firstIndex + k.
+		 * @param tlc The time since the last frame rendered.
+		 * @param inf The influence of this strategy on all Nodes, within [0,1].
+		 */
+		virtual void applyBatch( Ogre::Node* const* nodes, uint count, uint firstIndex, float tlc, float inf)
+		{
+			for( uint k = 0; k < count; ++k)
+			{
+				apply( nodes[k], tlc, firstIndex + k, inf);
+			}
+		}
+
+		/**
+		 * Adds the changes of the transform strategy on each of the given Nodes to their deltas.
+		 * Override it together with isAccumulating(). The default implementation does nothing.
+		 * @param nodes The Nodes on which to apply the strategy. Only read them.
+		 * @param deltas The deltas of the Nodes, one per Node.
+		 * @param count The number of Nodes.
+		 * @param firstIndex The running variable of the first Node.
+		 * The k-th Node gets the running variable firstIndex + k.
+		 * @param tlc The time since the last frame rendered.
+		 * @param inf The influence of this strategy on all Nodes, within [0,1].
+		 */
+		virtual void accumulateBatch( Ogre::Node* const* nodes, TransformDelta* deltas, uint count, uint firstIndex, float tlc, float inf)
+		{
+			/* EMPTY IMPLEMENTATION */
+		}
+
+		/**
+		 * Adds the changes of the transform strategy, which are the same for every Node, to one delta.
+		 * Override it together with isUniform(). The default implementation does nothing.
+		 * @param delta The delta that collects the changes for all Nodes.
+		 * @param tlc The time since the last frame rendered.
+		 * @param inf The influence of this strategy, within [0,1].
+		 */
+		virtual void accumulateOnce( TransformDelta& delta, float tlc, float inf)
+		{
+			/* EMPTY IMPLEMENTATION */
+		}
+
 	}; // END class Transformer
 
 } // END namespace Trip
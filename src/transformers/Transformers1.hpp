@@ -15,6 +15,7 @@
  *===========================================================================*/
 #include "stdafx.h"
 #include <util/Math.hpp>
+#include <util/SimdMath.hpp>
 
 /*===========================================================================*
  * INCLUDES C/C++ standard library (and other external libraries)
@@ -58,6 +59,76 @@
 namespace Trip
 {
 
+	/// Rotates the deltas of many SimpleRotators at once, TRIP_SIMD_WIDTH rotations per SimdMath call.
+	class SimpleRotatorKernel : public TransformKernel
+	{
+	public:
+
+		void execute( const Item* items, uint count)
+		{
+			float angle[TRIP_KERNEL_BLOCK];
+			float influence[TRIP_KERNEL_BLOCK];
+			Vector3Batch axis[TRIP_KERNEL_BLOCK / TRIP_SIMD_WIDTH];
+			QuaternionBatch batch;
+			Ogre::Quaternion rotation[TRIP_KERNEL_BLOCK];
+
+			for( uint block = 0; block < count; block += TRIP_KERNEL_BLOCK)
+			{
+				const Item* block_items = items + block;
+				const uint n = std::min<uint>( TRIP_KERNEL_BLOCK, count - block);
+
+				// gather the parameters
+				for( uint i = 0; i < n; ++i)
+				{
+					Transformer* t = block_items[i].transformer;
+					const std::vector<float>& params = t->getParams();
+					influence[i] = t->isEnabled() ? t->getInfluence() * t->getFadeValue() * block_items[i].weight : 0;
+					angle[i] = params[0] * block_items[i].tlc * influence[i];
+					axis[i / TRIP_SIMD_WIDTH].x[i % TRIP_SIMD_WIDTH] = params[1];
+					axis[i / TRIP_SIMD_WIDTH].y[i % TRIP_SIMD_WIDTH] = params[2];
+					axis[i / TRIP_SIMD_WIDTH].z[i % TRIP_SIMD_WIDTH] = params[3];
+				}
+
+				// unused lanes rotate by 0 around the y axis
+				for( uint i = n; i % TRIP_SIMD_WIDTH != 0; ++i)
+				{
+					angle[i] = 0;
+					axis[i / TRIP_SIMD_WIDTH].x[i % TRIP_SIMD_WIDTH] = 0;
+					axis[i / TRIP_SIMD_WIDTH].y[i % TRIP_SIMD_WIDTH] = 1;
+					axis[i / TRIP_SIMD_WIDTH].z[i % TRIP_SIMD_WIDTH] = 0;
+				}
+
+				// one rotation per item
+				for( uint base = 0; base < n; base += TRIP_SIMD_WIDTH)
+				{
+					SimdMath::fromAngleAxis( angle + base, axis[base / TRIP_SIMD_WIDTH], batch);
+					SimdMath::normalise( batch);
+
+					const uint lanes = std::min<uint>( TRIP_SIMD_WIDTH, n - base);
+					for( uint i = 0; i < lanes; ++i)
+					{
+						rotation[base + i] = Ogre::Quaternion( batch.w[i], batch.x[i], batch.y[i], batch.z[i]);
+					}
+				}
+
+				// apply them on the nodes
+				for( uint i = 0; i < n; ++i)
+				{
+					if( influence[i] == 0)
+						continue;
+
+					TransformDelta* deltas = block_items[i].deltas;
+					const uint node_count = block_items[i].count;
+					for( uint k = 0; k < node_count; ++k)
+					{
+						deltas[k].rotateNormalised( rotation[i]);
+					}
+				}
+			}
+		}
+	};
+
+
 	/// SimpleRotator
 	class SimpleRotator : public Trip::Transformer
 	{
@@ -86,10 +157,58 @@ namespace Trip
 			_param_descriptions.push_back("Z axis");
 		}
 
+		bool isThreadSafe()
+		{
+			return true;
+		}
+
+		bool isAccumulating()
+		{
+			return true;
+		}
+
+		bool isUniform()
+		{
+			return true;
+		}
+
+		TransformKernel* getKernel()
+		{
+			static SimpleRotatorKernel kernel;
+			return &kernel;
+		}
+
 		void apply( Ogre::Node* nd, float tlc, uint i = 0, float inf = 1)
 		{
 			nd->rotate( Ogre::Vector3( _params[1], _params[2], _params[3]), Ogre::Radian( _params[0] * tlc * inf) );
 		}
+
+		void applyBatch( Ogre::Node* const* nodes, uint count, uint firstIndex, float tlc, float inf)
+		{
+			// the rotation is the same for every node
+			const Ogre::Quaternion q( Ogre::Radian( _params[0] * tlc * inf), Ogre::Vector3( _params[1], _params[2], _params[3]));
+
+			for( uint k = 0; k < count; ++k)
+			{
+				nodes[k]->rotate( q);
+			}
+		}
+
+		void accumulateBatch( Ogre::Node* const* nodes, TransformDelta* deltas, uint count, uint firstIndex, float tlc, float inf)
+		{
+			// the rotation is the same for every node
+			const Ogre::Quaternion q( Ogre::Radian( _params[0] * tlc * inf), Ogre::Vector3( _params[1], _params[2], _params[3]));
+
+			for( uint k = 0; k < count; ++k)
+			{
+				deltas[k].rotate( q);
+			}
+		}
+
+		void accumulateOnce( TransformDelta& delta, float tlc, float inf)
+		{
+			delta.rotate( Ogre::Vector3( _params[1], _params[2], _params[3]), Ogre::Radian( _params[0] * tlc * inf));
+		}
 	};
 
 } // END namespace Trip
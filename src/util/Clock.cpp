@@ -0,0 +1,89 @@
+/**
+ * Implementation file for the Clock.hpp.
+ * @author barn
+ * @version 20121125
+ */
+
+/*===========================================================================*
+ * INCLUDES (associated header files)
+ *===========================================================================*/
+#include "Clock.hpp"
+
+/*===========================================================================*
+ * INCLUDES project headers
+ *===========================================================================*/
+
+/*===========================================================================*
+ * INCLUDES C/C++ standard library (and other external libraries)
+ *===========================================================================*/
+#if OGRE_PLATFORM != OGRE_PLATFORM_WIN32
+#include <time.h>
+#endif
+
+/*===========================================================================*
+ * DEFINES and MACROS
+ *===========================================================================*/
+
+/*===========================================================================*
+ * NAMESPACE, CONSTANTS and TYPE DECLARATIONS/IMPLEMENTATIONS
+ *===========================================================================*/
+
+namespace Trip
+{
+
+#if OGRE_PLATFORM == OGRE_PLATFORM_WIN32
+
+	/**
+	 * Reads the counter.
+	 * @return The current counter value.
+	 */
+	Clock::Ticks Clock::now()
+	{
+		LARGE_INTEGER counter;
+		QueryPerformanceCounter( &counter);
+		return counter.QuadPart;
+	}
+
+
+	/**
+	 * Retrieves the number of ticks per second.
+	 * @return The frequency of the counter.
+	 */
+	Clock::Ticks Clock::getFrequency()
+	{
+		static Ticks frequency = 0;
+		if( frequency == 0)
+		{
+			LARGE_INTEGER f;
+			QueryPerformanceFrequency( &f);
+			frequency = f.QuadPart;
+		}
+		return frequency;
+	}
+
+#else
+
+	/**
+	 * Reads the counter.
+	 * @return The current counter value in nanoseconds.
+	 */
+	Clock::Ticks Clock::now()
+	{
+		timespec t;
+		clock_gettime( CLOCK_MONOTONIC, &t);
+		return (Ticks) t.tv_sec * 1000000000 + t.tv_nsec;
+	}
+
+
+	/**
+	 * Retrieves the number of ticks per second.
+	 * @return The frequency of the counter.
+	 */
+	Clock::Ticks Clock::getFrequency()
+	{
+		return 1000000000;
+	}
+
+#endif
+
+} // END namespace Trip
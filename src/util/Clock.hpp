@@ -0,0 +1,83 @@
+/**
+ * This file contains the Clock, a high resolution clock for measuring short time spans.
+ * @author barn
+ * @version 20121125
+ */
+#ifndef __Clock_HPP__
+#define __Clock_HPP__
+
+/*===========================================================================*
+ * INCLUDES base definition file for DLL import/export
+ *===========================================================================*/
+
+/*===========================================================================*
+ * INCLUDES project headers
+ *===========================================================================*/
+#include "stdafx.h"
+
+/*===========================================================================*
+ * INCLUDES C/C++ standard library (and other external libraries)
+ *===========================================================================*/
+
+/*===========================================================================*
+ * DEFINES and MACROS
+ *===========================================================================*/
+
+/*===========================================================================*
+ * NAMESPACE, CONSTANTS and TYPE DECLARATIONS/IMPLEMENTATIONS
+ *===========================================================================*/
+
+namespace Trip
+{
+
+	/**
+	 * The Clock reads a monotonic high resolution counter.
+	 * Reading it costs only a few nanoseconds, so it can be used on hot paths.
+	 * Take two readings with now() and convert their difference to a time unit.
+	 */
+	class Clock
+	{
+	public: // nested types
+
+		/// A reading of the counter.
+		typedef long long Ticks;
+
+	public: // class methods
+
+		/**
+		 * Reads the counter.
+		 * @return The current counter value.
+		 */
+		static Ticks now();
+
+		/**
+		 * Retrieves the number of ticks per second.
+		 * @return The frequency of the counter.
+		 */
+		static Ticks getFrequency();
+
+		/**
+		 * Converts a number of ticks into nanoseconds.
+		 * @param ticks The number of ticks, e.g. the difference of two readings.
+		 * @return The time span in nanoseconds.
+		 */
+		static double toNanoseconds( Ticks ticks)
+		{
+			return ticks * (1000000000.0 / getFrequency());
+		}
+
+		/**
+		 * Converts a number of ticks into milliseconds.
+		 * @param ticks The number of ticks, e.g. the difference of two readings.
+		 * @return The time span in milliseconds.
+		 */
+		static double toMilliseconds( Ticks ticks)
+		{
+			return ticks * (1000.0 / getFrequency());
+		}
+
+	}; // END class Clock
+
+} // END namespace Trip
+
+#endif /* __Clock_HPP__ */
@@ -0,0 +1,93 @@
+/**
+ * Implementation file for the Histogram.hpp.
+ * @author barn
+ * @version 20121126
+ */
+
+/*===========================================================================*
+ * INCLUDES (associated header files)
+ *===========================================================================*/
+#include "Histogram.hpp"
+
+/*===========================================================================*
+ * INCLUDES project headers
+ *===========================================================================*/
+
+/*===========================================================================*
+ * INCLUDES C/C++ standard library (and other external libraries)
+ *===========================================================================*/
+
+/*===========================================================================*
+ * DEFINES and MACROS
+ *===========================================================================*/
+
+/*===========================================================================*
+ * NAMESPACE, CONSTANTS and TYPE DECLARATIONS/IMPLEMENTATIONS
+ *===========================================================================*/
+
+namespace Trip
+{
+
+	/**
+	 * Retrieves the time span below which the given fraction of all recorded values lies.
+	 * @param fraction The fraction within [0,1], e.g. 0.99 for the 99th percentile.
+	 * @return The upper bound of the bucket of the percentile in microseconds, or 0 if nothing was recorded.
+	 */
+	uint Histogram::getPercentile( double fraction)
+	{
+		if( _count == 0)
+			return 0;
+
+		// the rank of the value, counted from 1
+		uint rank = (uint) (fraction * _count + 0.5);
+		if( rank < 1)
+			rank = 1;
+		if( rank > _count)
+			rank = _count;
+
+		uint seen = 0;
+		for( uint b = 0; b < TRIP_HISTOGRAM_BUCKETS; ++b)
+		{
+			seen += _counts[b];
+			if( seen >= rank)
+			{
+				uint upper = (b + 1) * TRIP_HISTOGRAM_BUCKET_US;
+				return upper < _max_us ? upper : _max_us;
+			}
+		}
+		return _max_us;
+	}
+
+
+	/**
+	 * Retrieves the number of recorded values that are larger than the given time span.
+	 * The time span is rounded down to the width of a bucket.
+	 * @param us The time span in microseconds.
+	 * @return The number of larger values.
+	 */
+	uint Histogram::countAbove( uint us)
+	{
+		uint count = 0;
+		for( uint b = us / TRIP_HISTOGRAM_BUCKET_US; b <= TRIP_HISTOGRAM_BUCKETS; ++b)
+		{
+			count += _counts[b];
+		}
+		return count;
+	}
+
+
+	/**
+	 * Forgets all recorded values.
+	 */
+	void Histogram::reset()
+	{
+		for( uint b = 0; b <= TRIP_HISTOGRAM_BUCKETS; ++b)
+		{
+			_counts[b] = 0;
+		}
+		_count = 0;
+		_sum_us = 0;
+		_max_us = 0;
+	}
+
+} // END namespace Trip
@@ -0,0 +1,161 @@
+/**
+ * This file contains the Histogram, a fixed size histogram of time spans
+ * that reports percentiles.
+ * @author barn
+ * @version 20121126
+ */
+#ifndef __Histogram_HPP__
+#define __Histogram_HPP__
+
+/*===========================================================================*
+ * INCLUDES base definition file for DLL import/export
+ *===========================================================================*/
+
+/*===========================================================================*
+ * INCLUDES project headers
+ *===========================================================================*/
+#include "stdafx.h"
+
+/*===========================================================================*
+ * INCLUDES C/C++ standard library (and other external libraries)
+ *===========================================================================*/
+
+/*===========================================================================*
+ * DEFINES and MACROS
+ *===========================================================================*/
+
+/// The width of a bucket of the Histogram, in microseconds.
+#define TRIP_HISTOGRAM_BUCKET_US 50
+
+/// The number of buckets of the Histogram. Larger values are counted in an extra overflow bucket.
+#define TRIP_HISTOGRAM_BUCKETS 2000
+
+/*===========================================================================*
+ * NAMESPACE, CONSTANTS and TYPE DECLARATIONS/IMPLEMENTATIONS
+ *===========================================================================*/
+
+namespace Trip
+{
+
+	/**
+	 * The Histogram counts time spans in buckets of TRIP_HISTOGRAM_BUCKET_US microseconds,
+	 * up to TRIP_HISTOGRAM_BUCKETS buckets. Its memory is fixed, recording a value only
+	 * increments a counter, so it can stay on all the time.
+	 *
+	 * Percentiles are exact up to the width of a bucket, values beyond the last bucket are
+	 * reported as the maximum recorded value.
+	 * The Histogram does not lock, so record and read it from one thread only.
+	 */
+	class Histogram
+	{
+	private: // vars
+
+		/// The counters of the buckets, the last one counts all values beyond.
+		uint _counts[TRIP_HISTOGRAM_BUCKETS + 1];
+
+		/// The number of recorded values.
+		uint _count;
+
+		/// The sum of all recorded values, in microseconds.
+		double _sum_us;
+
+		/// The largest recorded value, in microseconds.
+		uint _max_us;
+
+	public: // constructor & destructor
+
+		/**
+		 * Main constructor.
+		 * Creates an empty Histogram.
+		 */
+		Histogram()
+		{
+			reset();
+		}
+
+		/**
+		 * Destructor.
+		 */
+		~Histogram()
+		{}
+
+	public: // methods
+
+		/**
+		 * Records a time span.
+		 * @param us The time span in microseconds.
+		 */
+		void record( uint us)
+		{
+			const uint bucket = us / TRIP_HISTOGRAM_BUCKET_US;
+			++_counts[bucket < TRIP_HISTOGRAM_BUCKETS ? bucket : TRIP_HISTOGRAM_BUCKETS];
+			++_count;
+			_sum_us += us;
+			if( us > _max_us)
+				_max_us = us;
+		}
+
+		/**
+		 * Retrieves the time span below which the given fraction of all recorded values lies.
+		 * @param fraction The fraction within [0,1], e.g. 0.99 for the 99th percentile.
+		 * @return The upper bound of the bucket of the percentile in microseconds, or 0 if nothing was recorded.
+		 */
+		uint getPercentile( double fraction);
+
+		/**
+		 * Retrieves the number of recorded values that are larger than the given time span.
+		 * The time span is rounded down to the width of a bucket.
+		 * @param us The time span in microseconds.
+		 * @return The number of larger values.
+		 */
+		uint countAbove( uint us);
+
+		/**
+		 * Forgets all recorded values.
+		 */
+		void reset();
+
+	public: // getters & setters
+
+		/**
+		 * Retrieves the number of recorded values.
+		 * @return The number of values.
+		 */
+		uint getCount()
+		{
+			return _count;
+		}
+
+		/**
+		 * Retrieves the mean of all recorded values.
+		 * @return The mean in microseconds, or 0 if nothing was recorded.
+		 */
+		double getMean()
+		{
+			return _count > 0 ? _sum_us / _count : 0;
+		}
+
+		/**
+		 * Retrieves the largest recorded value.
+		 * @return The maximum in microseconds.
+		 */
+		uint getMax()
+		{
+			return _max_us;
+		}
+
+		/**
+		 * Retrieves the counter of a bucket.
+		 * @param bucket The index of the bucket. TRIP_HISTOGRAM_BUCKETS is the overflow bucket.
+		 * @return The number of values in the bucket.
+		 */
+		uint getBucket( uint bucket)
+		{
+			return _counts[bucket];
+		}
+
+	}; // END class Histogram
+
+} // END namespace Trip
+
+#endif /* __Histogram_HPP__ */
@@ -0,0 +1,273 @@
+/**
+ * Implementation file for the SimdMath.hpp.
+ * Contains the CPU detection and the scalar fallback.
+ * @author barn
+ * @version 20121210
+ */
+
+/*===========================================================================*
+ * INCLUDES (associated header files)
+ *===========================================================================*/
+#include "SimdMath.hpp"
+
+/*===========================================================================*
+ * INCLUDES project headers
+ *===========================================================================*/
+
+/*===========================================================================*
+ * INCLUDES C/C++ standard library (and other external libraries)
+ *===========================================================================*/
+#include <cmath>
+
+#if defined(TRIP_SIMD_SSE2) && defined(_MSC_VER)
+#	include <intrin.h>
+#elif defined(TRIP_SIMD_SSE2)
+#	include <cpuid.h>
+#endif
+
+/*===========================================================================*
+ * DEFINES and MACROS
+ *===========================================================================*/
+
+/*===========================================================================*
+ * NAMESPACE, CONSTANTS and TYPE DECLARATIONS/IMPLEMENTATIONS
+ *===========================================================================*/
+
+namespace Trip
+{
+	/// Builds rotations from angles and axes, lane by lane.
+	static void scalarFromAngleAxis( const float* angles, const Vector3Batch& axes, QuaternionBatch& out)
+	{
+		for( uint i = 0; i < TRIP_SIMD_WIDTH; ++i)
+		{
+			const float half = 0.5f * angles[i];
+			const float s = std::sin( half);
+			out.w[i] = std::cos( half);
+			out.x[i] = s * axes.x[i];
+			out.y[i] = s * axes.y[i];
+			out.z[i] = s * axes.z[i];
+		}
+	}
+
+	/// Multiplies quaternions, lane by lane.
+	static void scalarMultiply( const QuaternionBatch& a, const QuaternionBatch& b, QuaternionBatch& out)
+	{
+		for( uint i = 0; i < TRIP_SIMD_WIDTH; ++i)
+		{
+			const float w = a.w[i] * b.w[i] - a.x[i] * b.x[i] - a.y[i] * b.y[i] - a.z[i] * b.z[i];
+			const float x = a.w[i] * b.x[i] + a.x[i] * b.w[i] + a.y[i] * b.z[i] - a.z[i] * b.y[i];
+			const float y = a.w[i] * b.y[i] + a.y[i] * b.w[i] + a.z[i] * b.x[i] - a.x[i] * b.z[i];
+			const float z = a.w[i] * b.z[i] + a.z[i] * b.w[i] + a.x[i] * b.y[i] - a.y[i] * b.x[i];
+			out.w[i] = w;
+			out.x[i] = x;
+			out.y[i] = y;
+			out.z[i] = z;
+		}
+	}
+
+	/// Normalises quaternions, lane by lane.
+	static void scalarNormalise( QuaternionBatch& q)
+	{
+		for( uint i = 0; i < TRIP_SIMD_WIDTH; ++i)
+		{
+			const float factor = 1.0f / std::sqrt( q.w[i] * q.w[i] + q.x[i] * q.x[i] + q.y[i] * q.y[i] + q.z[i] * q.z[i]);
+			q.w[i] *= factor;
+			q.x[i] *= factor;
+			q.y[i] *= factor;
+			q.z[i] *= factor;
+		}
+	}
+
+	/// Adds vectors, lane by lane.
+	static void scalarTranslate( Vector3Batch& v, const Vector3Batch& d)
+	{
+		for( uint i = 0; i < TRIP_SIMD_WIDTH; ++i)
+		{
+			v.x[i] += d.x[i];
+			v.y[i] += d.y[i];
+			v.z[i] += d.z[i];
+		}
+	}
+
+	/// Multiplies vectors component-wise, lane by lane.
+	static void scalarScale( Vector3Batch& v, const Vector3Batch& s)
+	{
+		for( uint i = 0; i < TRIP_SIMD_WIDTH; ++i)
+		{
+			v.x[i] *= s.x[i];
+			v.y[i] *= s.y[i];
+			v.z[i] *= s.z[i];
+		}
+	}
+
+
+	/// Computes sines and cosines, lane by lane.
+	static void scalarSinCos( const float* angles, float* s, float* c)
+	{
+		for( uint i = 0; i < TRIP_SIMD_WIDTH; ++i)
+		{
+			const float angle = angles[i];
+			s[i] = std::sin( angle);
+			c[i] = std::cos( angle);
+		}
+	}
+
+	/// Scales and offsets floats, lane by lane.
+	static void scalarAffine( const float* v, float* out, float factor, float offset)
+	{
+		for( uint i = 0; i < TRIP_SIMD_WIDTH; ++i)
+		{
+			out[i] = v[i] * factor + offset;
+		}
+	}
+
+	/// Multiplies floats, lane by lane.
+	static void scalarProduct( const float* a, const float* b, float* out)
+	{
+		for( uint i = 0; i < TRIP_SIMD_WIDTH; ++i)
+		{
+			out[i] = a[i] * b[i];
+		}
+	}
+
+
+	/// The implementations in use or NULL before the first call.
+	const SimdMath::Functions* SimdMath::__functions = 0;
+
+	/// The instruction set in use.
+	SimdMath::InstructionSet SimdMath::__instruction_set = SimdMath::SIMD_SCALAR;
+
+	/// The implementations without any SIMD instructions.
+	const SimdMath::Functions SimdMath::__scalar_functions =
+	{
+		&scalarFromAngleAxis,
+		&scalarMultiply,
+		&scalarNormalise,
+		&scalarTranslate,
+		&scalarScale,
+		&scalarSinCos,
+		&scalarAffine,
+		&scalarProduct
+	};
+
+
+	/**
+	 * Forces an instruction set, e.g. to compare them.
+	 * @param instructionSet The instruction set to use.
+	 * @return
+	 * TRUE - the instruction set is used from now on
+	 * FALSE - the CPU or the compiler does not support it, nothing changed
+	 */
+	bool SimdMath::setInstructionSet( InstructionSet instructionSet)
+	{
+		if( instructionSet > detectInstructionSet())
+			return false;
+
+		switch( instructionSet)
+		{
+#ifdef TRIP_SIMD_AVX
+		case SIMD_AVX:
+			__functions = &__avx_functions;
+			break;
+#endif
+#ifdef TRIP_SIMD_SSE2
+		case SIMD_SSE2:
+			__functions = &__sse2_functions;
+			break;
+#endif
+		default:
+			instructionSet = SIMD_SCALAR;
+			__functions = &__scalar_functions;
+			break;
+		}
+
+		__instruction_set = instructionSet;
+		return true;
+	}
+
+
+	/**
+	 * Detects the widest instruction set that the CPU and the compiler support.
+	 * AVX also needs the operating system to save the AVX registers.
+	 * @return The best instruction set.
+	 */
+	SimdMath::InstructionSet SimdMath::detectInstructionSet()
+	{
+#ifdef TRIP_SIMD_SSE2
+		unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+#	ifdef _MSC_VER
+		int info[4];
+		__cpuid( info, 1);
+		eax = info[0];
+		ebx = info[1];
+		ecx = info[2];
+		edx = info[3];
+#	else
+		__get_cpuid( 1, &eax, &ebx, &ecx, &edx);
+#	endif
+
+		const bool sse2 = (edx & (1 << 26)) != 0;
+		if( !sse2)
+			return SIMD_SCALAR;
+
+#	ifdef TRIP_SIMD_AVX
+		const bool osxsave = (ecx & (1 << 27)) != 0;
+		const bool avx = (ecx & (1 << 28)) != 0;
+		if( osxsave && avx)
+		{
+			// the OS must save the SSE and AVX registers on context switches
+#		ifdef _MSC_VER
+			const unsigned long long xcr0 = _xgetbv( 0);
+#		else
+			unsigned int xcr0_low = 0, xcr0_high = 0;
+			__asm__ __volatile__( "xgetbv" : "=a"(xcr0_low), "=d"(xcr0_high) : "c"(0));
+			const unsigned long long xcr0 = xcr0_low;
+#		endif
+			if( (xcr0 & 6) == 6)
+				return SIMD_AVX;
+		}
+#	endif
+
+		return SIMD_SSE2;
+#else
+		return SIMD_SCALAR;
+#endif
+	}
+
+
+	/**
+	 * Retrieves the name of an instruction set.
+	 * @param instructionSet The instruction set.
+	 * @return "scalar", "sse2" or "avx".
+	 */
+	const char* SimdMath::getInstructionSetName( InstructionSet instructionSet)
+	{
+		switch( instructionSet)
+		{
+		case SIMD_SSE2:	return "sse2";
+		case SIMD_AVX:	return "avx";
+		default:		return "scalar";
+		}
+	}
+
+
+	/**
+	 * Computes the sines and cosines of some lanes with std::sin and std::cos.
+	 * @param angles The angles in radians.
+	 * @param s The sines, the selected lanes are overwritten.
+	 * @param c The cosines, the selected lanes are overwritten.
+	 * @param lanes The lanes to compute, bit i selects lane i.
+	 */
+	void SimdMath::sinCosLanes( const float* angles, float* s, float* c, int lanes)
+	{
+		for( int i = 0; lanes != 0; ++i, lanes >>= 1)
+		{
+			if( lanes & 1)
+			{
+				s[i] = std::sin( angles[i]);
+				c[i] = std::cos( angles[i]);
+			}
+		}
+	}
+
+} // END namespace Trip
@@ -0,0 +1,280 @@
+/**
+ * This file contains SimdMath, a small library of vectorized transform operations
+ * on batches of quaternions, vectors and floats, with a scalar fallback.
+ * @author barn
+ * @version 20121210
+ */
+#ifndef __SimdMath_HPP__
+#define __SimdMath_HPP__
+
+/*===========================================================================*
+ * INCLUDES base definition file for DLL import/export
+ *===========================================================================*/
+
+/*===========================================================================*
+ * INCLUDES project headers
+ *===========================================================================*/
+#include "stdafx.h"
+
+/*===========================================================================*
+ * INCLUDES C/C++ standard library (and other external libraries)
+ *===========================================================================*/
+
+/*===========================================================================*
+ * DEFINES and MACROS
+ *===========================================================================*/
+
+/// The number of quaternions or vectors in one batch.
+#define TRIP_SIMD_WIDTH 8
+
+/// The largest angle the SIMD sine and cosine reduce by themselves, larger lanes use std::sin and std::cos.
+#define TRIP_SIMD_SINCOS_RANGE 8192.0f
+
+/// x86 compilers provide the SSE2 intrinsics.
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#	define TRIP_SIMD_SSE2
+
+/// AVX intrinsics need Visual Studio 2010 SP1 or a GCC compatible compiler.
+#	if (defined(_MSC_FULL_VER) && _MSC_FULL_VER >= 160040219) || defined(__GNUC__)
+#		define TRIP_SIMD_AVX
+#	endif
+#endif
+
+/*===========================================================================*
+ * NAMESPACE, CONSTANTS and TYPE DECLARATIONS/IMPLEMENTATIONS
+ *===========================================================================*/
+
+namespace Trip
+{
+
+	/// TRIP_SIMD_WIDTH quaternions, one array per component.
+	struct QuaternionBatch
+	{
+		float w[TRIP_SIMD_WIDTH];
+		float x[TRIP_SIMD_WIDTH];
+		float y[TRIP_SIMD_WIDTH];
+		float z[TRIP_SIMD_WIDTH];
+	};
+
+	/// TRIP_SIMD_WIDTH vectors, one array per component.
+	struct Vector3Batch
+	{
+		float x[TRIP_SIMD_WIDTH];
+		float y[TRIP_SIMD_WIDTH];
+		float z[TRIP_SIMD_WIDTH];
+	};
+
+
+	/**
+	 * SimdMath provides the common math of the Transformers and Functions on batches of
+	 * TRIP_SIMD_WIDTH quaternions, vectors or floats in structure-of-arrays layout.
+	 * Every operation processes all lanes of a batch, so fill unused lanes with harmless values.
+	 *
+	 * On the first call, SimdMath chooses the widest instruction set the CPU supports:
+	 * AVX processes a batch at once, SSE2 in two halves and the scalar fallback lane by lane.
+	 * All implementations follow the formulas of Ogre::Quaternion, but the vectorized sine
+	 * and cosine are polynomial approximations, so results may differ in the last bits.
+	 */
+	class SimdMath
+	{
+	public: // nested types
+
+		/// The instruction sets SimdMath can use.
+		enum InstructionSet
+		{
+			SIMD_SCALAR,
+			SIMD_SSE2,
+			SIMD_AVX
+		};
+
+	private: // nested types
+
+		/// The implementations of all operations for one instruction set.
+		struct Functions
+		{
+			void (*fromAngleAxis)( const float* angles, const Vector3Batch& axes, QuaternionBatch& out);
+			void (*multiply)( const QuaternionBatch& a, const QuaternionBatch& b, QuaternionBatch& out);
+			void (*normalise)( QuaternionBatch& q);
+			void (*translate)( Vector3Batch& v, const Vector3Batch& d);
+			void (*scale)( Vector3Batch& v, const Vector3Batch& s);
+			void (*sinCos)( const float* angles, float* s, float* c);
+			void (*affine)( const float* v, float* out, float factor, float offset);
+			void (*product)( const float* a, const float* b, float* out);
+		};
+
+	private: // class vars
+
+		/// The implementations in use or NULL before the first call.
+		static const Functions* __functions;
+
+		/// The instruction set in use.
+		static InstructionSet __instruction_set;
+
+		/// The implementations without any SIMD instructions.
+		static const Functions __scalar_functions;
+
+#ifdef TRIP_SIMD_SSE2
+		/// The SSE2 implementations, see SimdMathSSE2.cpp.
+		static const Functions __sse2_functions;
+#endif
+
+#ifdef TRIP_SIMD_AVX
+		/// The AVX implementations, see SimdMathAVX.cpp.
+		static const Functions __avx_functions;
+#endif
+
+	public: // class methods
+
+		/**
+		 * Builds rotations from angles and axes, like Ogre::Quaternion::FromAngleAxis().
+		 * The axes are expected to be normalised, otherwise normalise the result.
+		 * @param angles The rotation angles in radians, one per lane.
+		 * @param axes The rotation axes.
+		 * @param out Receives the rotations.
+		 */
+		static void fromAngleAxis( const float* angles, const Vector3Batch& axes, QuaternionBatch& out)
+		{
+			functions()->fromAngleAxis( angles, axes, out);
+		}
+
+		/**
+		 * Multiplies quaternions lane by lane, out = a * b like Ogre::Quaternion::operator*().
+		 * out may be a or b.
+		 * @param a The left factors.
+		 * @param b The right factors.
+		 * @param out Receives the products.
+		 */
+		static void multiply( const QuaternionBatch& a, const QuaternionBatch& b, QuaternionBatch& out)
+		{
+			functions()->multiply( a, b, out);
+		}
+
+		/**
+		 * Normalises quaternions lane by lane, like Ogre::Quaternion::normalise().
+		 * @param q The quaternions to normalise. Lanes must not be zero.
+		 */
+		static void normalise( QuaternionBatch& q)
+		{
+			functions()->normalise( q);
+		}
+
+		/**
+		 * Adds vectors lane by lane, v += d.
+		 * @param v The vectors to translate.
+		 * @param d The translations.
+		 */
+		static void translate( Vector3Batch& v, const Vector3Batch& d)
+		{
+			functions()->translate( v, d);
+		}
+
+		/**
+		 * Multiplies vectors component-wise lane by lane, v *= s.
+		 * @param v The vectors to scale.
+		 * @param s The scale factors.
+		 */
+		static void scale( Vector3Batch& v, const Vector3Batch& s)
+		{
+			functions()->scale( v, s);
+		}
+
+		/**
+		 * Computes the sines and cosines of a batch of angles.
+		 * s or c may be angles. Lanes beyond +-TRIP_SIMD_SINCOS_RANGE, e.g. of long running times,
+		 * are computed with std::sin and std::cos, since the fast reduction loses precision there.
+		 * @param angles TRIP_SIMD_WIDTH angles in radians.
+		 * @param s Receives TRIP_SIMD_WIDTH sines.
+		 * @param c Receives TRIP_SIMD_WIDTH cosines.
+		 */
+		static void sinCos( const float* angles, float* s, float* c)
+		{
+			functions()->sinCos( angles, s, c);
+		}
+
+		/**
+		 * Scales and offsets a batch of floats, out = v * factor + offset.
+		 * out may be v.
+		 * @param v TRIP_SIMD_WIDTH floats.
+		 * @param out Receives TRIP_SIMD_WIDTH results.
+		 * @param factor The factor of all lanes.
+		 * @param offset The offset of all lanes.
+		 */
+		static void affine( const float* v, float* out, float factor, float offset)
+		{
+			functions()->affine( v, out, factor, offset);
+		}
+
+		/**
+		 * Multiplies two batches of floats lane by lane, out = a * b.
+		 * out may be a or b.
+		 * @param a TRIP_SIMD_WIDTH floats.
+		 * @param b TRIP_SIMD_WIDTH floats.
+		 * @param out Receives TRIP_SIMD_WIDTH products.
+		 */
+		static void product( const float* a, const float* b, float* out)
+		{
+			functions()->product( a, b, out);
+		}
+
+		/**
+		 * Retrieves the instruction set in use.
+		 * @return The instruction set chosen for this CPU or by setInstructionSet().
+		 */
+		static InstructionSet getInstructionSet()
+		{
+			functions();
+			return __instruction_set;
+		}
+
+		/**
+		 * Forces an instruction set, e.g. to compare them.
+		 * @param instructionSet The instruction set to use.
+		 * @return
+		 * TRUE - the instruction set is used from now on
+		 * FALSE - the CPU or the compiler does not support it, nothing changed
+		 */
+		static bool setInstructionSet( InstructionSet instructionSet);
+
+		/**
+		 * Detects the widest instruction set that the CPU and the compiler support.
+		 * @return The best instruction set.
+		 */
+		static InstructionSet detectInstructionSet();
+
+		/**
+		 * Retrieves the name of an instruction set.
+		 * @param instructionSet The instruction set.
+		 * @return "scalar", "sse2" or "avx".
+		 */
+		static const char* getInstructionSetName( InstructionSet instructionSet);
+
+		/**
+		 * Computes the sines and cosines of some lanes with std::sin and std::cos.
+		 * The vectorized implementations call it for lanes beyond TRIP_SIMD_SINCOS_RANGE.
+		 * It is defined in SimdMath.cpp, which is compiled without AVX, so the AVX code calls no library functions.
+		 * @param angles The angles in radians.
+		 * @param s The sines, the selected lanes are overwritten.
+		 * @param c The cosines, the selected lanes are overwritten.
+		 * @param lanes The lanes to compute, bit i selects lane i.
+		 */
+		static void sinCosLanes( const float* angles, float* s, float* c, int lanes);
+
+	private: // class helpers
+
+		/**
+		 * Retrieves the implementations in use and chooses them on the first call.
+		 * @return The implementations of the current instruction set.
+		 */
+		static const Functions* functions()
+		{
+			if( !__functions)
+				setInstructionSet( detectInstructionSet());
+
+			return __functions;
+		}
+
+	}; // END class SimdMath
+
+} // END namespace Trip
+
+#endif /* __SimdMath_HPP__ */
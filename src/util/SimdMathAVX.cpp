@@ -0,0 +1,218 @@
+/**
+ * The AVX implementations of the SimdMath.hpp.
+ * Every operation processes a whole batch of 8 lanes at once.
+ * Only the float instructions of AVX are used, so AVX2 is not required.
+ * The file is compiled without /arch:AVX, since the library code inlined here would
+ * otherwise be AVX code the linker may pick for all files. Only the kernels use AVX.
+ * @author barn
+ * @version 20121210
+ */
+
+/*===========================================================================*
+ * INCLUDES (associated header files)
+ *===========================================================================*/
+#include "SimdMath.hpp"
+
+#ifdef TRIP_SIMD_AVX
+
+/*===========================================================================*
+ * INCLUDES project headers
+ *===========================================================================*/
+
+/*===========================================================================*
+ * INCLUDES C/C++ standard library (and other external libraries)
+ *===========================================================================*/
+#include <immintrin.h>
+
+/*===========================================================================*
+ * DEFINES and MACROS
+ *===========================================================================*/
+
+/// GCC only emits AVX instructions in functions compiled for AVX; the CPU is checked at runtime.
+#ifdef __GNUC__
+#	define TRIP_AVX_FUNCTION __attribute__((target("avx")))
+#else
+#	define TRIP_AVX_FUNCTION
+#endif
+
+/*===========================================================================*
+ * NAMESPACE, CONSTANTS and TYPE DECLARATIONS/IMPLEMENTATIONS
+ *===========================================================================*/
+
+namespace Trip
+{
+	/**
+	 * Computes the sine and cosine of 8 angles with the polynomials of the Cephes library.
+	 * The angles are reduced to [-PI/4, PI/4] in quarter turns first. The quadrant
+	 * is computed in floats, since the integer instructions on 8 lanes need AVX2.
+	 * Lanes beyond TRIP_SIMD_SINCOS_RANGE are computed by SimdMath::sinCosLanes().
+	 * @param angles The angles in radians.
+	 * @param s Receives the sines.
+	 * @param c Receives the cosines.
+	 */
+	static inline TRIP_AVX_FUNCTION void sincos8( __m256 angles, __m256& s, __m256& c)
+	{
+		const __m256 sign_mask = _mm256_set1_ps( -0.0f);
+		const __m256 zero = _mm256_setzero_ps();
+		const __m256 one = _mm256_set1_ps( 1.0f);
+		const __m256 two = _mm256_set1_ps( 2.0f);
+
+		// work on |x| and restore the sign of the sine at the end
+		__m256 sign_sin = _mm256_and_ps( angles, sign_mask);
+		__m256 x = _mm256_andnot_ps( sign_mask, angles);
+
+		// the number of quarter turns q closest to x, y = 2 * q eighth turns
+		const __m256 q = _mm256_round_ps( _mm256_mul_ps( _mm256_add_ps( _mm256_round_ps( _mm256_mul_ps( x, _mm256_set1_ps( 1.27323954473516f)), _MM_FROUND_TO_ZERO), one), _mm256_set1_ps( 0.5f)), _MM_FROUND_TO_ZERO);
+		const __m256 y = _mm256_mul_ps( q, two);
+
+		// the quadrant m = q mod 4
+		const __m256 m = _mm256_sub_ps( q, _mm256_mul_ps( _mm256_round_ps( _mm256_mul_ps( q, _mm256_set1_ps( 0.25f)), _MM_FROUND_TO_ZERO), _mm256_set1_ps( 4.0f)));
+
+		// quadrants 2 and 3 flip the sine, quadrants 1 and 2 the cosine
+		const __m256 swap_sign_sin = _mm256_and_ps( _mm256_cmp_ps( m, two, _CMP_GE_OQ), sign_mask);
+		const __m256 sign_cos = _mm256_and_ps( _mm256_and_ps( _mm256_cmp_ps( m, one, _CMP_GE_OQ), _mm256_cmp_ps( m, two, _CMP_LE_OQ)), sign_mask);
+		const __m256 odd = _mm256_sub_ps( m, _mm256_mul_ps( _mm256_round_ps( _mm256_mul_ps( m, _mm256_set1_ps( 0.5f)), _MM_FROUND_TO_ZERO), two));
+		const __m256 poly_mask = _mm256_cmp_ps( odd, zero, _CMP_EQ_OQ);
+		sign_sin = _mm256_xor_ps( sign_sin, swap_sign_sin);
+
+		// x - y * PI/4 in three steps for precision
+		x = _mm256_add_ps( x, _mm256_mul_ps( y, _mm256_set1_ps( -0.78515625f)));
+		x = _mm256_add_ps( x, _mm256_mul_ps( y, _mm256_set1_ps( -2.4187564849853515625e-4f)));
+		x = _mm256_add_ps( x, _mm256_mul_ps( y, _mm256_set1_ps( -3.77489497744594108e-8f)));
+		const __m256 z = _mm256_mul_ps( x, x);
+
+		// cosine polynomial
+		__m256 pc = _mm256_set1_ps( 2.443315711809948e-5f);
+		pc = _mm256_add_ps( _mm256_mul_ps( pc, z), _mm256_set1_ps( -1.388731625493765e-3f));
+		pc = _mm256_add_ps( _mm256_mul_ps( pc, z), _mm256_set1_ps( 4.166664568298827e-2f));
+		pc = _mm256_mul_ps( _mm256_mul_ps( pc, z), z);
+		pc = _mm256_sub_ps( pc, _mm256_mul_ps( z, _mm256_set1_ps( 0.5f)));
+		pc = _mm256_add_ps( pc, one);
+
+		// sine polynomial
+		__m256 ps = _mm256_set1_ps( -1.9515295891e-4f);
+		ps = _mm256_add_ps( _mm256_mul_ps( ps, z), _mm256_set1_ps( 8.3321608736e-3f));
+		ps = _mm256_add_ps( _mm256_mul_ps( ps, z), _mm256_set1_ps( -1.6666654611e-1f));
+		ps = _mm256_add_ps( _mm256_mul_ps( _mm256_mul_ps( ps, z), x), x);
+
+		// pick the polynomial per quadrant
+		const __m256 sin_value = _mm256_blendv_ps( pc, ps, poly_mask);
+		const __m256 cos_value = _mm256_blendv_ps( ps, pc, poly_mask);
+
+		s = _mm256_xor_ps( sin_value, sign_sin);
+		c = _mm256_xor_ps( cos_value, sign_cos);
+
+		// the reduction loses precision beyond the range
+		const int large = _mm256_movemask_ps( _mm256_cmp_ps( _mm256_andnot_ps( sign_mask, angles), _mm256_set1_ps( TRIP_SIMD_SINCOS_RANGE), _CMP_GT_OQ));
+		if( large != 0)
+		{
+			float a[8], sin_lanes[8], cos_lanes[8];
+			_mm256_storeu_ps( a, angles);
+			_mm256_storeu_ps( sin_lanes, s);
+			_mm256_storeu_ps( cos_lanes, c);
+			SimdMath::sinCosLanes( a, sin_lanes, cos_lanes, large);
+			s = _mm256_loadu_ps( sin_lanes);
+			c = _mm256_loadu_ps( cos_lanes);
+		}
+	}
+
+
+	/// Builds rotations from angles and axes.
+	static TRIP_AVX_FUNCTION void avxFromAngleAxis( const float* angles, const Vector3Batch& axes, QuaternionBatch& out)
+	{
+		__m256 s, c;
+		sincos8( _mm256_mul_ps( _mm256_loadu_ps( angles), _mm256_set1_ps( 0.5f)), s, c);
+
+		_mm256_storeu_ps( out.w, c);
+		_mm256_storeu_ps( out.x, _mm256_mul_ps( s, _mm256_loadu_ps( axes.x)));
+		_mm256_storeu_ps( out.y, _mm256_mul_ps( s, _mm256_loadu_ps( axes.y)));
+		_mm256_storeu_ps( out.z, _mm256_mul_ps( s, _mm256_loadu_ps( axes.z)));
+	}
+
+	/// Multiplies quaternions.
+	static TRIP_AVX_FUNCTION void avxMultiply( const QuaternionBatch& a, const QuaternionBatch& b, QuaternionBatch& out)
+	{
+		const __m256 aw = _mm256_loadu_ps( a.w), ax = _mm256_loadu_ps( a.x), ay = _mm256_loadu_ps( a.y), az = _mm256_loadu_ps( a.z);
+		const __m256 bw = _mm256_loadu_ps( b.w), bx = _mm256_loadu_ps( b.x), by = _mm256_loadu_ps( b.y), bz = _mm256_loadu_ps( b.z);
+
+		const __m256 w = _mm256_sub_ps( _mm256_sub_ps( _mm256_sub_ps( _mm256_mul_ps( aw, bw), _mm256_mul_ps( ax, bx)), _mm256_mul_ps( ay, by)), _mm256_mul_ps( az, bz));
+		const __m256 x = _mm256_sub_ps( _mm256_add_ps( _mm256_add_ps( _mm256_mul_ps( aw, bx), _mm256_mul_ps( ax, bw)), _mm256_mul_ps( ay, bz)), _mm256_mul_ps( az, by));
+		const __m256 y = _mm256_sub_ps( _mm256_add_ps( _mm256_add_ps( _mm256_mul_ps( aw, by), _mm256_mul_ps( ay, bw)), _mm256_mul_ps( az, bx)), _mm256_mul_ps( ax, bz));
+		const __m256 z = _mm256_sub_ps( _mm256_add_ps( _mm256_add_ps( _mm256_mul_ps( aw, bz), _mm256_mul_ps( az, bw)), _mm256_mul_ps( ax, by)), _mm256_mul_ps( ay, bx));
+
+		_mm256_storeu_ps( out.w, w);
+		_mm256_storeu_ps( out.x, x);
+		_mm256_storeu_ps( out.y, y);
+		_mm256_storeu_ps( out.z, z);
+	}
+
+	/// Normalises quaternions.
+	static TRIP_AVX_FUNCTION void avxNormalise( QuaternionBatch& q)
+	{
+		const __m256 w = _mm256_loadu_ps( q.w), x = _mm256_loadu_ps( q.x), y = _mm256_loadu_ps( q.y), z = _mm256_loadu_ps( q.z);
+
+		const __m256 len = _mm256_add_ps( _mm256_add_ps( _mm256_mul_ps( w, w), _mm256_mul_ps( x, x)), _mm256_add_ps( _mm256_mul_ps( y, y), _mm256_mul_ps( z, z)));
+		const __m256 factor = _mm256_div_ps( _mm256_set1_ps( 1.0f), _mm256_sqrt_ps( len));
+
+		_mm256_storeu_ps( q.w, _mm256_mul_ps( w, factor));
+		_mm256_storeu_ps( q.x, _mm256_mul_ps( x, factor));
+		_mm256_storeu_ps( q.y, _mm256_mul_ps( y, factor));
+		_mm256_storeu_ps( q.z, _mm256_mul_ps( z, factor));
+	}
+
+	/// Adds vectors.
+	static TRIP_AVX_FUNCTION void avxTranslate( Vector3Batch& v, const Vector3Batch& d)
+	{
+		_mm256_storeu_ps( v.x, _mm256_add_ps( _mm256_loadu_ps( v.x), _mm256_loadu_ps( d.x)));
+		_mm256_storeu_ps( v.y, _mm256_add_ps( _mm256_loadu_ps( v.y), _mm256_loadu_ps( d.y)));
+		_mm256_storeu_ps( v.z, _mm256_add_ps( _mm256_loadu_ps( v.z), _mm256_loadu_ps( d.z)));
+	}
+
+	/// Multiplies vectors component-wise.
+	static TRIP_AVX_FUNCTION void avxScale( Vector3Batch& v, const Vector3Batch& s)
+	{
+		_mm256_storeu_ps( v.x, _mm256_mul_ps( _mm256_loadu_ps( v.x), _mm256_loadu_ps( s.x)));
+		_mm256_storeu_ps( v.y, _mm256_mul_ps( _mm256_loadu_ps( v.y), _mm256_loadu_ps( s.y)));
+		_mm256_storeu_ps( v.z, _mm256_mul_ps( _mm256_loadu_ps( v.z), _mm256_loadu_ps( s.z)));
+	}
+
+
+	/// Computes sines and cosines.
+	static TRIP_AVX_FUNCTION void avxSinCos( const float* angles, float* s, float* c)
+	{
+		__m256 sin_value, cos_value;
+		sincos8( _mm256_loadu_ps( angles), sin_value, cos_value);
+
+		_mm256_storeu_ps( s, sin_value);
+		_mm256_storeu_ps( c, cos_value);
+	}
+
+	/// Scales and offsets floats.
+	static TRIP_AVX_FUNCTION void avxAffine( const float* v, float* out, float factor, float offset)
+	{
+		_mm256_storeu_ps( out, _mm256_add_ps( _mm256_mul_ps( _mm256_loadu_ps( v), _mm256_set1_ps( factor)), _mm256_set1_ps( offset)));
+	}
+
+	/// Multiplies floats.
+	static TRIP_AVX_FUNCTION void avxProduct( const float* a, const float* b, float* out)
+	{
+		_mm256_storeu_ps( out, _mm256_mul_ps( _mm256_loadu_ps( a), _mm256_loadu_ps( b)));
+	}
+
+
+	/// The AVX implementations.
+	const SimdMath::Functions SimdMath::__avx_functions =
+	{
+		&avxFromAngleAxis,
+		&avxMultiply,
+		&avxNormalise,
+		&avxTranslate,
+		&avxScale,
+		&avxSinCos,
+		&avxAffine,
+		&avxProduct
+	};
+
+} // END namespace Trip
+
+#endif /* TRIP_SIMD_AVX */
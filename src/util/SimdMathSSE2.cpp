@@ -0,0 +1,228 @@
+/**
+ * The SSE2 implementations of the SimdMath.hpp.
+ * Every operation processes a batch in two halves of 4 lanes.
+ * @author barn
+ * @version 20121210
+ */
+
+/*===========================================================================*
+ * INCLUDES (associated header files)
+ *===========================================================================*/
+#include "SimdMath.hpp"
+
+#ifdef TRIP_SIMD_SSE2
+
+/*===========================================================================*
+ * INCLUDES project headers
+ *===========================================================================*/
+
+/*===========================================================================*
+ * INCLUDES C/C++ standard library (and other external libraries)
+ *===========================================================================*/
+#include <emmintrin.h>
+
+/*===========================================================================*
+ * DEFINES and MACROS
+ *===========================================================================*/
+
+/*===========================================================================*
+ * NAMESPACE, CONSTANTS and TYPE DECLARATIONS/IMPLEMENTATIONS
+ *===========================================================================*/
+
+namespace Trip
+{
+	/**
+	 * Computes the sine and cosine of 4 angles with the polynomials of the Cephes library.
+	 * The angles are reduced to [-PI/4, PI/4] in quarter turns first.
+	 * Lanes beyond TRIP_SIMD_SINCOS_RANGE are computed by SimdMath::sinCosLanes().
+	 * @param angles The angles in radians.
+	 * @param s Receives the sines.
+	 * @param c Receives the cosines.
+	 */
+	static inline void sincos4( __m128 angles, __m128& s, __m128& c)
+	{
+		const __m128 sign_mask = _mm_set1_ps( -0.0f);
+
+		// work on |x| and restore the sign of the sine at the end
+		__m128 sign_sin = _mm_and_ps( angles, sign_mask);
+		__m128 x = _mm_andnot_ps( sign_mask, angles);
+
+		// the even number of eighth turns j closest to x
+		__m128i j = _mm_cvttps_epi32( _mm_mul_ps( x, _mm_set1_ps( 1.27323954473516f)));
+		j = _mm_add_epi32( j, _mm_set1_epi32( 1));
+		j = _mm_and_si128( j, _mm_set1_epi32( ~1));
+		const __m128 y = _mm_cvtepi32_ps( j);
+
+		// quadrants 2 and 3 flip the sine, quadrants 1 and 2 the cosine
+		const __m128 swap_sign_sin = _mm_castsi128_ps( _mm_slli_epi32( _mm_and_si128( j, _mm_set1_epi32( 4)), 29));
+		const __m128 sign_cos = _mm_castsi128_ps( _mm_slli_epi32( _mm_andnot_si128( _mm_sub_epi32( j, _mm_set1_epi32( 2)), _mm_set1_epi32( 4)), 29));
+		const __m128 poly_mask = _mm_castsi128_ps( _mm_cmpeq_epi32( _mm_and_si128( j, _mm_set1_epi32( 2)), _mm_setzero_si128()));
+		sign_sin = _mm_xor_ps( sign_sin, swap_sign_sin);
+
+		// x - y * PI/4 in three steps for precision
+		x = _mm_add_ps( x, _mm_mul_ps( y, _mm_set1_ps( -0.78515625f)));
+		x = _mm_add_ps( x, _mm_mul_ps( y, _mm_set1_ps( -2.4187564849853515625e-4f)));
+		x = _mm_add_ps( x, _mm_mul_ps( y, _mm_set1_ps( -3.77489497744594108e-8f)));
+		const __m128 z = _mm_mul_ps( x, x);
+
+		// cosine polynomial
+		__m128 pc = _mm_set1_ps( 2.443315711809948e-5f);
+		pc = _mm_add_ps( _mm_mul_ps( pc, z), _mm_set1_ps( -1.388731625493765e-3f));
+		pc = _mm_add_ps( _mm_mul_ps( pc, z), _mm_set1_ps( 4.166664568298827e-2f));
+		pc = _mm_mul_ps( _mm_mul_ps( pc, z), z);
+		pc = _mm_sub_ps( pc, _mm_mul_ps( z, _mm_set1_ps( 0.5f)));
+		pc = _mm_add_ps( pc, _mm_set1_ps( 1.0f));
+
+		// sine polynomial
+		__m128 ps = _mm_set1_ps( -1.9515295891e-4f);
+		ps = _mm_add_ps( _mm_mul_ps( ps, z), _mm_set1_ps( 8.3321608736e-3f));
+		ps = _mm_add_ps( _mm_mul_ps( ps, z), _mm_set1_ps( -1.6666654611e-1f));
+		ps = _mm_add_ps( _mm_mul_ps( _mm_mul_ps( ps, z), x), x);
+
+		// pick the polynomial per quadrant
+		const __m128 sin_value = _mm_or_ps( _mm_and_ps( poly_mask, ps), _mm_andnot_ps( poly_mask, pc));
+		const __m128 cos_value = _mm_or_ps( _mm_and_ps( poly_mask, pc), _mm_andnot_ps( poly_mask, ps));
+
+		s = _mm_xor_ps( sin_value, sign_sin);
+		c = _mm_xor_ps( cos_value, sign_cos);
+
+		// the reduction loses precision beyond the range and overflows the quadrant
+		const int large = _mm_movemask_ps( _mm_cmpgt_ps( _mm_andnot_ps( sign_mask, angles), _mm_set1_ps( TRIP_SIMD_SINCOS_RANGE)));
+		if( large != 0)
+		{
+			float a[4], sin_lanes[4], cos_lanes[4];
+			_mm_storeu_ps( a, angles);
+			_mm_storeu_ps( sin_lanes, s);
+			_mm_storeu_ps( cos_lanes, c);
+			SimdMath::sinCosLanes( a, sin_lanes, cos_lanes, large);
+			s = _mm_loadu_ps( sin_lanes);
+			c = _mm_loadu_ps( cos_lanes);
+		}
+	}
+
+
+	/// Builds rotations from angles and axes.
+	static void sse2FromAngleAxis( const float* angles, const Vector3Batch& axes, QuaternionBatch& out)
+	{
+		for( uint i = 0; i < TRIP_SIMD_WIDTH; i += 4)
+		{
+			__m128 s, c;
+			sincos4( _mm_mul_ps( _mm_loadu_ps( angles + i), _mm_set1_ps( 0.5f)), s, c);
+
+			_mm_storeu_ps( out.w + i, c);
+			_mm_storeu_ps( out.x + i, _mm_mul_ps( s, _mm_loadu_ps( axes.x + i)));
+			_mm_storeu_ps( out.y + i, _mm_mul_ps( s, _mm_loadu_ps( axes.y + i)));
+			_mm_storeu_ps( out.z + i, _mm_mul_ps( s, _mm_loadu_ps( axes.z + i)));
+		}
+	}
+
+	/// Multiplies quaternions.
+	static void sse2Multiply( const QuaternionBatch& a, const QuaternionBatch& b, QuaternionBatch& out)
+	{
+		for( uint i = 0; i < TRIP_SIMD_WIDTH; i += 4)
+		{
+			const __m128 aw = _mm_loadu_ps( a.w + i), ax = _mm_loadu_ps( a.x + i), ay = _mm_loadu_ps( a.y + i), az = _mm_loadu_ps( a.z + i);
+			const __m128 bw = _mm_loadu_ps( b.w + i), bx = _mm_loadu_ps( b.x + i), by = _mm_loadu_ps( b.y + i), bz = _mm_loadu_ps( b.z + i);
+
+			const __m128 w = _mm_sub_ps( _mm_sub_ps( _mm_sub_ps( _mm_mul_ps( aw, bw), _mm_mul_ps( ax, bx)), _mm_mul_ps( ay, by)), _mm_mul_ps( az, bz));
+			const __m128 x = _mm_sub_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps( aw, bx), _mm_mul_ps( ax, bw)), _mm_mul_ps( ay, bz)), _mm_mul_ps( az, by));
+			const __m128 y = _mm_sub_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps( aw, by), _mm_mul_ps( ay, bw)), _mm_mul_ps( az, bx)), _mm_mul_ps( ax, bz));
+			const __m128 z = _mm_sub_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps( aw, bz), _mm_mul_ps( az, bw)), _mm_mul_ps( ax, by)), _mm_mul_ps( ay, bx));
+
+			_mm_storeu_ps( out.w + i, w);
+			_mm_storeu_ps( out.x + i, x);
+			_mm_storeu_ps( out.y + i, y);
+			_mm_storeu_ps( out.z + i, z);
+		}
+	}
+
+	/// Normalises quaternions.
+	static void sse2Normalise( QuaternionBatch& q)
+	{
+		for( uint i = 0; i < TRIP_SIMD_WIDTH; i += 4)
+		{
+			const __m128 w = _mm_loadu_ps( q.w + i), x = _mm_loadu_ps( q.x + i), y = _mm_loadu_ps( q.y + i), z = _mm_loadu_ps( q.z + i);
+
+			const __m128 len = _mm_add_ps( _mm_add_ps( _mm_mul_ps( w, w), _mm_mul_ps( x, x)), _mm_add_ps( _mm_mul_ps( y, y), _mm_mul_ps( z, z)));
+			const __m128 factor = _mm_div_ps( _mm_set1_ps( 1.0f), _mm_sqrt_ps( len));
+
+			_mm_storeu_ps( q.w + i, _mm_mul_ps( w, factor));
+			_mm_storeu_ps( q.x + i, _mm_mul_ps( x, factor));
+			_mm_storeu_ps( q.y + i, _mm_mul_ps( y, factor));
+			_mm_storeu_ps( q.z + i, _mm_mul_ps( z, factor));
+		}
+	}
+
+	/// Adds vectors.
+	static void sse2Translate( Vector3Batch& v, const Vector3Batch& d)
+	{
+		for( uint i = 0; i < TRIP_SIMD_WIDTH; i += 4)
+		{
+			_mm_storeu_ps( v.x + i, _mm_add_ps( _mm_loadu_ps( v.x + i), _mm_loadu_ps( d.x + i)));
+			_mm_storeu_ps( v.y + i, _mm_add_ps( _mm_loadu_ps( v.y + i), _mm_loadu_ps( d.y + i)));
+			_mm_storeu_ps( v.z + i, _mm_add_ps( _mm_loadu_ps( v.z + i), _mm_loadu_ps( d.z + i)));
+		}
+	}
+
+	/// Multiplies vectors component-wise.
+	static void sse2Scale( Vector3Batch& v, const Vector3Batch& s)
+	{
+		for( uint i = 0; i < TRIP_SIMD_WIDTH; i += 4)
+		{
+			_mm_storeu_ps( v.x + i, _mm_mul_ps( _mm_loadu_ps( v.x + i), _mm_loadu_ps( s.x + i)));
+			_mm_storeu_ps( v.y + i, _mm_mul_ps( _mm_loadu_ps( v.y + i), _mm_loadu_ps( s.y + i)));
+			_mm_storeu_ps( v.z + i, _mm_mul_ps( _mm_loadu_ps( v.z + i), _mm_loadu_ps( s.z + i)));
+		}
+	}
+
+
+	/// Computes sines and cosines.
+	static void sse2SinCos( const float* angles, float* s, float* c)
+	{
+		for( uint i = 0; i < TRIP_SIMD_WIDTH; i += 4)
+		{
+			__m128 sin_value, cos_value;
+			sincos4( _mm_loadu_ps( angles + i), sin_value, cos_value);
+
+			_mm_storeu_ps( s + i, sin_value);
+			_mm_storeu_ps( c + i, cos_value);
+		}
+	}
+
+	/// Scales and offsets floats.
+	static void sse2Affine( const float* v, float* out, float factor, float offset)
+	{
+		const __m128 f = _mm_set1_ps( factor);
+		const __m128 o = _mm_set1_ps( offset);
+		for( uint i = 0; i < TRIP_SIMD_WIDTH; i += 4)
+		{
+			_mm_storeu_ps( out + i, _mm_add_ps( _mm_mul_ps( _mm_loadu_ps( v + i), f), o));
+		}
+	}
+
+	/// Multiplies floats.
+	static void sse2Product( const float* a, const float* b, float* out)
+	{
+		for( uint i = 0; i < TRIP_SIMD_WIDTH; i += 4)
+		{
+			_mm_storeu_ps( out + i, _mm_mul_ps( _mm_loadu_ps( a + i), _mm_loadu_ps( b + i)));
+		}
+	}
+
+
+	/// The SSE2 implementations.
+	const SimdMath::Functions SimdMath::__sse2_functions =
+	{
+		&sse2FromAngleAxis,
+		&sse2Multiply,
+		&sse2Normalise,
+		&sse2Translate,
+		&sse2Scale,
+		&sse2SinCos,
+		&sse2Affine,
+		&sse2Product
+	};
+
+} // END namespace Trip
+
+#endif /* TRIP_SIMD_SSE2 */
@@ -0,0 +1,247 @@
+/**
+ * Implementation file for the ThreadPool.hpp.
+ * @author barn
+ * @version 20121120
+ */
+
+/*===========================================================================*
+ * INCLUDES (associated header files)
+ *===========================================================================*/
+#include "ThreadPool.hpp"
+
+/*===========================================================================*
+ * INCLUDES project headers
+ *===========================================================================*/
+
+/*===========================================================================*
+ * INCLUDES C/C++ standard library (and other external libraries)
+ *===========================================================================*/
+#include <boost/bind.hpp>
+
+/*===========================================================================*
+ * DEFINES and MACROS
+ *===========================================================================*/
+
+/*===========================================================================*
+ * NAMESPACE, CONSTANTS and TYPE DECLARATIONS/IMPLEMENTATIONS
+ *===========================================================================*/
+
+namespace Trip
+{
+
+	/**
+	 * Main constructor.
+	 * Starts threadCount - 1 worker threads.
+	 * @param threadCount The number of threads that work on tasks,
+	 * including the thread that calls parallelFor(). Values less than 1 are treated as 1.
+	 */
+	ThreadPool::ThreadPool( uint threadCount)
+		: _generation(0),
+		_stop(false),
+		_pending(0)
+	{
+		if( threadCount < 1)
+			threadCount = 1;
+
+		for( uint i = 0; i < threadCount; ++i)
+		{
+			_workers.push_back( new Worker());
+		}
+
+		for( uint i = 1; i < threadCount; ++i)
+		{
+			_threads.create_thread( boost::bind( &ThreadPool::workerLoop, this, i));
+		}
+	}
+
+
+	/**
+	 * Destructor.
+	 * Stops and joins all worker threads.
+	 */
+	ThreadPool::~ThreadPool()
+	{
+		{
+			boost::mutex::scoped_lock lock( _wake_mutex);
+			_stop = true;
+		}
+		_wake.notify_all();
+		_threads.join_all();
+
+		for( auto it = _workers.begin(); it != _workers.end(); ++it)
+		{
+			delete *it;
+		}
+		_workers.clear();
+	}
+
+
+	/**
+	 * Splits the range [0, count) into tasks of at most grainSize indices,
+	 * processes them on all threads of the pool and waits until they are done.
+	 * @param function The function that processes one task.
+	 * @param context A pointer that is handed to the function.
+	 * @param count The number of indices to process.
+	 * @param grainSize The maximum number of indices per task.
+	 */
+	void ThreadPool::parallelFor( TaskFunction function, void* context, uint count, uint grainSize)
+	{
+		if( count == 0)
+			return;
+
+		if( grainSize < 1)
+			grainSize = 1;
+
+		// run small ranges and single threaded pools directly
+		const uint worker_count = _workers.size();
+		if( worker_count == 1 || count <= grainSize)
+		{
+			function( context, 0, count);
+			return;
+		}
+
+		// distribute the tasks round robin over the queues
+		uint worker = 0;
+		for( uint begin = 0; begin < count; begin += grainSize)
+		{
+			Task task;
+			task.function = function;
+			task.context = context;
+			task.begin = begin;
+			task.end = begin + grainSize < count ? begin + grainSize : count;
+
+			Worker* w = _workers[worker];
+			{
+				boost::mutex::scoped_lock lock( w->mutex);
+				w->tasks.push_back( task);
+			}
+			++_pending;
+
+			worker = (worker + 1) % worker_count;
+		}
+
+		// wake up the workers
+		{
+			boost::mutex::scoped_lock lock( _wake_mutex);
+			++_generation;
+		}
+		_wake.notify_all();
+
+		// help out until every task is finished
+		while( _pending > 0)
+		{
+			work( 0);
+
+			if( _pending > 0)
+			{
+				boost::this_thread::yield();
+			}
+		}
+	}
+
+
+	/**
+	 * The main loop of the worker threads.
+	 * @param worker The index of the worker.
+	 */
+	void ThreadPool::workerLoop( uint worker)
+	{
+		uint seen_generation = 0;
+
+		while( true)
+		{
+			{
+				boost::mutex::scoped_lock lock( _wake_mutex);
+				while( _generation == seen_generation && !_stop)
+				{
+					_wake.wait( lock);
+				}
+
+				if( _stop)
+					return;
+
+				seen_generation = _generation;
+			}
+
+			work( worker);
+		}
+	}
+
+
+	/**
+	 * Processes tasks from the own queue and stolen ones until no task is left.
+	 * @param worker The index of the worker.
+	 */
+	void ThreadPool::work( uint worker)
+	{
+		Task task;
+		while( popTask( worker, task) || stealTask( worker, task))
+		{
+			task.function( task.context, task.begin, task.end);
+			--_pending;
+		}
+	}
+
+
+	/**
+	 * Takes a task from the back of the worker's own queue.
+	 * @param worker The index of the worker.
+	 * @param task Receives the task.
+	 * @return
+	 * TRUE - a task was taken
+	 * FALSE - the queue is empty
+	 */
+	bool ThreadPool::popTask( uint worker, Task& task)
+	{
+		Worker* w = _workers[worker];
+		boost::mutex::scoped_lock lock( w->mutex);
+
+		if( w->head >= w->tasks.size())
+			return false;
+
+		task = w->tasks.back();
+		w->tasks.pop_back();
+
+		// reset an emptied queue, but keep its memory
+		if( w->head >= w->tasks.size())
+		{
+			w->tasks.clear();
+			w->head = 0;
+		}
+		return true;
+	}
+
+
+	/**
+	 * Takes a task from the front of another worker's queue.
+	 * @param thief The index of the worker that steals.
+	 * @param task Receives the task.
+	 * @return
+	 * TRUE - a task was stolen
+	 * FALSE - all queues are empty
+	 */
+	bool ThreadPool::stealTask( uint thief, Task& task)
+	{
+		const uint worker_count = _workers.size();
+		for( uint i = 1; i < worker_count; ++i)
+		{
+			Worker* w = _workers[(thief + i) % worker_count];
+			boost::mutex::scoped_lock lock( w->mutex);
+
+			if( w->head >= w->tasks.size())
+				continue;
+
+			task = w->tasks[w->head];
+			++w->head;
+
+			if( w->head >= w->tasks.size())
+			{
+				w->tasks.clear();
+				w->head = 0;
+			}
+			return true;
+		}
+		return false;
+	}
+
+} // END namespace Trip
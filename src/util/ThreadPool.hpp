@@ -0,0 +1,185 @@
+/**
+ * This file contains the ThreadPool class, a small work-stealing thread pool
+ * that splits index ranges into tasks and processes them in parallel.
+ * @author barn
+ * @version 20121120
+ */
+#ifndef __ThreadPool_HPP__
+#define __ThreadPool_HPP__
+
+/*===========================================================================*
+ * INCLUDES base definition file for DLL import/export
+ *===========================================================================*/
+
+/*===========================================================================*
+ * INCLUDES project headers
+ *===========================================================================*/
+#include "stdafx.h"
+
+/*===========================================================================*
+ * INCLUDES C/C++ standard library (and other external libraries)
+ *===========================================================================*/
+#include <boost/thread.hpp>
+#include <boost/detail/atomic_count.hpp>
+
+/*===========================================================================*
+ * DEFINES and MACROS
+ *===========================================================================*/
+
+/*===========================================================================*
+ * NAMESPACE, CONSTANTS and TYPE DECLARATIONS/IMPLEMENTATIONS
+ *===========================================================================*/
+
+namespace Trip
+{
+
+	/**
+	 * The ThreadPool runs tasks on a fixed number of worker threads.
+	 * Every worker has its own task queue. A worker takes tasks from the back of its own queue
+	 * and, when its queue is empty, steals tasks from the front of the other workers' queues.
+	 * The thread that calls parallelFor() works as worker 0 and returns when all tasks are done.
+	 *
+	 * Once the queues have grown to their working size, processing does not allocate memory.
+	 */
+	class ThreadPool
+	{
+	public: // nested types
+
+		/**
+		 * A function that processes the index range [begin, end).
+		 * @param context An arbitrary pointer given to parallelFor().
+		 * @param begin The first index to process.
+		 * @param end The index after the last one to process.
+		 */
+		typedef void (*TaskFunction)( void* context, uint begin, uint end);
+
+	private: // nested types
+
+		/// A range of indices to be processed by a TaskFunction.
+		struct Task
+		{
+			TaskFunction function;
+			void* context;
+			uint begin;
+			uint end;
+		};
+
+		/// The task queue of one worker.
+		struct Worker
+		{
+			/// Protects the queue.
+			boost::mutex mutex;
+
+			/// The queued tasks. Valid tasks are within [head, tasks.size()).
+			std::vector<Task> tasks;
+
+			/// The index of the first task that has not been taken yet.
+			uint head;
+
+			Worker()
+				: head(0)
+			{}
+		};
+
+	private: // vars
+
+		/// The task queues. Worker 0 is the thread that calls parallelFor().
+		std::vector<Worker*> _workers;
+
+		/// The worker threads 1 to n-1.
+		boost::thread_group _threads;
+
+		/// Protects _generation and _stop.
+		boost::mutex _wake_mutex;
+
+		/// Wakes up the workers when new tasks are queued.
+		boost::condition_variable _wake;
+
+		/// Incremented each time new tasks are queued.
+		uint _generation;
+
+		/// Indicates that the workers shall terminate.
+		bool _stop;
+
+		/// The number of queued tasks that are not finished yet.
+		boost::detail::atomic_count _pending;
+
+	public: // constructor & destructor
+
+		/**
+		 * Main constructor.
+		 * Starts threadCount - 1 worker threads.
+		 * @param threadCount The number of threads that work on tasks,
+		 * including the thread that calls parallelFor(). Values less than 1 are treated as 1.
+		 */
+		ThreadPool( uint threadCount);
+
+		/**
+		 * Destructor.
+		 * Stops and joins all worker threads.
+		 */
+		~ThreadPool();
+
+	public: // methods
+
+		/**
+		 * Splits the range [0, count) into tasks of at most grainSize indices,
+		 * processes them on all threads of the pool and waits until they are done.
+		 * @param function The function that processes one task.
+		 * @param context A pointer that is handed to the function.
+		 * @param count The number of indices to process.
+		 * @param grainSize The maximum number of indices per task.
+		 */
+		void parallelFor( TaskFunction function, void* context, uint count, uint grainSize);
+
+	public: // getters & setters
+
+		/**
+		 * Retrieves the number of threads that work on tasks,
+		 * including the thread that calls parallelFor().
+		 * @return The number of threads of the pool.
+		 */
+		uint getThreadCount()
+		{
+			return _workers.size();
+		}
+
+	private: // helpers
+
+		/**
+		 * The main loop of the worker threads.
+		 * @param worker The index of the worker.
+		 */
+		void workerLoop( uint worker);
+
+		/**
+		 * Processes tasks from the own queue and stolen ones until no task is left.
+		 * @param worker The index of the worker.
+		 */
+		void work( uint worker);
+
+		/**
+		 * Takes a task from the back of the worker's own queue.
+		 * @param worker The index of the worker.
+		 * @param task Receives the task.
+		 * @return
+		 * TRUE - a task was taken
+		 * FALSE - the queue is empty
+		 */
+		bool popTask( uint worker, Task& task);
+
+		/**
+		 * Takes a task from the front of another worker's queue.
+		 * @param thief The index of the worker that steals.
+		 * @param task Receives the task.
+		 * @return
+		 * TRUE - a task was stolen
+		 * FALSE - all queues are empty
+		 */
+		bool stealTask( uint thief, Task& task);
+
+	}; // END class ThreadPool
+
+} // END namespace Trip
+
+#endif /* __ThreadPool_HPP__ */